@@ -1,4 +1,6 @@
 #include "Linerizer.h"
+#include "hrs/parallel_for.hpp"
+#include <algorithm>
 #include <utility>
 
 namespace GeometryParser
@@ -51,4 +53,61 @@ namespace GeometryParser
 
         return out;
     }
+
+    std::size_t Linerizer::GetIndexCount(const ObjData& _obj_data) noexcept
+    {
+        std::size_t face_count = _obj_data.GetSchema().face_count;
+        if(face_count < 2)
+            return 0;
+
+        std::size_t lines_per_face = (face_count == 2 ? 1 : face_count);
+        return _obj_data.GetIndices().size() / face_count * lines_per_face * COMPONENTS;
+    }
+
+    bool Linerizer::LinerizeAll(const ObjData& _obj_data,
+                                std::span<std::uint32_t> out,
+                                std::size_t thread_count)
+    {
+        std::size_t index_count = GetIndexCount(_obj_data);
+        if(out.size() < index_count)
+            return false;
+
+        if(index_count == 0)
+            return true;
+
+        std::size_t face_count = _obj_data.GetSchema().face_count;
+        std::size_t faces = _obj_data.GetIndices().size() / face_count;
+        std::size_t indices_per_face = index_count / faces;
+        if(thread_count == 0)
+            thread_count = hrs::hardware_thread_count();
+
+        thread_count = std::clamp<std::size_t>(faces / PARALLEL_MIN_FACES, 1, thread_count);
+        hrs::parallel_for(
+            faces,
+            thread_count,
+            [&](std::size_t begin, std::size_t end, std::size_t)
+            {
+                const std::uint32_t* ids = _obj_data.GetIndices().data() + begin * face_count;
+                std::uint32_t* dst = out.data() + begin * indices_per_face;
+                if(face_count == 2)
+                    std::copy(ids, ids + (end - begin) * 2, dst);
+                else
+                {
+                    //same loop as Next: (k, k + 1), then (last, 0)
+                    for(std::size_t face = begin; face < end; face++, ids += face_count)
+                    {
+                        for(std::size_t k = 0; k + 1 < face_count; k++)
+                        {
+                            *dst++ = ids[k];
+                            *dst++ = ids[k + 1];
+                        }
+
+                        *dst++ = ids[face_count - 1];
+                        *dst++ = ids[0];
+                    }
+                }
+            });
+
+        return true;
+    }
 };
@@ -0,0 +1,278 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace GeometryParser
+{
+    VertexCacheStatistics AnalyzeVertexCache(std::span<const std::uint32_t> indices,
+                                             std::size_t vertex_count,
+                                             std::size_t cache_size)
+    {
+        VertexCacheStatistics statistics = {.transformed_vertices = 0, .acmr = 0, .atvr = 0};
+        std::size_t triangle_count = indices.size() / 3;
+        if(triangle_count == 0)
+            return statistics;
+
+        //a vertex is cached while less than cache_size misses happened after its own one
+        std::vector<std::size_t> miss_time(vertex_count, 0);
+        std::size_t time = cache_size + 1;
+        std::size_t referenced = 0;
+        for(auto index: indices.first(triangle_count * 3))
+        {
+            if(miss_time[index] == 0)
+                referenced++;
+
+            if(time - miss_time[index] > cache_size)
+            {
+                miss_time[index] = time++;
+                statistics.transformed_vertices++;
+            }
+        }
+
+        statistics.acmr = float(statistics.transformed_vertices) / triangle_count;
+        statistics.atvr = float(statistics.transformed_vertices) / referenced;
+        return statistics;
+    }
+
+    std::vector<std::uint32_t> OptimizeVertexCache(std::span<std::uint32_t> indices,
+                                                   std::size_t vertex_count,
+                                                   std::size_t cache_size)
+    {
+        std::vector<std::uint32_t> clusters;
+        std::size_t triangle_count = indices.size() / 3;
+        if(triangle_count == 0)
+            return clusters;
+
+        //triangles of every vertex
+        std::vector<std::uint32_t> live(vertex_count, 0);
+        for(auto index: indices.first(triangle_count * 3))
+            live[index]++;
+
+        std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+        std::inclusive_scan(live.begin(), live.end(), offsets.begin() + 1);
+        std::vector<std::uint32_t> adjacency(triangle_count * 3);
+        {
+            std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for(std::size_t triangle = 0; triangle < triangle_count; triangle++)
+                for(std::size_t corner = 0; corner < 3; corner++)
+                    adjacency[fill[indices[triangle * 3 + corner]]++] = triangle;
+        }
+
+        std::vector<std::size_t> cache_time(vertex_count, 0);
+        std::vector<bool> emitted(triangle_count, false);
+        std::vector<std::uint32_t> dead_end;
+        std::vector<std::uint32_t> candidates;
+        std::vector<std::uint32_t> result;
+        dead_end.reserve(triangle_count * 3);
+        result.reserve(triangle_count * 3);
+
+        std::size_t time = cache_size + 1;
+        std::size_t cursor = 0;
+        auto skip_dead_end = [&]() -> std::size_t
+        {
+            while(!dead_end.empty())
+            {
+                std::uint32_t vertex = dead_end.back();
+                dead_end.pop_back();
+                if(live[vertex] != 0)
+                    return vertex;
+            }
+
+            for(; cursor < vertex_count; cursor++)
+                if(live[cursor] != 0)
+                    return cursor;
+
+            return vertex_count;
+        };
+
+        std::size_t fanning = skip_dead_end();
+        bool new_cluster = true;
+        while(fanning != vertex_count)
+        {
+            if(new_cluster)
+                clusters.push_back(result.size() / 3);
+
+            candidates.clear();
+            for(std::size_t i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+            {
+                std::uint32_t triangle = adjacency[i];
+                if(emitted[triangle])
+                    continue;
+
+                emitted[triangle] = true;
+                for(std::size_t corner = 0; corner < 3; corner++)
+                {
+                    std::uint32_t vertex = indices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    dead_end.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live[vertex]--;
+                    if(time - cache_time[vertex] > cache_size)
+                        cache_time[vertex] = time++;
+                }
+            }
+
+            //prefer the oldest candidate that stays in the cache while its fan is emitted
+            std::size_t next = vertex_count;
+            std::size_t best_priority = 0;
+            for(auto vertex: candidates)
+            {
+                if(live[vertex] == 0)
+                    continue;
+
+                std::size_t priority = 0;
+                if(time - cache_time[vertex] + 2 * live[vertex] <= cache_size)
+                    priority = time - cache_time[vertex];
+
+                if(next == vertex_count || priority > best_priority)
+                {
+                    best_priority = priority;
+                    next = vertex;
+                }
+            }
+
+            new_cluster = (next == vertex_count);
+            fanning = (new_cluster ? skip_dead_end() : next);
+        }
+
+        std::ranges::copy(result, indices.begin());
+        return clusters;
+    }
+
+    void OptimizeOverdraw(std::span<std::uint32_t> indices,
+                          const ObjData& obj_data,
+                          std::span<const std::uint32_t> clusters)
+    {
+        std::size_t triangle_count = indices.size() / 3;
+        if(clusters.size() < 2)
+            return;
+
+        auto position = [&](std::uint32_t id)
+        {
+            return obj_data.GetVertexByIndex(obj_data.GetUniqueFaces()[id].vertex - 1);
+        };
+
+        auto cluster_end = [&](std::size_t cluster) -> std::size_t
+        {
+            return (cluster + 1 < clusters.size() ? clusters[cluster + 1] : triangle_count);
+        };
+
+        struct cluster_data
+        {
+            std::array<float, 3> centroid;
+            std::array<float, 3> normal;
+            float area;
+            float sort_key;
+        };
+
+        std::vector<cluster_data> cluster_datas(clusters.size());
+        std::array<float, 3> mesh_centroid = {0, 0, 0};
+        float mesh_area = 0;
+        for(std::size_t cluster = 0; cluster < clusters.size(); cluster++)
+        {
+            auto& data = cluster_datas[cluster];
+            data = {.centroid = {0, 0, 0}, .normal = {0, 0, 0}, .area = 0, .sort_key = 0};
+            std::size_t end = cluster_end(cluster);
+            for(std::size_t triangle = clusters[cluster]; triangle < end; triangle++)
+            {
+                const float* v0 = position(indices[triangle * 3]);
+                const float* v1 = position(indices[triangle * 3 + 1]);
+                const float* v2 = position(indices[triangle * 3 + 2]);
+                float e1[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]};
+                float e2[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
+                float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                                   e1[2] * e2[0] - e1[0] * e2[2],
+                                   e1[0] * e2[1] - e1[1] * e2[0]};
+                float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                                       normal[2] * normal[2]);
+
+                for(int i = 0; i < 3; i++)
+                {
+                    data.centroid[i] += (v0[i] + v1[i] + v2[i]) / 3 * area;
+                    data.normal[i] += normal[i];
+                }
+
+                data.area += area;
+            }
+
+            for(int i = 0; i < 3; i++)
+                mesh_centroid[i] += data.centroid[i];
+
+            mesh_area += data.area;
+            if(data.area > 0)
+                for(int i = 0; i < 3; i++)
+                    data.centroid[i] /= data.area;
+        }
+
+        if(mesh_area > 0)
+            for(int i = 0; i < 3; i++)
+                mesh_centroid[i] /= mesh_area;
+
+        for(auto& data: cluster_datas)
+        {
+            const auto& [x, y, z] = data.normal;
+            float len = std::sqrt(x * x + y * y + z * z);
+            if(len == 0)
+                continue;
+
+            for(int i = 0; i < 3; i++)
+                data.sort_key += (data.centroid[i] - mesh_centroid[i]) * data.normal[i] / len;
+        }
+
+        std::vector<std::uint32_t> order(clusters.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order,
+                                 [&](std::uint32_t cluster1, std::uint32_t cluster2)
+                                 {
+                                     return cluster_datas[cluster1].sort_key >
+                                            cluster_datas[cluster2].sort_key;
+                                 });
+
+        std::vector<std::uint32_t> result;
+        result.reserve(triangle_count * 3);
+        for(auto cluster: order)
+        {
+            result.insert(result.end(),
+                          indices.begin() + clusters[cluster] * 3,
+                          indices.begin() + cluster_end(cluster) * 3);
+        }
+
+        std::ranges::copy(result, indices.begin());
+    }
+
+    std::vector<std::uint32_t> OptimizeVertexFetch(std::span<std::uint32_t> indices,
+                                                   std::size_t vertex_count)
+    {
+        std::vector<std::uint32_t> remap(vertex_count, UNUSED_VERTEX);
+        std::uint32_t next = 0;
+        for(auto& index: indices)
+        {
+            if(remap[index] == UNUSED_VERTEX)
+                remap[index] = next++;
+
+            index = remap[index];
+        }
+
+        return remap;
+    }
+
+    MeshOptimizationResult OptimizeMesh(const ObjData& obj_data,
+                                        std::span<std::uint32_t> indices,
+                                        const MeshOptimizationSettings& settings)
+    {
+        std::size_t vertex_count = obj_data.GetUniqueFaces().size();
+        MeshOptimizationResult result;
+        result.before = AnalyzeVertexCache(indices, vertex_count, settings.cache_size);
+
+        auto clusters = OptimizeVertexCache(indices, vertex_count, settings.cache_size);
+        if(settings.optimize_overdraw)
+            OptimizeOverdraw(indices, obj_data, clusters);
+
+        result.remap = OptimizeVertexFetch(indices, vertex_count);
+        result.after = AnalyzeVertexCache(indices, vertex_count, settings.cache_size);
+        return result;
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ObjData.h"
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace GeometryParser
+{
+    constexpr inline std::size_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+    constexpr inline std::uint32_t UNUSED_VERTEX = std::numeric_limits<std::uint32_t>::max();
+
+    struct VertexCacheStatistics
+    {
+        std::size_t transformed_vertices;
+        float acmr; //transformed vertices per triangle, 0.5 at best, 3 at worst
+        float atvr; //transformed vertices per referenced vertex, 1 at best
+    };
+
+    struct MeshOptimizationSettings
+    {
+        std::size_t cache_size;
+        bool optimize_overdraw;
+    };
+
+    struct MeshOptimizationResult
+    {
+        VertexCacheStatistics before;
+        VertexCacheStatistics after;
+        std::vector<std::uint32_t> remap; //new id of every old id, UNUSED_VERTEX if unreferenced
+    };
+
+    //simulates a FIFO post-transform cache over a triangle list
+    VertexCacheStatistics AnalyzeVertexCache(std::span<const std::uint32_t> indices,
+                                             std::size_t vertex_count,
+                                             std::size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+    //Reorders triangles for the post-transform cache with Tipsify (Sander et al. 2007):
+    //fans around the vertex that stays in the cache longest and skips to a dead-end vertex
+    //when the fan runs dry. Returns the first triangle of every cluster between such skips.
+    std::vector<std::uint32_t>
+    OptimizeVertexCache(std::span<std::uint32_t> indices,
+                        std::size_t vertex_count,
+                        std::size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+    //Reorders clusters from OptimizeVertexCache so that the ones facing outwards from the
+    //centroid of the mesh are drawn first and occlude the rest, triangles inside clusters keep
+    //their order. indices are unique face ids of obj_data.
+    void OptimizeOverdraw(std::span<std::uint32_t> indices,
+                          const ObjData& obj_data,
+                          std::span<const std::uint32_t> clusters);
+
+    //Renumbers vertices in order of their first use, so the vertex buffer is fetched
+    //sequentially. Returns the remap table, vertex data must be reordered with it.
+    std::vector<std::uint32_t> OptimizeVertexFetch(std::span<std::uint32_t> indices,
+                                                   std::size_t vertex_count);
+
+    //All of the above over unique face ids from Triangulator::TriangulateAll,
+    //vertex data of unique faces must be reordered with the returned remap table
+    MeshOptimizationResult OptimizeMesh(const ObjData& obj_data,
+                                        std::span<std::uint32_t> indices,
+                                        const MeshOptimizationSettings& settings);
+};
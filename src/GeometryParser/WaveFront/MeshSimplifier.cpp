@@ -0,0 +1,630 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+namespace GeometryParser
+{
+    //symmetric 4x4 plane quadric, weighted by triangle area
+    struct simplifier_quadric
+    {
+        double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+        double weight;
+
+        simplifier_quadric& operator+=(const simplifier_quadric& q) noexcept
+        {
+            a2 += q.a2;
+            ab += q.ab;
+            ac += q.ac;
+            ad += q.ad;
+            b2 += q.b2;
+            bc += q.bc;
+            bd += q.bd;
+            c2 += q.c2;
+            cd += q.cd;
+            d2 += q.d2;
+            weight += q.weight;
+            return *this;
+        }
+
+        //mean squared distance to the accumulated planes
+        double Evaluate(const float* p) const noexcept
+        {
+            double x = p[0], y = p[1], z = p[2];
+            double error = a2 * x * x + b2 * y * y + c2 * z * z + d2 +
+                           2 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z);
+            return (weight > 0 ? std::abs(error) / weight : 0);
+        }
+    };
+
+    struct simplifier_collapse
+    {
+        std::uint32_t from; //positions
+        std::uint32_t to;
+        double error;
+        //every id of from moves to the id of to on the same side of the collapsed edge
+        std::array<std::uint32_t, 2> from_ids;
+        std::array<std::uint32_t, 2> to_ids;
+        std::uint32_t id_count;
+    };
+
+    struct simplifier_edge
+    {
+        std::uint64_t key; //lower position << 32 | higher position
+        std::uint32_t low_id;
+        std::uint32_t high_id;
+    };
+
+    enum class simplifier_vertex_kind
+    {
+        Free, //one id, no discontinuity edges
+        Seam, //two seam or border edges, moves only along them
+        Locked //corners, non-manifold vertices
+    };
+
+    static std::array<double, 3>
+    triangle_cross(const float* v0, const float* v1, const float* v2) noexcept
+    {
+        double e1[3] = {double(v1[0]) - v0[0], double(v1[1]) - v0[1], double(v1[2]) - v0[2]};
+        double e2[3] = {double(v2[0]) - v0[0], double(v2[1]) - v0[1], double(v2[2]) - v0[2]};
+        return {e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0]};
+    }
+
+    static simplifier_quadric
+    plane_quadric(double a, double b, double c, double d, double w) noexcept
+    {
+        return {.a2 = a * a * w,
+                .ab = a * b * w,
+                .ac = a * c * w,
+                .ad = a * d * w,
+                .b2 = b * b * w,
+                .bc = b * c * w,
+                .bd = b * d * w,
+                .c2 = c * c * w,
+                .cd = c * d * w,
+                .d2 = d * d * w,
+                .weight = w};
+    }
+
+    //Topology is tracked by positions, ids only say which attributes a corner uses.
+    //An edge is a discontinuity if it's a border or the ids on its sides differ.
+    class mesh_simplifier
+    {
+    public:
+        mesh_simplifier(const ObjData& _obj_data, std::span<const std::uint32_t> _indices)
+            : obj_data(&_obj_data),
+              indices(_indices.begin(), _indices.begin() + _indices.size() / 3 * 3),
+              vertex_count(_obj_data.GetUniqueFaces().size()),
+              position_count(_obj_data.GetVertices().size() /
+                             _obj_data.GetSchema().vertex_components),
+              quadrics(position_count, simplifier_quadric{}),
+              extent(0)
+        {
+            merge_equal_ids();
+            compute_extent();
+            for(std::size_t triangle = 0; triangle < indices.size() / 3; triangle++)
+                add_triangle_quadric(triangle);
+
+            build_edges();
+            add_discontinuity_quadrics();
+        }
+
+        float Simplify(std::size_t target_index_count, float target_error)
+        {
+            double max_error = (target_error == SIMPLIFY_NO_ERROR_LIMIT
+                                    ? std::numeric_limits<double>::max()
+                                    : double(target_error) * extent);
+            double result_error = 0;
+            while(indices.size() > target_index_count)
+            {
+                std::size_t removed_goal = (indices.size() - target_index_count) / 3;
+                double pass_error = 0;
+                if(!collapse_pass(removed_goal, max_error * max_error, pass_error))
+                    break;
+
+                result_error = std::max(result_error, pass_error);
+            }
+
+            return (extent > 0 ? float(std::sqrt(result_error) / extent) : 0.0f);
+        }
+
+        std::vector<std::uint32_t>& GetIndices() noexcept
+        {
+            return indices;
+        }
+    private:
+        const float* position(std::uint32_t pos) const noexcept
+        {
+            return obj_data->GetVertexByIndex(pos);
+        }
+
+        std::uint32_t position_index(std::uint32_t id) const noexcept
+        {
+            return obj_data->GetUniqueFaces()[id].vertex - 1;
+        }
+
+        //vt and vn values of id, exporters often write equal values under different indices
+        std::array<float, 6> attributes(std::uint32_t id) const noexcept
+        {
+            const auto& face = obj_data->GetUniqueFaces()[id];
+            std::array<float, 6> values = {};
+            if(face.texture_coordinates != 0)
+            {
+                const float* tc = obj_data->GetTextureCoordinatesByIndex(face.texture_coordinates - 1);
+                for(std::size_t i = 0; i < obj_data->GetSchema().texture_components; i++)
+                    values[i] = tc[i];
+            }
+
+            if(face.normal != 0)
+            {
+                const float* normal = obj_data->GetNormalByIndex(face.normal - 1);
+                for(std::size_t i = 0; i < 3; i++)
+                    values[3 + i] = normal[i];
+            }
+
+            return values;
+        }
+
+        //ids with the same position and attribute values are replaced with the smallest of them,
+        //so only real attribute discontinuities are treated as seams
+        void merge_equal_ids()
+        {
+            std::vector<std::uint32_t> ids(indices.begin(), indices.end());
+            std::ranges::sort(ids);
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            auto key = [this](std::uint32_t id)
+            {
+                const auto& face = obj_data->GetUniqueFaces()[id];
+                return std::tuple(position_index(id),
+                                  face.texture_coordinates != 0,
+                                  face.normal != 0,
+                                  attributes(id));
+            };
+
+            std::ranges::stable_sort(ids,
+                                     [&key](std::uint32_t id1, std::uint32_t id2)
+                                     {
+                                         return key(id1) < key(id2);
+                                     });
+
+            std::vector<std::uint32_t> remap(vertex_count);
+            for(std::size_t i = 0; i < ids.size(); i++)
+                remap[ids[i]] = (i != 0 && key(ids[i - 1]) == key(ids[i]) ? remap[ids[i - 1]]
+                                                                           : ids[i]);
+
+            for(auto& id: indices)
+                id = remap[id];
+        }
+
+        void compute_extent() noexcept
+        {
+            if(indices.empty())
+                return;
+
+            std::array<float, 3> min_point = {std::numeric_limits<float>::max(),
+                                              std::numeric_limits<float>::max(),
+                                              std::numeric_limits<float>::max()};
+            std::array<float, 3> max_point = {std::numeric_limits<float>::lowest(),
+                                              std::numeric_limits<float>::lowest(),
+                                              std::numeric_limits<float>::lowest()};
+            for(auto id: indices)
+            {
+                const float* point = position(position_index(id));
+                for(int i = 0; i < 3; i++)
+                {
+                    min_point[i] = std::min(min_point[i], point[i]);
+                    max_point[i] = std::max(max_point[i], point[i]);
+                }
+            }
+
+            double diagonal = 0;
+            for(int i = 0; i < 3; i++)
+                diagonal += double(max_point[i] - min_point[i]) * (max_point[i] - min_point[i]);
+
+            extent = std::sqrt(diagonal);
+        }
+
+        void add_triangle_quadric(std::size_t triangle) noexcept
+        {
+            const std::uint32_t* corners = indices.data() + triangle * 3;
+            const float* v0 = position(position_index(corners[0]));
+            auto normal = triangle_cross(v0,
+                                         position(position_index(corners[1])),
+                                         position(position_index(corners[2])));
+            double len =
+                std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if(len == 0)
+                return;
+
+            double a = normal[0] / len, b = normal[1] / len, c = normal[2] / len;
+            double d = -(a * v0[0] + b * v0[1] + c * v0[2]);
+            simplifier_quadric q = plane_quadric(a, b, c, d, len / 2);
+            for(std::size_t corner = 0; corner < 3; corner++)
+                quadrics[position_index(corners[corner])] += q;
+        }
+
+        //sorted edges of all triangles, each triangle adds one record per edge
+        void build_edges()
+        {
+            edges.clear();
+            edge_triangles.clear();
+            for(std::size_t triangle = 0; triangle < indices.size() / 3; triangle++)
+                for(std::size_t corner = 0; corner < 3; corner++)
+                {
+                    std::uint32_t id1 = indices[triangle * 3 + corner];
+                    std::uint32_t id2 = indices[triangle * 3 + (corner + 1) % 3];
+                    std::uint64_t p1 = position_index(id1);
+                    std::uint64_t p2 = position_index(id2);
+                    if(p1 > p2)
+                    {
+                        std::swap(p1, p2);
+                        std::swap(id1, id2);
+                    }
+
+                    edges.push_back({.key = (p1 << 32) | p2, .low_id = id1, .high_id = id2});
+                    edge_triangles.push_back(triangle);
+                }
+
+            std::vector<std::uint32_t> order(edges.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::ranges::sort(order,
+                              [this](std::uint32_t e1, std::uint32_t e2)
+                              {
+                                  return edges[e1].key < edges[e2].key;
+                              });
+
+            std::vector<simplifier_edge> sorted_edges(edges.size());
+            std::vector<std::uint32_t> sorted_triangles(edges.size());
+            for(std::size_t i = 0; i < order.size(); i++)
+            {
+                sorted_edges[i] = edges[order[i]];
+                sorted_triangles[i] = edge_triangles[order[i]];
+            }
+
+            edges = std::move(sorted_edges);
+            edge_triangles = std::move(sorted_triangles);
+        }
+
+        std::size_t edge_group_end(std::size_t begin) const noexcept
+        {
+            std::size_t end = begin + 1;
+            while(end < edges.size() && edges[end].key == edges[begin].key)
+                end++;
+
+            return end;
+        }
+
+        bool is_discontinuity(std::size_t begin, std::size_t end) const noexcept
+        {
+            return end - begin == 1 ||
+                   (end - begin == 2 && (edges[begin].low_id != edges[begin + 1].low_id ||
+                                         edges[begin].high_id != edges[begin + 1].high_id));
+        }
+
+        //planes through seam and border edges perpendicular to their triangles,
+        //so vertices sliding along them keep the outline
+        void add_discontinuity_quadrics() noexcept
+        {
+            for(std::size_t begin = 0; begin < edges.size();)
+            {
+                std::size_t end = edge_group_end(begin);
+                if(is_discontinuity(begin, end))
+                    for(std::size_t i = begin; i < end; i++)
+                    {
+                        const std::uint32_t* corners = indices.data() + edge_triangles[i] * 3;
+                        auto normal = triangle_cross(position(position_index(corners[0])),
+                                                     position(position_index(corners[1])),
+                                                     position(position_index(corners[2])));
+                        const float* v0 = position(std::uint32_t(edges[i].key >> 32));
+                        const float* v1 = position(std::uint32_t(edges[i].key & 0xFFFF'FFFF));
+                        double edge[3] = {double(v1[0]) - v0[0],
+                                          double(v1[1]) - v0[1],
+                                          double(v1[2]) - v0[2]};
+                        double plane[3] = {edge[1] * normal[2] - edge[2] * normal[1],
+                                           edge[2] * normal[0] - edge[0] * normal[2],
+                                           edge[0] * normal[1] - edge[1] * normal[0]};
+                        double len = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] +
+                                               plane[2] * plane[2]);
+                        if(len == 0)
+                            continue;
+
+                        double a = plane[0] / len, b = plane[1] / len, c = plane[2] / len;
+                        double d = -(a * v0[0] + b * v0[1] + c * v0[2]);
+                        double w = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+                        simplifier_quadric q = plane_quadric(a, b, c, d, w);
+                        quadrics[std::uint32_t(edges[i].key >> 32)] += q;
+                        quadrics[std::uint32_t(edges[i].key & 0xFFFF'FFFF)] += q;
+                    }
+
+                begin = end;
+            }
+        }
+
+        void classify_vertices()
+        {
+            id_counts.assign(position_count, 0);
+            std::vector<bool> used_ids(vertex_count, false);
+            for(auto id: indices)
+                if(!used_ids[id])
+                {
+                    used_ids[id] = true;
+                    id_counts[position_index(id)]++;
+                }
+
+            std::vector<std::uint32_t> discontinuity_counts(position_count, 0);
+            std::vector<bool> non_manifold(position_count, false);
+            for(std::size_t begin = 0; begin < edges.size();)
+            {
+                std::size_t end = edge_group_end(begin);
+                auto p1 = std::uint32_t(edges[begin].key >> 32);
+                auto p2 = std::uint32_t(edges[begin].key & 0xFFFF'FFFF);
+                if(end - begin > 2)
+                    non_manifold[p1] = non_manifold[p2] = true;
+                else if(is_discontinuity(begin, end))
+                {
+                    discontinuity_counts[p1]++;
+                    discontinuity_counts[p2]++;
+                }
+
+                begin = end;
+            }
+
+            kinds.assign(position_count, simplifier_vertex_kind::Locked);
+            for(std::size_t pos = 0; pos < position_count; pos++)
+                if(!non_manifold[pos])
+                {
+                    if(discontinuity_counts[pos] == 0 && id_counts[pos] == 1)
+                        kinds[pos] = simplifier_vertex_kind::Free;
+                    else if(discontinuity_counts[pos] == 2 && id_counts[pos] <= 2)
+                        kinds[pos] = simplifier_vertex_kind::Seam;
+                }
+        }
+
+        //maps every id of from to the id of to in the triangles of the edge,
+        //fails if from has ids on other sides or one id would go to several ids
+        bool map_edge_ids(simplifier_collapse& collapse,
+                          std::size_t begin,
+                          std::size_t end) const noexcept
+        {
+            bool from_is_low = (std::uint32_t(edges[begin].key >> 32) == collapse.from);
+            collapse.id_count = 0;
+            for(std::size_t i = begin; i < end; i++)
+            {
+                std::uint32_t from_id = (from_is_low ? edges[i].low_id : edges[i].high_id);
+                std::uint32_t to_id = (from_is_low ? edges[i].high_id : edges[i].low_id);
+                bool found = false;
+                for(std::uint32_t j = 0; j < collapse.id_count; j++)
+                    if(collapse.from_ids[j] == from_id)
+                    {
+                        if(collapse.to_ids[j] != to_id)
+                            return false;
+
+                        found = true;
+                    }
+
+                if(!found)
+                {
+                    collapse.from_ids[collapse.id_count] = from_id;
+                    collapse.to_ids[collapse.id_count] = to_id;
+                    collapse.id_count++;
+                }
+            }
+
+            return collapse.id_count == id_counts[collapse.from];
+        }
+
+        //triangles around from must keep their orientation once from is replaced with to
+        bool collapse_flips(std::uint32_t from, std::uint32_t to) const noexcept
+        {
+            for(std::size_t i = offsets[from]; i < offsets[from + 1]; i++)
+            {
+                const std::uint32_t* corners = indices.data() + adjacency[i] * 3;
+                std::uint32_t positions[3] = {position_index(corners[0]),
+                                              position_index(corners[1]),
+                                              position_index(corners[2])};
+                if(positions[0] == to || positions[1] == to || positions[2] == to)
+                    continue;
+
+                const float* before[3];
+                const float* after[3];
+                for(std::size_t corner = 0; corner < 3; corner++)
+                {
+                    before[corner] = position(positions[corner]);
+                    after[corner] = (positions[corner] == from ? position(to) : before[corner]);
+                }
+
+                auto n1 = triangle_cross(before[0], before[1], before[2]);
+                auto n2 = triangle_cross(after[0], after[1], after[2]);
+                if(n1[0] * n2[0] + n1[1] * n2[1] + n1[2] * n2[2] <= 0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        void build_adjacency()
+        {
+            std::size_t triangle_count = indices.size() / 3;
+            offsets.assign(position_count + 1, 0);
+            for(auto id: indices)
+                offsets[position_index(id) + 1]++;
+
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            adjacency.resize(indices.size());
+            std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for(std::size_t triangle = 0; triangle < triangle_count; triangle++)
+                for(std::size_t corner = 0; corner < 3; corner++)
+                    adjacency[fill[position_index(indices[triangle * 3 + corner])]++] = triangle;
+        }
+
+        //Applies the cheapest independent collapses, the one-ring of a collapsed position
+        //is frozen until the next pass, so flip checks stay valid
+        bool collapse_pass(std::size_t removed_goal, double max_error, double& pass_error)
+        {
+            build_edges();
+            build_adjacency();
+            classify_vertices();
+
+            collapses.clear();
+            for(std::size_t begin = 0; begin < edges.size();)
+            {
+                std::size_t end = edge_group_end(begin);
+                auto p1 = std::uint32_t(edges[begin].key >> 32);
+                auto p2 = std::uint32_t(edges[begin].key & 0xFFFF'FFFF);
+                bool discontinuity = is_discontinuity(begin, end);
+                for(auto [from, to]: {std::pair(p1, p2), std::pair(p2, p1)})
+                {
+                    //seam and border vertices slide only along their own line
+                    if(kinds[from] == simplifier_vertex_kind::Locked ||
+                       (kinds[from] == simplifier_vertex_kind::Seam && !discontinuity))
+                        continue;
+
+                    simplifier_collapse collapse = {.from = from,
+                                                    .to = to,
+                                                    .error = 0,
+                                                    .from_ids = {},
+                                                    .to_ids = {},
+                                                    .id_count = 0};
+                    if(!map_edge_ids(collapse, begin, end))
+                        continue;
+
+                    simplifier_quadric q = quadrics[from];
+                    q += quadrics[to];
+                    collapse.error = q.Evaluate(position(to));
+                    collapses.push_back(collapse);
+                }
+
+                begin = end;
+            }
+
+            std::ranges::sort(collapses, {}, &simplifier_collapse::error);
+
+            std::vector<bool> frozen(position_count, false);
+            std::vector<std::uint32_t> remap(vertex_count);
+            std::iota(remap.begin(), remap.end(), 0);
+            std::size_t removed = 0;
+            std::size_t applied = 0;
+            for(const auto& collapse: collapses)
+            {
+                if(collapse.error > max_error || removed >= removed_goal)
+                    break;
+
+                if(frozen[collapse.from] || frozen[collapse.to] ||
+                   collapse_flips(collapse.from, collapse.to))
+                    continue;
+
+                for(std::size_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; i++)
+                {
+                    const std::uint32_t* corners = indices.data() + adjacency[i] * 3;
+                    bool has_to = false;
+                    for(std::size_t corner = 0; corner < 3; corner++)
+                    {
+                        std::uint32_t pos = position_index(corners[corner]);
+                        has_to |= (pos == collapse.to);
+                        frozen[pos] = true;
+                    }
+
+                    removed += has_to;
+                }
+
+                for(std::uint32_t i = 0; i < collapse.id_count; i++)
+                    remap[collapse.from_ids[i]] = collapse.to_ids[i];
+
+                quadrics[collapse.to] += quadrics[collapse.from];
+                pass_error = std::max(pass_error, collapse.error);
+                applied++;
+            }
+
+            if(applied == 0)
+                return false;
+
+            std::size_t write = 0;
+            for(std::size_t triangle = 0; triangle < indices.size() / 3; triangle++)
+            {
+                std::uint32_t v0 = remap[indices[triangle * 3]];
+                std::uint32_t v1 = remap[indices[triangle * 3 + 1]];
+                std::uint32_t v2 = remap[indices[triangle * 3 + 2]];
+                std::uint32_t p0 = position_index(v0);
+                std::uint32_t p1 = position_index(v1);
+                std::uint32_t p2 = position_index(v2);
+                if(p0 == p1 || p1 == p2 || p0 == p2)
+                    continue;
+
+                indices[write++] = v0;
+                indices[write++] = v1;
+                indices[write++] = v2;
+            }
+
+            indices.resize(write);
+            return true;
+        }
+    private:
+        const ObjData* obj_data;
+        std::vector<std::uint32_t> indices;
+        std::size_t vertex_count;
+        std::size_t position_count;
+        std::vector<simplifier_quadric> quadrics;
+        double extent;
+        std::vector<simplifier_edge> edges;
+        std::vector<std::uint32_t> edge_triangles;
+        std::vector<simplifier_vertex_kind> kinds;
+        std::vector<std::uint32_t> id_counts; //distinct ids per position
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> adjacency;
+        std::vector<simplifier_collapse> collapses;
+    };
+
+    std::vector<std::uint32_t> SimplifyMesh(const ObjData& obj_data,
+                                            std::span<const std::uint32_t> indices,
+                                            std::size_t target_index_count,
+                                            float target_error,
+                                            float* result_error)
+    {
+        mesh_simplifier simplifier(obj_data, indices);
+        float error = simplifier.Simplify(target_index_count, target_error);
+        if(result_error)
+            *result_error = error;
+
+        return std::move(simplifier.GetIndices());
+    }
+
+    MeshLodChain BuildLodChain(const ObjData& obj_data,
+                               std::span<const std::uint32_t> indices,
+                               std::span<const float> ratios,
+                               float target_error)
+    {
+        MeshLodChain chain;
+        chain.indices.assign(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+        chain.levels.push_back(
+            {.index_offset = 0, .index_count = chain.indices.size(), .error = 0});
+
+        std::size_t triangle_count = indices.size() / 3;
+        for(float ratio: ratios)
+        {
+            const auto& prev = chain.levels.back();
+            std::size_t target = std::size_t(triangle_count * std::clamp(ratio, 0.0f, 1.0f)) * 3;
+            if(target >= prev.index_count)
+                continue;
+
+            float error = 0;
+            auto prev_indices =
+                std::span(chain.indices).subspan(prev.index_offset, prev.index_count);
+            auto lod_indices = SimplifyMesh(obj_data, prev_indices, target, target_error, &error);
+            if(lod_indices.size() >= prev.index_count)
+                break;
+
+            MeshLodLevel level = {.index_offset = chain.indices.size(),
+                                  .index_count = lod_indices.size(),
+                                  .error = prev.error + error};
+            chain.indices.insert(chain.indices.end(), lod_indices.begin(), lod_indices.end());
+            chain.levels.push_back(level);
+        }
+
+        return chain;
+    }
+};
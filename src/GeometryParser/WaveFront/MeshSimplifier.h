@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ObjData.h"
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace GeometryParser
+{
+    constexpr inline float SIMPLIFY_NO_ERROR_LIMIT = std::numeric_limits<float>::max();
+
+    struct MeshLodLevel
+    {
+        std::size_t index_offset; //in MeshLodChain::indices
+        std::size_t index_count;
+        float error; //relative to the diagonal of the mesh bounding box
+    };
+
+    struct MeshLodChain
+    {
+        std::vector<std::uint32_t> indices; //all levels one after another
+        std::vector<MeshLodLevel> levels; //level 0 is the source
+    };
+
+    //Collapses edges in order of their quadric error (Garland-Heckbert) until the result has
+    //at most target_index_count indices or the next collapse exceeds target_error.
+    //A position collapses onto a neighbour instead of a new point, so the result indexes the
+    //same unique face ids. Ids of a position with equal vt/vn values are merged first.
+    //Edges where the ids differ on the two sides (UV/normal seams) and open borders are
+    //discontinuities: a vertex on one only slides along it, every id moving to the id on its
+    //side, and corners where several discontinuities meet never move. Curved flat-shaded
+    //meshes have a normal seam on every edge and keep their shape.
+    //indices are unique face ids of obj_data, e.g. from Triangulator::TriangulateAll.
+    std::vector<std::uint32_t> SimplifyMesh(const ObjData& obj_data,
+                                            std::span<const std::uint32_t> indices,
+                                            std::size_t target_index_count,
+                                            float target_error = SIMPLIFY_NO_ERROR_LIMIT,
+                                            float* result_error = nullptr);
+
+    //Every next level is simplified from the previous one down to ratios[i] of the source
+    //triangles, its error is the sum of errors of all steps, so it never underestimates.
+    //Levels that can't be simplified further are not added.
+    MeshLodChain BuildLodChain(const ObjData& obj_data,
+                               std::span<const std::uint32_t> indices,
+                               std::span<const float> ratios,
+                               float target_error = SIMPLIFY_NO_ERROR_LIMIT);
+};
@@ -0,0 +1,316 @@
+#include "MeshletBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace GeometryParser
+{
+    constexpr static std::uint32_t NOT_IN_MESHLET = std::numeric_limits<std::uint32_t>::max();
+    //cones that are wider than that can't cull anything in practice
+    constexpr static float MESHLET_MIN_CONE_DOT = 0.1f;
+
+    static float distance_squared(const float* p1, const float* p2) noexcept
+    {
+        float x = p1[0] - p2[0], y = p1[1] - p2[1], z = p1[2] - p2[2];
+        return x * x + y * y + z * z;
+    }
+
+    static void normalize(std::array<float, 3>& vec) noexcept
+    {
+        float len = std::sqrt(vec[0] * vec[0] + vec[1] * vec[1] + vec[2] * vec[2]);
+        if(len != 0)
+            for(auto& value: vec)
+                value /= len;
+    }
+
+    //Ritter's bounding sphere
+    template<typename P>
+    static void calculate_sphere(MeshletBounds& bounds,
+                                 std::span<const std::uint32_t> vertices,
+                                 P&& position) noexcept
+    {
+        auto farthest = [&](const float* from)
+        {
+            const float* result = position(vertices[0]);
+            for(auto vertex: vertices)
+                if(distance_squared(position(vertex), from) > distance_squared(result, from))
+                    result = position(vertex);
+
+            return result;
+        };
+
+        const float* p1 = farthest(position(vertices[0]));
+        const float* p2 = farthest(p1);
+        for(int i = 0; i < 3; i++)
+            bounds.center[i] = (p1[i] + p2[i]) / 2;
+
+        bounds.radius = std::sqrt(distance_squared(p1, p2)) / 2;
+        for(auto vertex: vertices)
+        {
+            const float* p = position(vertex);
+            float distance = std::sqrt(distance_squared(p, bounds.center.data()));
+            if(distance <= bounds.radius)
+                continue;
+
+            float new_radius = (bounds.radius + distance) / 2;
+            float shift = (new_radius - bounds.radius) / distance;
+            for(int i = 0; i < 3; i++)
+                bounds.center[i] += (p[i] - bounds.center[i]) * shift;
+
+            bounds.radius = new_radius;
+        }
+    }
+
+    template<typename P>
+    static void calculate_cone(MeshletBounds& bounds,
+                               std::span<const std::uint32_t> vertices,
+                               std::span<const std::uint8_t> triangles,
+                               P&& position) noexcept
+    {
+        struct triangle_plane
+        {
+            const float* point;
+            std::array<float, 3> normal;
+        };
+
+        std::vector<triangle_plane> planes;
+        planes.reserve(triangles.size() / 3);
+        std::array<float, 3> axis = {0, 0, 0};
+        for(std::size_t triangle = 0; triangle < triangles.size() / 3; triangle++)
+        {
+            const float* v0 = position(vertices[triangles[triangle * 3]]);
+            const float* v1 = position(vertices[triangles[triangle * 3 + 1]]);
+            const float* v2 = position(vertices[triangles[triangle * 3 + 2]]);
+            float e1[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]};
+            float e2[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
+            std::array<float, 3> normal = {e1[1] * e2[2] - e1[2] * e2[1],
+                                           e1[2] * e2[0] - e1[0] * e2[2],
+                                           e1[0] * e2[1] - e1[1] * e2[0]};
+            if(normal[0] == 0 && normal[1] == 0 && normal[2] == 0)
+                continue;
+
+            normalize(normal);
+            for(int i = 0; i < 3; i++)
+                axis[i] += normal[i];
+
+            planes.push_back({.point = v0, .normal = normal});
+        }
+
+        normalize(axis);
+        float min_dot = 1;
+        for(const auto& plane: planes)
+            min_dot = std::min(min_dot,
+                               plane.normal[0] * axis[0] + plane.normal[1] * axis[1] +
+                                   plane.normal[2] * axis[2]);
+
+        bounds.cone_axis = axis;
+        bounds.cone_apex = bounds.center;
+        if(planes.empty() || min_dot < MESHLET_MIN_CONE_DOT)
+        {
+            bounds.cone_cutoff = 1;
+            return;
+        }
+
+        //the apex is moved back along the axis until it's behind all triangle planes
+        float max_t = 0;
+        for(const auto& plane: planes)
+        {
+            float dc = 0, dn = 0;
+            for(int i = 0; i < 3; i++)
+            {
+                dc += (plane.point[i] - bounds.center[i]) * plane.normal[i];
+                dn += axis[i] * plane.normal[i];
+            }
+
+            max_t = std::max(max_t, dc / dn);
+        }
+
+        for(int i = 0; i < 3; i++)
+            bounds.cone_apex[i] = bounds.center[i] - axis[i] * max_t;
+
+        bounds.cone_cutoff = std::sqrt(1 - min_dot * min_dot);
+    }
+
+    MeshletData BuildMeshlets(const ObjData& obj_data,
+                              std::span<const std::uint32_t> indices,
+                              std::size_t max_vertices,
+                              std::size_t max_triangles)
+    {
+        MeshletData meshlet_data;
+        std::size_t triangle_count = indices.size() / 3;
+        std::size_t vertex_count = obj_data.GetUniqueFaces().size();
+        //local indices are bytes
+        max_vertices = std::clamp<std::size_t>(max_vertices, 3, 256);
+        max_triangles = std::max<std::size_t>(max_triangles, 1);
+        if(triangle_count == 0)
+            return meshlet_data;
+
+        auto position = [&](std::uint32_t id)
+        {
+            return obj_data.GetVertexByIndex(obj_data.GetUniqueFaces()[id].vertex - 1);
+        };
+
+        //triangles of every vertex
+        std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+        for(auto index: indices.first(triangle_count * 3))
+            offsets[index + 1]++;
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<std::uint32_t> adjacency(triangle_count * 3);
+        {
+            std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for(std::size_t triangle = 0; triangle < triangle_count; triangle++)
+                for(std::size_t corner = 0; corner < 3; corner++)
+                    adjacency[fill[indices[triangle * 3 + corner]]++] = triangle;
+        }
+
+        std::vector<bool> used(triangle_count, false);
+        std::vector<std::uint32_t> local(vertex_count, NOT_IN_MESHLET);
+        std::size_t cursor = 0;
+        Meshlet meshlet = {.vertex_offset = 0,
+                           .triangle_offset = 0,
+                           .vertex_count = 0,
+                           .triangle_count = 0};
+
+        auto new_vertex_count = [&](std::size_t triangle)
+        {
+            const std::uint32_t* corners = indices.data() + triangle * 3;
+            std::size_t count = (local[corners[0]] == NOT_IN_MESHLET);
+            count += (local[corners[1]] == NOT_IN_MESHLET && corners[1] != corners[0]);
+            count += (local[corners[2]] == NOT_IN_MESHLET && corners[2] != corners[0] &&
+                      corners[2] != corners[1]);
+            return count;
+        };
+
+        auto flush = [&]()
+        {
+            if(meshlet.triangle_count == 0)
+                return;
+
+            auto vertices = std::span<const std::uint32_t>(meshlet_data.vertices)
+                                .subspan(meshlet.vertex_offset, meshlet.vertex_count);
+            auto triangles = std::span<const std::uint8_t>(meshlet_data.triangles)
+                                 .subspan(meshlet.triangle_offset, meshlet.triangle_count * 3);
+
+            MeshletBounds bounds = {};
+            calculate_sphere(bounds, vertices, position);
+            calculate_cone(bounds, vertices, triangles, position);
+
+            for(auto vertex: vertices)
+                local[vertex] = NOT_IN_MESHLET;
+
+            meshlet_data.meshlets.push_back(meshlet);
+            meshlet_data.bounds.push_back(bounds);
+            meshlet_data.triangles.resize((meshlet_data.triangles.size() + 3) & ~std::size_t(3), 0);
+
+            meshlet = {.vertex_offset = static_cast<std::uint32_t>(meshlet_data.vertices.size()),
+                       .triangle_offset = static_cast<std::uint32_t>(meshlet_data.triangles.size()),
+                       .vertex_count = 0,
+                       .triangle_count = 0};
+        };
+
+        while(true)
+        {
+            std::size_t best = triangle_count;
+            std::size_t best_new = 4;
+            auto vertices = std::span<const std::uint32_t>(meshlet_data.vertices)
+                                .subspan(meshlet.vertex_offset, meshlet.vertex_count);
+            for(auto vertex: vertices)
+            {
+                for(std::size_t i = offsets[vertex]; i < offsets[vertex + 1] && best_new != 0; i++)
+                {
+                    std::uint32_t triangle = adjacency[i];
+                    if(used[triangle])
+                        continue;
+
+                    std::size_t count = new_vertex_count(triangle);
+                    if(count < best_new)
+                    {
+                        best = triangle;
+                        best_new = count;
+                    }
+                }
+
+                if(best_new == 0)
+                    break;
+            }
+
+            //nothing adjacent, continue with the next triangle in order
+            if(best == triangle_count)
+            {
+                while(cursor < triangle_count && used[cursor])
+                    cursor++;
+
+                if(cursor == triangle_count)
+                    break;
+
+                best = cursor;
+                best_new = new_vertex_count(best);
+            }
+
+            if(meshlet.vertex_count + best_new > max_vertices ||
+               meshlet.triangle_count + 1 > max_triangles)
+            {
+                flush();
+                continue;
+            }
+
+            used[best] = true;
+            for(std::size_t corner = 0; corner < 3; corner++)
+            {
+                std::uint32_t vertex = indices[best * 3 + corner];
+                if(local[vertex] == NOT_IN_MESHLET)
+                {
+                    local[vertex] = meshlet.vertex_count++;
+                    meshlet_data.vertices.push_back(vertex);
+                }
+
+                meshlet_data.triangles.push_back(static_cast<std::uint8_t>(local[vertex]));
+            }
+
+            meshlet.triangle_count++;
+        }
+
+        flush();
+        return meshlet_data;
+    }
+
+    MeshletPackedLayout GetMeshletPackedLayout(const MeshletData& meshlet_data) noexcept
+    {
+        auto align = [](std::size_t offset)
+        {
+            return (offset + 15) & ~std::size_t(15);
+        };
+
+        MeshletPackedLayout layout;
+        layout.meshlets_offset = 0;
+        layout.bounds_offset =
+            align(layout.meshlets_offset + meshlet_data.meshlets.size() * sizeof(Meshlet));
+        layout.vertices_offset =
+            align(layout.bounds_offset + meshlet_data.bounds.size() * sizeof(MeshletBounds));
+        layout.triangles_offset = align(layout.vertices_offset +
+                                        meshlet_data.vertices.size() * sizeof(std::uint32_t));
+        layout.size = align(layout.triangles_offset + meshlet_data.triangles.size());
+        return layout;
+    }
+
+    bool PackMeshlets(const MeshletData& meshlet_data, std::span<std::byte> out) noexcept
+    {
+        auto layout = GetMeshletPackedLayout(meshlet_data);
+        if(out.size() < layout.size)
+            return false;
+
+        auto copy = [&](std::size_t offset, std::span<const std::byte> bytes)
+        {
+            std::ranges::copy(bytes, out.begin() + offset);
+        };
+
+        std::ranges::fill(out.first(layout.size), std::byte{0});
+        copy(layout.meshlets_offset, std::as_bytes(std::span(meshlet_data.meshlets)));
+        copy(layout.bounds_offset, std::as_bytes(std::span(meshlet_data.bounds)));
+        copy(layout.vertices_offset, std::as_bytes(std::span(meshlet_data.vertices)));
+        copy(layout.triangles_offset, std::as_bytes(std::span(meshlet_data.triangles)));
+        return true;
+    }
+};
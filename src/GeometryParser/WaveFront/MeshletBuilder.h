@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ObjData.h"
+#include <array>
+#include <span>
+#include <vector>
+
+namespace GeometryParser
+{
+    constexpr inline std::size_t MESHLET_MAX_VERTICES = 64;
+    constexpr inline std::size_t MESHLET_MAX_TRIANGLES = 124;
+
+    //all structures below have std430 layout and can be uploaded as is
+    struct Meshlet
+    {
+        std::uint32_t vertex_offset; //in MeshletData::vertices
+        std::uint32_t triangle_offset; //in MeshletData::triangles, a multiple of 4
+        std::uint32_t vertex_count;
+        std::uint32_t triangle_count;
+    };
+
+    //The cluster is backfacing and can be culled if
+    //dot(normalize(cone_apex - camera_position), cone_axis) >= cone_cutoff.
+    //cone_cutoff is 1 if the triangles face too different directions for that.
+    //Triangles are counter-clockwise like in Wavefront files.
+    struct MeshletBounds
+    {
+        std::array<float, 3> center;
+        float radius;
+        std::array<float, 3> cone_axis;
+        float cone_cutoff;
+        std::array<float, 3> cone_apex;
+        float padding;
+    };
+
+    struct MeshletData
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<MeshletBounds> bounds; //by meshlet
+        std::vector<std::uint32_t> vertices; //unique face ids
+        std::vector<std::uint8_t> triangles; //3 local vertex indices per triangle
+    };
+
+    //byte offsets of MeshletData arrays packed into one buffer, each aligned to 16
+    struct MeshletPackedLayout
+    {
+        std::size_t meshlets_offset;
+        std::size_t bounds_offset;
+        std::size_t vertices_offset;
+        std::size_t triangles_offset;
+        std::size_t size;
+    };
+
+    //Splits triangles into clusters of at most max_vertices vertices and max_triangles triangles.
+    //Every cluster grows by the adjacent triangle that adds the fewest new vertices,
+    //so run OptimizeVertexCache before for better locality of the order.
+    //indices are unique face ids of obj_data, e.g. from Triangulator::TriangulateAll.
+    MeshletData BuildMeshlets(const ObjData& obj_data,
+                              std::span<const std::uint32_t> indices,
+                              std::size_t max_vertices = MESHLET_MAX_VERTICES,
+                              std::size_t max_triangles = MESHLET_MAX_TRIANGLES);
+
+    MeshletPackedLayout GetMeshletPackedLayout(const MeshletData& meshlet_data) noexcept;
+    //returns false if out is smaller than MeshletPackedLayout::size
+    bool PackMeshlets(const MeshletData& meshlet_data, std::span<std::byte> out) noexcept;
+};
@@ -1,7 +1,17 @@
 #include "NormalProcessing.h"
+#include "hrs/parallel_for.hpp"
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <utility>
 
+#if defined(__AVX__)
+#    include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    define GEOMETRY_PARSER_NORMALS_SSE
+#    include <xmmintrin.h>
+#endif
+
 namespace GeometryParser
 {
     std::array<float, 3> CalculateNormal(const ObjData& obj_data,
@@ -89,4 +99,361 @@ namespace GeometryParser
         return normal;
     }
 
+    constexpr static std::size_t NORMAL_BATCH_SIZE = 8;
+
+    //structure of arrays, so one vector instruction processes several faces
+    struct normal_batch
+    {
+        alignas(32) float edge1[3][NORMAL_BATCH_SIZE];
+        alignas(32) float edge2[3][NORMAL_BATCH_SIZE];
+        alignas(32) float normal[3][NORMAL_BATCH_SIZE];
+    };
+
+    //normal += edge1 x edge2 in every lane
+    static void accumulate_cross_batch(normal_batch& batch) noexcept
+    {
+        const auto& [x1, y1, z1] = batch.edge1;
+        const auto& [x2, y2, z2] = batch.edge2;
+        auto& [nx, ny, nz] = batch.normal;
+#if defined(__AVX__)
+        __m256 ax = _mm256_load_ps(x1), ay = _mm256_load_ps(y1), az = _mm256_load_ps(z1);
+        __m256 bx = _mm256_load_ps(x2), by = _mm256_load_ps(y2), bz = _mm256_load_ps(z2);
+        __m256 cx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+        __m256 cy = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+        __m256 cz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+        _mm256_store_ps(nx, _mm256_add_ps(_mm256_load_ps(nx), cx));
+        _mm256_store_ps(ny, _mm256_add_ps(_mm256_load_ps(ny), cy));
+        _mm256_store_ps(nz, _mm256_add_ps(_mm256_load_ps(nz), cz));
+#elif defined(GEOMETRY_PARSER_NORMALS_SSE)
+        for(std::size_t i = 0; i < NORMAL_BATCH_SIZE; i += 4)
+        {
+            __m128 ax = _mm_load_ps(x1 + i), ay = _mm_load_ps(y1 + i), az = _mm_load_ps(z1 + i);
+            __m128 bx = _mm_load_ps(x2 + i), by = _mm_load_ps(y2 + i), bz = _mm_load_ps(z2 + i);
+            __m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+            __m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+            __m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+            _mm_store_ps(nx + i, _mm_add_ps(_mm_load_ps(nx + i), cx));
+            _mm_store_ps(ny + i, _mm_add_ps(_mm_load_ps(ny + i), cy));
+            _mm_store_ps(nz + i, _mm_add_ps(_mm_load_ps(nz + i), cz));
+        }
+#else
+        for(std::size_t i = 0; i < NORMAL_BATCH_SIZE; i++)
+        {
+            nx[i] += y1[i] * z2[i] - z1[i] * y2[i];
+            ny[i] += z1[i] * x2[i] - x1[i] * z2[i];
+            nz[i] += x1[i] * y2[i] - y1[i] * x2[i];
+        }
+#endif
+    }
+
+    static bool normalize(float* normal) noexcept
+    {
+        float len =
+            std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if(len == 0)
+            return false;
+
+        for(int i = 0; i < 3; i++)
+            normal[i] /= len;
+
+        return true;
+    }
+
+    //CalculateNormal picks cross(v20, v10) or cross(v10, v20), the batch always calculates
+    //the latter and flips it
+    static float orientation_sign(NormalCalculationType type,
+                                  NormalCalculationSystemType system) noexcept
+    {
+        return ((system == NormalCalculationSystemType::LeftHanded) ==
+                        (type == NormalCalculationType::CounterClockWise)
+                    ? 1.0f
+                    : -1.0f);
+    }
+
+    static std::size_t normal_face_index_offset(FaceType type) noexcept
+    {
+        return (type == FaceType::VertexNormal ? 1 : 2);
+    }
+
+    static bool normals_calculable(const ObjData& obj_data, NormalCalculationType type) noexcept
+    {
+        const auto& schema = obj_data.GetSchema();
+        if(obj_data.GetFaceIndices().empty() || schema.face_count == 0)
+            return false;
+
+        if(type == NormalCalculationType::VertexCommon)
+            return schema.face_type == FaceType::VertexNormal ||
+                   schema.face_type == FaceType::VertexTextureCoordinatesNormal;
+
+        return schema.face_count >= 3;
+    }
+
+    static std::size_t normal_face_count(const ObjData& obj_data) noexcept
+    {
+        const auto& schema = obj_data.GetSchema();
+        return obj_data.GetFaceIndices().size() / FaceTypeToCount(schema.face_type) /
+               schema.face_count;
+    }
+
+    static std::size_t normal_thread_count(std::size_t face_count,
+                                           std::size_t thread_count) noexcept
+    {
+        if(thread_count == 0)
+            thread_count = hrs::hardware_thread_count();
+
+        return std::clamp<std::size_t>(face_count / PARALLEL_NORMALS_MIN_FACES, 1, thread_count);
+    }
+
+    //unnormalized, so the length is twice the area of the face
+    static void calculate_geometric_face_normals(const ObjData& obj_data,
+                                                 float sign,
+                                                 std::size_t first_face,
+                                                 std::size_t last_face,
+                                                 float* face_normals) noexcept
+    {
+        const auto& schema = obj_data.GetSchema();
+        const std::uint32_t* face_indices = obj_data.GetFaceIndices().data();
+        const float* vertices = obj_data.GetVertices().data();
+        std::size_t stride = FaceTypeToCount(schema.face_type);
+        std::size_t face_count = schema.face_count;
+        auto vertex = [&](std::size_t corner)
+        {
+            return vertices + (face_indices[corner * stride] - 1) * schema.vertex_components;
+        };
+
+        normal_batch batch = {};
+        for(std::size_t face = first_face; face < last_face; face += NORMAL_BATCH_SIZE)
+        {
+            std::size_t lanes = std::min(NORMAL_BATCH_SIZE, last_face - face);
+            //unused lanes of the last batch are zero, so they don't produce garbage
+            if(lanes != NORMAL_BATCH_SIZE)
+                batch = {};
+            else
+                std::fill_n(&batch.normal[0][0], 3 * NORMAL_BATCH_SIZE, 0.0f);
+
+            for(std::size_t k = 1; k + 1 < face_count; k++)
+            {
+                for(std::size_t lane = 0; lane < lanes; lane++)
+                {
+                    std::size_t first_corner = (face + lane) * face_count;
+                    const float* v0 = vertex(first_corner);
+                    const float* v1 = vertex(first_corner + k);
+                    const float* v2 = vertex(first_corner + k + 1);
+                    for(int i = 0; i < 3; i++)
+                    {
+                        batch.edge1[i][lane] = v1[i] - v0[i];
+                        batch.edge2[i][lane] = v2[i] - v0[i];
+                    }
+                }
+
+                accumulate_cross_batch(batch);
+            }
+
+            for(std::size_t lane = 0; lane < lanes; lane++)
+                for(int i = 0; i < 3; i++)
+                    face_normals[(face + lane) * 3 + i] = sign * batch.normal[i][lane];
+        }
+    }
+
+    //unnormalized sums of face corner normals
+    static void calculate_common_face_normals(const ObjData& obj_data,
+                                              std::size_t first_face,
+                                              std::size_t last_face,
+                                              float* face_normals) noexcept
+    {
+        const auto& schema = obj_data.GetSchema();
+        const std::uint32_t* face_indices = obj_data.GetFaceIndices().data();
+        std::size_t stride = FaceTypeToCount(schema.face_type);
+        std::size_t offset = normal_face_index_offset(schema.face_type);
+        for(std::size_t face = first_face; face < last_face; face++)
+        {
+            float* out = face_normals + face * 3;
+            out[0] = out[1] = out[2] = 0;
+            for(std::size_t corner = face * schema.face_count;
+                corner < (face + 1) * schema.face_count;
+                corner++)
+            {
+                const float* normal =
+                    obj_data.GetNormalByIndex(face_indices[corner * stride + offset] - 1);
+                for(int i = 0; i < 3; i++)
+                    out[i] += normal[i];
+            }
+        }
+    }
+
+    static void accumulate_vertex_normals(const ObjData& obj_data,
+                                          NormalCalculationType type,
+                                          NormalWeightType weight,
+                                          const float* face_normals,
+                                          std::size_t first_face,
+                                          std::size_t last_face,
+                                          float* vertex_normals) noexcept
+    {
+        const auto& schema = obj_data.GetSchema();
+        const std::uint32_t* face_indices = obj_data.GetFaceIndices().data();
+        std::size_t stride = FaceTypeToCount(schema.face_type);
+        std::size_t face_count = schema.face_count;
+        auto add = [vertex_normals](std::size_t vertex_index, const float* normal, float scale)
+        {
+            for(int i = 0; i < 3; i++)
+                vertex_normals[vertex_index * 3 + i] += normal[i] * scale;
+        };
+
+        for(std::size_t face = first_face; face < last_face; face++)
+        {
+            std::size_t first_corner = face * face_count;
+            if(type == NormalCalculationType::VertexCommon)
+            {
+                std::size_t offset = normal_face_index_offset(schema.face_type);
+                for(std::size_t corner = first_corner; corner < first_corner + face_count; corner++)
+                    add(face_indices[corner * stride] - 1,
+                        obj_data.GetNormalByIndex(face_indices[corner * stride + offset] - 1),
+                        1.0f);
+            }
+            else if(weight == NormalWeightType::Area)
+            {
+                for(std::size_t corner = first_corner; corner < first_corner + face_count; corner++)
+                    add(face_indices[corner * stride] - 1, face_normals + face * 3, 1.0f);
+            }
+            else
+            {
+                float unit[3] = {face_normals[face * 3],
+                                 face_normals[face * 3 + 1],
+                                 face_normals[face * 3 + 2]};
+                if(!normalize(unit))
+                    continue;
+
+                for(std::size_t i = 0; i < face_count; i++)
+                {
+                    std::size_t prev_corner = first_corner + (i + face_count - 1) % face_count;
+                    std::size_t next_corner = first_corner + (i + 1) % face_count;
+                    std::size_t current = face_indices[(first_corner + i) * stride] - 1;
+                    std::size_t prev = face_indices[prev_corner * stride] - 1;
+                    std::size_t next = face_indices[next_corner * stride] - 1;
+
+                    const float* v = obj_data.GetVertexByIndex(current);
+                    const float* v_prev = obj_data.GetVertexByIndex(prev);
+                    const float* v_next = obj_data.GetVertexByIndex(next);
+                    float dot = 0, len_prev = 0, len_next = 0;
+                    for(int j = 0; j < 3; j++)
+                    {
+                        float a = v_prev[j] - v[j];
+                        float b = v_next[j] - v[j];
+                        dot += a * b;
+                        len_prev += a * a;
+                        len_next += b * b;
+                    }
+
+                    float len = std::sqrt(len_prev * len_next);
+                    if(len == 0)
+                        continue;
+
+                    add(current, unit, std::acos(std::clamp(dot / len, -1.0f, 1.0f)));
+                }
+            }
+        }
+    }
+
+    std::vector<float> CalculateFaceNormals(const ObjData& obj_data,
+                                            NormalCalculationType type,
+                                            NormalCalculationSystemType system,
+                                            std::size_t thread_count)
+    {
+        if(!normals_calculable(obj_data, type))
+            return {};
+
+        std::size_t face_count = normal_face_count(obj_data);
+        std::vector<float> face_normals(face_count * 3);
+        hrs::parallel_for(face_count,
+                          normal_thread_count(face_count, thread_count),
+                          [&](std::size_t begin, std::size_t end, std::size_t)
+                          {
+                              if(type == NormalCalculationType::VertexCommon)
+                                  calculate_common_face_normals(obj_data,
+                                                                begin,
+                                                                end,
+                                                                face_normals.data());
+                              else
+                                  calculate_geometric_face_normals(obj_data,
+                                                                   orientation_sign(type, system),
+                                                                   begin,
+                                                                   end,
+                                                                   face_normals.data());
+
+                              for(std::size_t face = begin; face < end; face++)
+                                  normalize(face_normals.data() + face * 3);
+                          });
+
+        return face_normals;
+    }
+
+    std::vector<float> CalculateVertexNormals(const ObjData& obj_data,
+                                              NormalCalculationType type,
+                                              NormalCalculationSystemType system,
+                                              NormalWeightType weight,
+                                              std::size_t thread_count)
+    {
+        if(!normals_calculable(obj_data, type))
+            return {};
+
+        std::size_t face_count = normal_face_count(obj_data);
+        std::size_t vertex_count =
+            obj_data.GetVertices().size() / obj_data.GetSchema().vertex_components;
+        thread_count = normal_thread_count(face_count, thread_count);
+
+        std::vector<float> face_normals;
+        if(type != NormalCalculationType::VertexCommon)
+            face_normals.resize(face_count * 3);
+
+        //the first range accumulates into the result, others into their own partial sums
+        std::vector<float> vertex_normals(vertex_count * 3);
+        std::size_t partial_size = vertex_count * 3;
+        auto partial_sums =
+            std::make_unique_for_overwrite<float[]>((thread_count - 1) * partial_size);
+
+        hrs::parallel_for(
+            face_count,
+            thread_count,
+            [&](std::size_t begin, std::size_t end, std::size_t range_index)
+            {
+                float* sums = vertex_normals.data();
+                if(range_index != 0)
+                {
+                    sums = partial_sums.get() + (range_index - 1) * partial_size;
+                    std::fill_n(sums, partial_size, 0.0f);
+                }
+
+                if(type != NormalCalculationType::VertexCommon)
+                    calculate_geometric_face_normals(obj_data,
+                                                     orientation_sign(type, system),
+                                                     begin,
+                                                     end,
+                                                     face_normals.data());
+
+                accumulate_vertex_normals(obj_data,
+                                          type,
+                                          weight,
+                                          face_normals.data(),
+                                          begin,
+                                          end,
+                                          sums);
+            });
+
+        hrs::parallel_for(vertex_count,
+                          thread_count,
+                          [&](std::size_t begin, std::size_t end, std::size_t)
+                          {
+                              for(std::size_t partial = 0; partial < thread_count - 1; partial++)
+                              {
+                                  const float* sums = partial_sums.get() + partial * partial_size;
+                                  for(std::size_t i = begin * 3; i < end * 3; i++)
+                                      vertex_normals[i] += sums[i];
+                              }
+
+                              for(std::size_t vertex = begin; vertex < end; vertex++)
+                                  normalize(vertex_normals.data() + vertex * 3);
+                          });
+
+        return vertex_normals;
+    }
 };
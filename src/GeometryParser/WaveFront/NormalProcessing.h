@@ -2,6 +2,8 @@
 
 #include "ObjData.h"
 #include <array>
+#include <span>
+#include <vector>
 
 namespace GeometryParser
 {
@@ -18,8 +20,36 @@ namespace GeometryParser
         RightHanded
     };
 
+    enum class NormalWeightType
+    {
+        Area, //faces contribute proportionally to their area
+        Angle //faces contribute proportionally to their angle at the vertex
+    };
+
+    //smaller meshes are not worth splitting between threads
+    constexpr inline std::size_t PARALLEL_NORMALS_MIN_FACES = 1 << 14;
+
     std::array<float, 3> CalculateNormal(const ObjData& obj_data,
                                          std::span<const std::size_t> indices,
                                          NormalCalculationType type,
                                          NormalCalculationSystemType system) noexcept;
+
+    //Normalized normal of every face (3 floats per face) in the order of faces.
+    //Polygons are fanned from their first corner, so all their corners contribute.
+    //VertexCommon averages face corner normals like CalculateNormal does.
+    //thread_count == 0 means all hardware threads.
+    std::vector<float> CalculateFaceNormals(const ObjData& obj_data,
+                                            NormalCalculationType type,
+                                            NormalCalculationSystemType system,
+                                            std::size_t thread_count = 0);
+
+    //Smooth normal of every obj vertex (3 floats per v element) accumulated over all faces
+    //that share it. VertexCommon sums face corner normals and ignores the weight.
+    //Every thread accumulates its faces into its own partial sums that are reduced afterwards.
+    //Returns an empty vector if the mesh has no faces or the face type can't provide normals.
+    std::vector<float> CalculateVertexNormals(const ObjData& obj_data,
+                                              NormalCalculationType type,
+                                              NormalCalculationSystemType system,
+                                              NormalWeightType weight,
+                                              std::size_t thread_count = 0);
 };
@@ -0,0 +1,448 @@
+#include "ObjCache.h"
+#include "hrs/hash.hpp"
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace GeometryParser
+{
+    constexpr static char OBJ_CACHE_MAGIC[8] = {'M', 'D', 'E', 'N', 'G', 'O', 'B', 'J'};
+    constexpr static std::uint32_t OBJ_CACHE_ENDIANNESS = 0x01020304;
+
+    enum obj_cache_section : std::size_t
+    {
+        SOURCE_PATH,
+        VERTICES,
+        TEXTURE_COORDINATES,
+        NORMALS,
+        FACE_INDICES,
+        INDICES,
+        UNIQUE_FACES,
+        GROUPS,
+        GROUP_NAMES,
+        SECTION_COUNT
+    };
+
+    struct obj_cache_section_range
+    {
+        std::uint64_t offset;
+        std::uint64_t size; //in bytes
+    };
+
+    struct obj_cache_group_entry
+    {
+        std::uint64_t name_offset;
+        std::uint64_t name_size;
+        std::uint64_t start_index;
+    };
+
+    struct obj_cache_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t endianness;
+        std::uint64_t source_size;
+        std::int64_t source_mtime;
+        std::uint64_t source_hash;
+        std::uint8_t vertex_components;
+        std::uint8_t texture_components;
+        std::uint8_t face_type;
+        std::uint8_t face_count;
+        std::uint32_t reserved;
+        obj_cache_section_range sections[SECTION_COUNT];
+    };
+
+    static_assert(std::is_trivially_copyable_v<obj_cache_header>);
+    static_assert(std::is_trivially_copyable_v<ObjDataFaceKey> && sizeof(ObjDataFaceKey) == 12);
+
+    static std::uint64_t align_section(std::uint64_t offset) noexcept
+    {
+        return (offset + ObjCache::SECTION_ALIGNMENT - 1) & ~(ObjCache::SECTION_ALIGNMENT - 1);
+    }
+
+    //the same file must give the same key regardless of the way it's referenced
+    static std::string source_path_key(const std::filesystem::path& path)
+    {
+        std::error_code code;
+        auto canonical = std::filesystem::weakly_canonical(path, code);
+        auto str = (code ? path : canonical).generic_u8string();
+        return std::string(reinterpret_cast<const char*>(str.data()), str.size());
+    }
+
+    static std::int64_t source_mtime(const std::filesystem::file_time_type& time) noexcept
+    {
+        return static_cast<std::int64_t>(time.time_since_epoch().count());
+    }
+
+    ObjCache::ObjCache() noexcept
+        : schema{}
+    {}
+
+    ObjCache::ObjCache(ObjCache&& cache) noexcept
+        : file(std::move(cache.file)),
+          schema(cache.schema)
+    {}
+
+    ObjCache& ObjCache::operator=(ObjCache&& cache) noexcept
+    {
+        Close();
+
+        file = std::move(cache.file);
+        schema = cache.schema;
+
+        return *this;
+    }
+
+    ObjCacheResult ObjCache::Write(const std::filesystem::path& cache_path,
+                                   const std::filesystem::path& source_path,
+                                   const ObjData& data)
+    {
+        std::error_code code;
+        auto source_size = std::filesystem::file_size(source_path, code);
+        if(code)
+            return ObjCacheResult::BadFile;
+
+        auto source_time = std::filesystem::last_write_time(source_path, code);
+        if(code)
+            return ObjCacheResult::BadFile;
+
+        hrs::mapped_file source;
+        if(!source.open(source_path))
+            return ObjCacheResult::BadFile;
+
+        obj_cache_header header = {};
+        std::memcpy(header.magic, OBJ_CACHE_MAGIC, sizeof(OBJ_CACHE_MAGIC));
+        header.version = VERSION;
+        header.endianness = OBJ_CACHE_ENDIANNESS;
+        header.source_size = source_size;
+        header.source_mtime = source_mtime(source_time);
+        header.source_hash = hrs::hash_bytes(source.get_bytes());
+        header.vertex_components = data.GetSchema().vertex_components;
+        header.texture_components = data.GetSchema().texture_components;
+        header.face_type = static_cast<std::uint8_t>(data.GetSchema().face_type);
+        header.face_count = data.GetSchema().face_count;
+        source.close();
+
+        std::string path_key = source_path_key(source_path);
+        std::vector<obj_cache_group_entry> group_entries;
+        std::string group_names;
+        group_entries.reserve(data.GetGroups().size());
+        for(const auto& group: data.GetGroups())
+        {
+            group_entries.push_back({.name_offset = group_names.size(),
+                                     .name_size = group.name.size(),
+                                     .start_index = group.start_index});
+            group_names.append(group.name);
+        }
+
+        std::span<const std::byte> payloads[SECTION_COUNT] = {
+            std::as_bytes(std::span(path_key)),
+            std::as_bytes(std::span(data.GetVertices())),
+            std::as_bytes(std::span(data.GetTextureCoordinates())),
+            std::as_bytes(std::span(data.GetNormals())),
+            std::as_bytes(std::span(data.GetFaceIndices())),
+            std::as_bytes(std::span(data.GetIndices())),
+            std::as_bytes(std::span(data.GetUniqueFaces())),
+            std::as_bytes(std::span(group_entries)),
+            std::as_bytes(std::span(group_names))};
+
+        std::uint64_t offset = align_section(sizeof(header));
+        for(std::size_t i = 0; i < SECTION_COUNT; i++)
+        {
+            header.sections[i] = {.offset = offset, .size = payloads[i].size()};
+            offset = align_section(offset + payloads[i].size());
+        }
+
+        //written aside and renamed, so a reader never sees a half-written cache
+        auto tmp_path = cache_path;
+        tmp_path += ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+            if(!out.is_open())
+                return ObjCacheResult::BadFile;
+
+            const char zeros[SECTION_ALIGNMENT] = {};
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            std::uint64_t written = sizeof(header);
+            for(std::size_t i = 0; i < SECTION_COUNT; i++)
+            {
+                out.write(zeros, header.sections[i].offset - written);
+                out.write(reinterpret_cast<const char*>(payloads[i].data()), payloads[i].size());
+                written = header.sections[i].offset + payloads[i].size();
+            }
+
+            out.flush();
+            if(!out)
+            {
+                out.close();
+                std::filesystem::remove(tmp_path, code);
+                return ObjCacheResult::BadFile;
+            }
+        }
+
+        std::filesystem::rename(tmp_path, cache_path, code);
+        if(code)
+        {
+            std::filesystem::remove(tmp_path, code);
+            return ObjCacheResult::BadFile;
+        }
+
+        return ObjCacheResult::Success;
+    }
+
+    ObjCacheResult ObjCache::Open(const std::filesystem::path& cache_path,
+                                  const std::filesystem::path& source_path,
+                                  ObjCacheValidation validation)
+    {
+        Close();
+        if(!file.open(cache_path))
+            return ObjCacheResult::BadFile;
+
+        auto fail = [this](ObjCacheResult result)
+        {
+            Close();
+            return result;
+        };
+
+        if(file.size() < sizeof(obj_cache_header))
+            return fail(ObjCacheResult::BadFormat);
+
+        obj_cache_header header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if(std::memcmp(header.magic, OBJ_CACHE_MAGIC, sizeof(OBJ_CACHE_MAGIC)) != 0 ||
+           header.version != VERSION || header.endianness != OBJ_CACHE_ENDIANNESS ||
+           header.face_type > static_cast<std::uint8_t>(FaceType::VertexTextureCoordinatesNormal))
+            return fail(ObjCacheResult::BadFormat);
+
+        constexpr std::size_t ELEMENT_SIZES[SECTION_COUNT] = {sizeof(char),
+                                                              sizeof(float),
+                                                              sizeof(float),
+                                                              sizeof(float),
+                                                              sizeof(std::uint32_t),
+                                                              sizeof(std::uint32_t),
+                                                              sizeof(ObjDataFaceKey),
+                                                              sizeof(obj_cache_group_entry),
+                                                              sizeof(char)};
+
+        for(std::size_t i = 0; i < SECTION_COUNT; i++)
+        {
+            const auto& section = header.sections[i];
+            if(section.offset % SECTION_ALIGNMENT != 0 || section.offset > file.size() ||
+               section.size > file.size() - section.offset || section.size % ELEMENT_SIZES[i] != 0)
+                return fail(ObjCacheResult::BadFormat);
+        }
+
+        std::uint64_t group_names_size = header.sections[GROUP_NAMES].size;
+        for(const auto& entry: get_section<obj_cache_group_entry>(GROUPS))
+            if(entry.name_offset > group_names_size ||
+               entry.name_size > group_names_size - entry.name_offset)
+                return fail(ObjCacheResult::BadFormat);
+
+        schema = {.vertex_components = header.vertex_components,
+                  .texture_components = header.texture_components,
+                  .face_type = static_cast<FaceType>(header.face_type),
+                  .face_count = header.face_count};
+
+        if(validation == ObjCacheValidation::None)
+            return ObjCacheResult::Success;
+
+        auto stored_path = get_section<char>(SOURCE_PATH);
+        if(std::string_view(stored_path.data(), stored_path.size()) != source_path_key(source_path))
+            return fail(ObjCacheResult::Outdated);
+
+        std::error_code code;
+        auto source_size = std::filesystem::file_size(source_path, code);
+        if(code || source_size != header.source_size)
+            return fail(ObjCacheResult::Outdated);
+
+        auto source_time = std::filesystem::last_write_time(source_path, code);
+        if(code || source_mtime(source_time) != header.source_mtime)
+            return fail(ObjCacheResult::Outdated);
+
+        if(!validate_indices())
+            return fail(ObjCacheResult::BadFormat);
+
+        if(validation == ObjCacheValidation::Content)
+        {
+            hrs::mapped_file source;
+            if(!source.open(source_path) ||
+               hrs::hash_bytes(source.get_bytes()) != header.source_hash)
+                return fail(ObjCacheResult::Outdated);
+        }
+
+        return ObjCacheResult::Success;
+    }
+
+    void ObjCache::Close() noexcept
+    {
+        file.close();
+        schema = {};
+    }
+
+    bool ObjCache::IsOpen() const noexcept
+    {
+        return file.is_open();
+    }
+
+    std::span<const float> ObjCache::GetVertices() const noexcept
+    {
+        return get_section<float>(VERTICES);
+    }
+
+    std::span<const float> ObjCache::GetTextureCoordinates() const noexcept
+    {
+        return get_section<float>(TEXTURE_COORDINATES);
+    }
+
+    std::span<const float> ObjCache::GetNormals() const noexcept
+    {
+        return get_section<float>(NORMALS);
+    }
+
+    std::span<const std::uint32_t> ObjCache::GetFaceIndices() const noexcept
+    {
+        return get_section<std::uint32_t>(FACE_INDICES);
+    }
+
+    std::span<const std::uint32_t> ObjCache::GetIndices() const noexcept
+    {
+        return get_section<std::uint32_t>(INDICES);
+    }
+
+    std::span<const ObjDataFaceKey> ObjCache::GetUniqueFaces() const noexcept
+    {
+        return get_section<ObjDataFaceKey>(UNIQUE_FACES);
+    }
+
+    std::size_t ObjCache::GetGroupCount() const noexcept
+    {
+        return get_section<obj_cache_group_entry>(GROUPS).size();
+    }
+
+    ObjCacheGroup ObjCache::GetGroup(std::size_t index) const noexcept
+    {
+        const auto& entry = get_section<obj_cache_group_entry>(GROUPS)[index];
+        auto names = get_section<char>(GROUP_NAMES);
+        return ObjCacheGroup{.name = std::string_view(names.data() + entry.name_offset,
+                                                      entry.name_size),
+                             .start_index = static_cast<std::size_t>(entry.start_index)};
+    }
+
+    const ObjDataSchema& ObjCache::GetSchema() const noexcept
+    {
+        return schema;
+    }
+
+    ObjData ObjCache::ToObjData() const
+    {
+        ObjData data;
+        auto copy = []<typename T>(std::vector<T>& out, std::span<const T> in)
+        {
+            out.assign(in.begin(), in.end());
+        };
+
+        copy(data.vertices, GetVertices());
+        copy(data.texture_coordinates, GetTextureCoordinates());
+        copy(data.normals, GetNormals());
+        copy(data.face_indices, GetFaceIndices());
+        copy(data.indices, GetIndices());
+        copy(data.unique_faces, GetUniqueFaces());
+
+        data.groups.reserve(GetGroupCount());
+        for(std::size_t i = 0; i < GetGroupCount(); i++)
+        {
+            auto group = GetGroup(i);
+            data.groups.push_back({std::string(group.name), group.start_index});
+        }
+
+        data.schema = schema;
+        return data;
+    }
+
+    //index of a component is 1-based and zero if the face type hasn't got it
+    static bool is_valid_face_key(const ObjDataFaceKey& key,
+                                  FaceType face_type,
+                                  std::size_t vertex_count,
+                                  std::size_t texture_coordinates_count,
+                                  std::size_t normal_count) noexcept
+    {
+        bool has_texture_coordinates = (face_type == FaceType::VertexTextureCoordinates ||
+                                        face_type == FaceType::VertexTextureCoordinatesNormal);
+        bool has_normal = (face_type == FaceType::VertexNormal ||
+                           face_type == FaceType::VertexTextureCoordinatesNormal);
+
+        auto is_valid = [](std::uint32_t index, bool present, std::size_t count)
+        {
+            return present ? (index != 0 && index <= count) : index == 0;
+        };
+
+        return is_valid(key.vertex, true, vertex_count) &&
+               is_valid(key.texture_coordinates, has_texture_coordinates, texture_coordinates_count) &&
+               is_valid(key.normal, has_normal, normal_count);
+    }
+
+    bool ObjCache::validate_indices() const noexcept
+    {
+        if(schema.vertex_components == 0 || schema.texture_components == 0)
+            return false;
+
+        auto vertices = GetVertices();
+        auto texture_coordinates = GetTextureCoordinates();
+        auto normals = GetNormals();
+        if(vertices.size() % schema.vertex_components != 0 ||
+           texture_coordinates.size() % schema.texture_components != 0 || normals.size() % 3 != 0)
+            return false;
+
+        std::size_t vertex_count = vertices.size() / schema.vertex_components;
+        std::size_t texture_coordinates_count =
+            texture_coordinates.size() / schema.texture_components;
+        std::size_t normal_count = normals.size() / 3;
+
+        auto face_indices = GetFaceIndices();
+        auto indices = GetIndices();
+        auto unique_faces = GetUniqueFaces();
+        std::size_t corner_size = FaceTypeToCount(schema.face_type);
+        if(face_indices.size() % corner_size != 0 || indices.size() != face_indices.size() / corner_size)
+            return false;
+
+        return DispatchFaceType(
+            schema.face_type,
+            [&]<FaceType Type>(std::integral_constant<FaceType, Type>)
+            {
+                using Traits = ObjDataFaceTraits<Type>;
+                for(std::size_t i = 0; i < indices.size(); i++)
+                    if(indices[i] >= unique_faces.size() ||
+                       !is_valid_face_key(Traits::MakeKey(face_indices.data() + i * Traits::COUNT),
+                                          Type,
+                                          vertex_count,
+                                          texture_coordinates_count,
+                                          normal_count))
+                        return false;
+
+                for(const auto& key: unique_faces)
+                    if(!is_valid_face_key(key,
+                                          Type,
+                                          vertex_count,
+                                          texture_coordinates_count,
+                                          normal_count))
+                        return false;
+
+                for(std::size_t i = 0; i < GetGroupCount(); i++)
+                    if(GetGroup(i).start_index > indices.size())
+                        return false;
+
+                return true;
+            });
+    }
+
+    template<typename T>
+    std::span<const T> ObjCache::get_section(std::size_t section) const noexcept
+    {
+        if(!file.is_open() || file.size() < sizeof(obj_cache_header))
+            return {};
+
+        const auto* header = reinterpret_cast<const obj_cache_header*>(file.data());
+        const auto& range = header->sections[section];
+        return {reinterpret_cast<const T*>(file.data() + range.offset), range.size / sizeof(T)};
+    }
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ObjData.h"
+#include "hrs/mapped_file.hpp"
+#include "hrs/non_creatable.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace GeometryParser
+{
+    enum class ObjCacheResult
+    {
+        Success,
+        BadFile,
+        BadFormat, //not a cache file, other version or endianness, broken sections
+        Outdated //source file has been changed since the cache was written
+    };
+
+    enum class ObjCacheValidation
+    {
+        None, //trust the cache, only the header and section bounds are checked
+        Metadata, //source path, size, modification time and indices
+        Content //metadata and hash of the source file contents
+    };
+
+    struct ObjCacheGroup
+    {
+        std::string_view name;
+        std::size_t start_index;
+    };
+
+    //Binary snapshot of a linked ObjData.
+    //Sections are aligned to SECTION_ALIGNMENT, so the loaded cache exposes them straight
+    //from the mapped file without copies. The format uses the native endianness.
+    class ObjCache : public hrs::non_copyable
+    {
+    public:
+        constexpr static std::uint32_t VERSION = 1;
+        constexpr static std::size_t SECTION_ALIGNMENT = 64;
+
+        ObjCache() noexcept;
+        ~ObjCache() = default;
+        ObjCache(ObjCache&& cache) noexcept;
+        ObjCache& operator=(ObjCache&& cache) noexcept;
+
+        //data should be linked from source_path and have constructed unique faces
+        static ObjCacheResult Write(const std::filesystem::path& cache_path,
+                                    const std::filesystem::path& source_path,
+                                    const ObjData& data);
+
+        //with Metadata and Content validation indices are checked against the attribute
+        //sections, so a corrupt cache is reported as BadFormat instead of being read out of
+        //bounds, None costs O(sections) and leaves indices of a corrupt cache unchecked
+        ObjCacheResult Open(const std::filesystem::path& cache_path,
+                            const std::filesystem::path& source_path,
+                            ObjCacheValidation validation);
+
+        void Close() noexcept;
+        bool IsOpen() const noexcept;
+
+        std::span<const float> GetVertices() const noexcept;
+        std::span<const float> GetTextureCoordinates() const noexcept;
+        std::span<const float> GetNormals() const noexcept;
+        std::span<const std::uint32_t> GetFaceIndices() const noexcept;
+        std::span<const std::uint32_t> GetIndices() const noexcept;
+        std::span<const ObjDataFaceKey> GetUniqueFaces() const noexcept;
+        std::size_t GetGroupCount() const noexcept;
+        ObjCacheGroup GetGroup(std::size_t index) const noexcept;
+        const ObjDataSchema& GetSchema() const noexcept;
+
+        //copies the sections for the consumers that take const ObjData&
+        ObjData ToObjData() const;
+    private:
+        template<typename T>
+        std::span<const T> get_section(std::size_t section) const noexcept;
+
+        bool validate_indices() const noexcept;
+    private:
+        hrs::mapped_file file;
+        ObjDataSchema schema;
+    };
+};
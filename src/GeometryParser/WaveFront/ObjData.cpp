@@ -1,6 +1,8 @@
 #include "ObjData.h"
 #include "ObjParserRange.h"
-#include <map>
+#include "hrs/mapped_file.hpp"
+#include "hrs/parallel_for.hpp"
+#include <algorithm>
 
 namespace GeometryParser
 {
@@ -20,12 +22,12 @@ namespace GeometryParser
     }
 
     Error ObjData::Link(const std::filesystem::path& path,
-                        bool read_all,
+                        ObjParserOpenMode mode,
                         hrs::flags<ObjDataLinkFlags> flags,
                         const ObjDataReplaceValue& replace)
     {
         ObjParserRange rng;
-        auto res = rng.Open(path, read_all);
+        auto res = rng.Open(path, mode);
         if(res != Result::Success)
             return Error{.result = res};
 
@@ -61,11 +63,260 @@ namespace GeometryParser
                         const ObjDataReplaceValue& replace,
                         bool close_range)
     {
+        Clear();
+        Error err = link_range(rng, flags, replace);
+        if(err.result != Result::Success)
+            return err;
+
+        ConstructUniqueFaces(1);
+
+        if(close_range)
+            rng.Close();
+
+        return Error{.result = Result::Success};
+    }
+
+    Error ObjData::LinkParallel(const std::filesystem::path& path,
+                                hrs::flags<ObjDataLinkFlags> flags,
+                                const ObjDataReplaceValue& replace,
+                                std::size_t thread_count)
+    {
+        hrs::mapped_file file;
+        if(!file.open(path))
+            return Error{.result = Result::BadFile};
+
+        return LinkParallel(file.get_string_view(), flags, replace, thread_count);
+    }
+
+    static std::vector<std::string_view> split_into_line_chunks(std::string_view data,
+                                                                std::size_t chunk_count)
+    {
+        std::vector<std::string_view> chunks;
+        chunks.reserve(chunk_count);
+
+        std::size_t begin = 0;
+        for(std::size_t i = 1; i < chunk_count; i++)
+        {
+            std::size_t target = data.size() / chunk_count * i;
+            if(target < begin)
+                continue;
+
+            auto new_line = data.find('\n', target);
+            if(new_line == std::string_view::npos)
+                break;
+
+            chunks.push_back(data.substr(begin, new_line + 1 - begin));
+            begin = new_line + 1;
+        }
+
+        if(begin < data.size())
+            chunks.push_back(data.substr(begin));
+
+        return chunks;
+    }
+
+    //must count exactly the lines ObjParserRange::Next treats as vertices,
+    //texture coordinates and normals
+    static ObjParserElementCount count_chunk_elements(std::string_view chunk) noexcept
+    {
+        ObjParserElementCount count = {};
+        std::size_t offset = 0;
+        while(offset < chunk.size())
+        {
+            auto end = FindChar(chunk, '\n', offset);
+            if(end == std::string_view::npos)
+                end = chunk.size();
+
+            auto line = chunk.substr(offset, end - offset);
+            if(line.starts_with("v "))
+                count.vertices++;
+            else if(line.starts_with("vt "))
+                count.texture_coordinates++;
+            else if(line.starts_with("vn "))
+                count.normals++;
+
+            offset = end + 1;
+        }
+
+        return count;
+    }
+
+    //zero means the chunk has no such elements, any two non-zero values must be equal
+    template<typename T>
+    static bool merge_schema_value(T& merged, T value) noexcept
+    {
+        if(value == T{})
+            return true;
+
+        if(merged == T{})
+            merged = value;
+
+        return merged == value;
+    }
+
+    Error ObjData::LinkParallel(std::string_view data,
+                                hrs::flags<ObjDataLinkFlags> flags,
+                                const ObjDataReplaceValue& replace,
+                                std::size_t thread_count)
+    {
+        auto link_serial = [&]()
+        {
+            ObjParserRange rng;
+            rng.ConsumeView(data);
+            return Link(rng, flags, replace, true);
+        };
+
+        if(thread_count == 0)
+            thread_count = hrs::hardware_thread_count();
+
+        std::size_t chunk_count =
+            std::clamp<std::size_t>(data.size() / PARALLEL_LINK_MIN_CHUNK_SIZE, 1, thread_count);
+        if(chunk_count == 1)
+            return link_serial();
+
+        auto chunks = split_into_line_chunks(data, chunk_count);
+        chunk_count = chunks.size();
+
+        //element counts before every chunk resolve relative face indices to absolute ones
+        std::vector<ObjParserElementCount> bases(chunk_count);
+        hrs::parallel_for(chunk_count,
+                          chunk_count,
+                          [&](std::size_t begin, std::size_t end, std::size_t)
+                          {
+                              for(std::size_t i = begin; i < end; i++)
+                                  bases[i] = count_chunk_elements(chunks[i]);
+                          });
+
+        ObjParserElementCount total = {};
+        for(auto& base: bases)
+        {
+            ObjParserElementCount chunk_elements = base;
+            base = total;
+            total.vertices += chunk_elements.vertices;
+            total.texture_coordinates += chunk_elements.texture_coordinates;
+            total.normals += chunk_elements.normals;
+        }
+
+        std::vector<ObjData> chunk_datas(chunk_count);
+        std::vector<ObjParserSchema> chunk_schemas(chunk_count);
+        std::vector<Result> chunk_results(chunk_count);
+        hrs::parallel_for(chunk_count,
+                          chunk_count,
+                          [&](std::size_t begin, std::size_t end, std::size_t)
+                          {
+                              for(std::size_t i = begin; i < end; i++)
+                              {
+                                  ObjParserRange rng;
+                                  rng.ConsumeView(chunks[i], bases[i]);
+                                  chunk_results[i] =
+                                      chunk_datas[i].link_range(rng, flags, replace).result;
+                                  chunk_schemas[i] = rng.GetSchema();
+                              }
+                          });
+
+        //chunks that disagree with each other are reparsed serially,
+        //so the reported error is exactly the one the serial path gives
+        ObjParserSchema merged_schema = {};
+        for(std::size_t i = 0; i < chunk_count; i++)
+        {
+            if(chunk_results[i] != Result::Success)
+                return link_serial();
+
+            const auto& chunk_schema = chunk_schemas[i];
+            bool has_faces = chunk_schema.face_count != 0;
+            bool merged_has_faces = merged_schema.face_count != 0;
+            if(!merge_schema_value(merged_schema.vertex_components,
+                                   chunk_schema.vertex_components) ||
+               !merge_schema_value(merged_schema.texture_coordinates_components,
+                                   chunk_schema.texture_coordinates_components) ||
+               !merge_schema_value(merged_schema.face_count, chunk_schema.face_count) ||
+               (has_faces && merged_has_faces && merged_schema.face_type != chunk_schema.face_type))
+                return link_serial();
+
+            if(has_faces && !merged_has_faces)
+                merged_schema.face_type = chunk_schema.face_type;
+        }
+
         Clear();
         schema.vertex_components = 3;
         schema.texture_components = 1;
+        schema.face_type = merged_schema.face_type;
+        schema.face_count = merged_schema.face_count;
 
-        std::uint32_t id = 0;
+        struct chunk_offsets
+        {
+            std::size_t vertices;
+            std::size_t texture_coordinates;
+            std::size_t normals;
+            std::size_t face_indices;
+            std::size_t groups;
+        };
+
+        std::vector<chunk_offsets> offsets(chunk_count);
+        chunk_offsets sizes = {};
+        for(std::size_t i = 0; i < chunk_count; i++)
+        {
+            const auto& chunk_data = chunk_datas[i];
+            if(!chunk_data.vertices.empty())
+                schema.vertex_components = chunk_data.schema.vertex_components;
+
+            if(!chunk_data.texture_coordinates.empty())
+                schema.texture_components = chunk_data.schema.texture_components;
+
+            offsets[i] = sizes;
+            sizes.vertices += chunk_data.vertices.size();
+            sizes.texture_coordinates += chunk_data.texture_coordinates.size();
+            sizes.normals += chunk_data.normals.size();
+            sizes.face_indices += chunk_data.face_indices.size();
+            sizes.groups += chunk_data.groups.size();
+        }
+
+        vertices.resize(sizes.vertices);
+        texture_coordinates.resize(sizes.texture_coordinates);
+        normals.resize(sizes.normals);
+        face_indices.resize(sizes.face_indices);
+        groups.resize(sizes.groups);
+
+        std::size_t face_type_count = FaceTypeToCount(schema.face_type);
+        hrs::parallel_for(
+            chunk_count,
+            chunk_count,
+            [&](std::size_t begin, std::size_t end, std::size_t)
+            {
+                for(std::size_t i = begin; i < end; i++)
+                {
+                    auto& chunk_data = chunk_datas[i];
+                    const auto& offset = offsets[i];
+                    std::ranges::copy(chunk_data.vertices, vertices.begin() + offset.vertices);
+                    std::ranges::copy(chunk_data.texture_coordinates,
+                                      texture_coordinates.begin() + offset.texture_coordinates);
+                    std::ranges::copy(chunk_data.normals, normals.begin() + offset.normals);
+                    std::ranges::copy(chunk_data.face_indices,
+                                      face_indices.begin() + offset.face_indices);
+
+                    std::size_t corner_offset = offset.face_indices / face_type_count;
+                    for(std::size_t j = 0; j < chunk_data.groups.size(); j++)
+                    {
+                        auto& group = groups[offset.groups + j];
+                        group.name = std::move(chunk_data.groups[j].name);
+                        group.start_index = chunk_data.groups[j].start_index + corner_offset;
+                    }
+                }
+            });
+
+        ConstructUniqueFaces(thread_count);
+
+        return Error{.result = Result::Success};
+    }
+
+    Error ObjData::link_range(ObjParserRange& rng,
+                              hrs::flags<ObjDataLinkFlags> flags,
+                              const ObjDataReplaceValue& replace)
+    {
+        schema.vertex_components = 3;
+        schema.texture_components = 1;
+
+        std::size_t corner_count = 0;
 
         auto exp = rng.Next();
         for(; exp.has_value(); exp = rng.Next())
@@ -73,152 +324,148 @@ namespace GeometryParser
             const auto& elem = exp.value();
             switch(elem.tag)
             {
-                case Element::VertexXYZ:
-                    for(std::size_t i = 0; i < 3; i++)
-                        vertices.push_back(elem.GetVectorElement().data[i]);
-
-                    if(flags & ObjDataLinkFlags::VertexWReplace)
-                    {
-                        vertices.push_back(replace.vertex_w_replace);
-                        schema.vertex_components = 4;
-                    }
+                case Element::Group:
+                    groups.push_back({elem.GetGroupElement().data, corner_count});
                     break;
-                case Element::VertexXYZW:
+                case Element::FaceV:
+                case Element::FaceVT:
+                case Element::FaceVN:
+                case Element::FaceVTN:
                 {
-                    for(std::size_t i = 0; i < 3; i++)
-                        vertices.push_back(elem.GetVectorElement().data[i]);
+                    if(corner_count == 0)
+                        schema.face_type = rng.GetSchema().face_type;
 
-                    if(!(flags & ObjDataLinkFlags::IgnoreVertexWComponent))
-                    {
-                        vertices.push_back(elem.GetVectorElement().data[3]);
-                        schema.vertex_components = 4;
-                    }
-                    else if(flags & ObjDataLinkFlags::VertexWReplace)
-                    {
-                        vertices.push_back(replace.vertex_w_replace);
-                        schema.vertex_components = 4;
-                    }
+                    //corners are deduplicated afterwards in one pass by ConstructUniqueFaces
+                    const auto& face = elem.GetFaceElement().data.get();
+                    face_indices.insert(face_indices.end(), face.begin(), face.end());
+                    corner_count += face.size() / FaceTypeToCount(schema.face_type);
                 }
                 break;
-                case Element::TextureCoordinatesU:
-                    texture_coordinates.push_back(elem.GetVectorElement().data[0]);
-
-                    if(flags & ObjDataLinkFlags::TextureCoordinatesVReplace)
-                    {
-                        texture_coordinates.push_back(replace.texture_coordinates_v_component);
-                        schema.texture_components = 2;
-
-                        if(flags & ObjDataLinkFlags::TextureCoordinatesWReplace)
-                        {
-                            texture_coordinates.push_back(replace.texture_coordinates_w_component);
-                            schema.texture_components = 3;
-                        }
-                    }
+                default:
+                    link_attribute(elem, flags, replace);
                     break;
-                case Element::TextureCoordinatesUV:
+            }
+        }
+
+        schema.face_count = rng.GetSchema().face_count;
+
+        if(exp.error().result != Result::EndOfFile)
+            return exp.error();
+
+        return Error{.result = Result::Success};
+    }
+
+    void ObjData::link_attribute(const ElementData& elem,
+                                 hrs::flags<ObjDataLinkFlags> flags,
+                                 const ObjDataReplaceValue& replace)
+    {
+        switch(elem.tag)
+        {
+            case Element::VertexXYZ:
+                for(std::size_t i = 0; i < 3; i++)
+                    vertices.push_back(elem.GetVectorElement().data[i]);
+
+                if(flags & ObjDataLinkFlags::VertexWReplace)
                 {
-                    bool has_v = false;
-                    texture_coordinates.push_back(elem.GetVectorElement().data[0]);
-                    if(!(flags & ObjDataLinkFlags::IgnoreTextureCoordinatesVComponent))
-                    {
-                        texture_coordinates.push_back(elem.GetVectorElement().data[1]);
-                        has_v = true;
-                        schema.texture_components = 2;
-                    }
-                    else if(flags & ObjDataLinkFlags::TextureCoordinatesVReplace)
-                    {
-                        texture_coordinates.push_back(replace.texture_coordinates_v_component);
-                        has_v = true;
-                        schema.texture_components = 2;
-                    }
+                    vertices.push_back(replace.vertex_w_replace);
+                    schema.vertex_components = 4;
+                }
+                break;
+            case Element::VertexXYZW:
+            {
+                for(std::size_t i = 0; i < 3; i++)
+                    vertices.push_back(elem.GetVectorElement().data[i]);
 
-                    if(has_v && (flags & ObjDataLinkFlags::TextureCoordinatesWReplace))
+                if(!(flags & ObjDataLinkFlags::IgnoreVertexWComponent))
+                {
+                    vertices.push_back(elem.GetVectorElement().data[3]);
+                    schema.vertex_components = 4;
+                }
+                else if(flags & ObjDataLinkFlags::VertexWReplace)
+                {
+                    vertices.push_back(replace.vertex_w_replace);
+                    schema.vertex_components = 4;
+                }
+            }
+            break;
+            case Element::TextureCoordinatesU:
+                texture_coordinates.push_back(elem.GetVectorElement().data[0]);
+
+                if(flags & ObjDataLinkFlags::TextureCoordinatesVReplace)
+                {
+                    texture_coordinates.push_back(replace.texture_coordinates_v_component);
+                    schema.texture_components = 2;
+
+                    if(flags & ObjDataLinkFlags::TextureCoordinatesWReplace)
                     {
                         texture_coordinates.push_back(replace.texture_coordinates_w_component);
                         schema.texture_components = 3;
                     }
                 }
                 break;
-                case Element::TextureCoordinatesUVW:
+            case Element::TextureCoordinatesUV:
+            {
+                bool has_v = false;
+                texture_coordinates.push_back(elem.GetVectorElement().data[0]);
+                if(!(flags & ObjDataLinkFlags::IgnoreTextureCoordinatesVComponent))
                 {
-                    bool has_v = false;
-                    texture_coordinates.push_back(elem.GetVectorElement().data[0]);
-                    if(!(flags & ObjDataLinkFlags::IgnoreTextureCoordinatesVComponent))
-                    {
-                        texture_coordinates.push_back(elem.GetVectorElement().data[1]);
-                        has_v = true;
-                        schema.texture_components = 2;
-                    }
-                    else if(flags & ObjDataLinkFlags::TextureCoordinatesVReplace)
-                    {
-                        texture_coordinates.push_back(replace.texture_coordinates_v_component);
-                        has_v = true;
-                        schema.texture_components = 2;
-                    }
+                    texture_coordinates.push_back(elem.GetVectorElement().data[1]);
+                    has_v = true;
+                    schema.texture_components = 2;
+                }
+                else if(flags & ObjDataLinkFlags::TextureCoordinatesVReplace)
+                {
+                    texture_coordinates.push_back(replace.texture_coordinates_v_component);
+                    has_v = true;
+                    schema.texture_components = 2;
+                }
 
-                    if(has_v)
-                    {
-                        if(!(flags & ObjDataLinkFlags::IgnoreTextureCoordinatesWComponent))
-                        {
-                            texture_coordinates.push_back(elem.GetVectorElement().data[2]);
-                            schema.texture_components = 3;
-                        }
-                        else if(flags & ObjDataLinkFlags::TextureCoordinatesWReplace)
-                        {
-                            texture_coordinates.push_back(replace.texture_coordinates_w_component);
-                            schema.texture_components = 3;
-                        }
-                    }
+                if(has_v && (flags & ObjDataLinkFlags::TextureCoordinatesWReplace))
+                {
+                    texture_coordinates.push_back(replace.texture_coordinates_w_component);
+                    schema.texture_components = 3;
                 }
-                break;
-                case Element::Normal:
-                    for(std::size_t i = 0; i < 3; i++)
-                        normals.push_back(elem.GetVectorElement().data[i]);
-                    break;
-                case Element::Group:
-                    groups.push_back({elem.GetGroupElement().data, indices.size()});
-                    break;
-                case Element::FaceV:
-                case Element::FaceVT:
-                case Element::FaceVN:
-                case Element::FaceVTN:
+            }
+            break;
+            case Element::TextureCoordinatesUVW:
+            {
+                bool has_v = false;
+                texture_coordinates.push_back(elem.GetVectorElement().data[0]);
+                if(!(flags & ObjDataLinkFlags::IgnoreTextureCoordinatesVComponent))
+                {
+                    texture_coordinates.push_back(elem.GetVectorElement().data[1]);
+                    has_v = true;
+                    schema.texture_components = 2;
+                }
+                else if(flags & ObjDataLinkFlags::TextureCoordinatesVReplace)
                 {
-                    if(unique_faces.empty())
+                    texture_coordinates.push_back(replace.texture_coordinates_v_component);
+                    has_v = true;
+                    schema.texture_components = 2;
+                }
+
+                if(has_v)
+                {
+                    if(!(flags & ObjDataLinkFlags::IgnoreTextureCoordinatesWComponent))
                     {
-                        schema.face_type = rng.GetSchema().face_type;
-                        unique_faces =
-                            UniqueIndexMap(ObjDataFaceComparator(face_indices, schema.face_type));
+                        texture_coordinates.push_back(elem.GetVectorElement().data[2]);
+                        schema.texture_components = 3;
                     }
-
-                    std::size_t i = 0;
-                    while(i != elem.GetFaceElement().data.get().size())
+                    else if(flags & ObjDataLinkFlags::TextureCoordinatesWReplace)
                     {
-                        std::size_t index = face_indices.size();
-                        for(int j = 0; j < FaceTypeToCount(schema.face_type); j++)
-                            face_indices.push_back(elem.GetFaceElement().data.get().data()[i + j]);
-
-                        auto it = unique_faces.insert({index, 0});
-                        if(it.second) //inserted -> add vertex data
-                            it.first->second = id++;
-
-                        indices.push_back(it.first->second);
-
-                        i += FaceTypeToCount(schema.face_type);
+                        texture_coordinates.push_back(replace.texture_coordinates_w_component);
+                        schema.texture_components = 3;
                     }
                 }
-                break;
             }
+            break;
+            case Element::Normal:
+                for(std::size_t i = 0; i < 3; i++)
+                    normals.push_back(elem.GetVectorElement().data[i]);
+                break;
+            default:
+                break;
         }
-
-        schema.face_count = rng.GetSchema().face_count;
-
-        if(exp.error().result != Result::EndOfFile)
-            return exp.error();
-
-        if(close_range)
-            rng.Close();
-
-        return Error{.result = Result::Success};
     }
 
     void ObjData::Clear() noexcept
@@ -238,21 +485,154 @@ namespace GeometryParser
         unique_faces = {};
     }
 
-    void ObjData::ConstructUniqueFaces() noexcept
+    void ObjData::ConstructUniqueFaces(std::size_t thread_count)
     {
+        ClearUniqueFaces();
+        indices.clear();
         if(face_indices.empty())
             return;
 
-        ClearUniqueFaces();
-        unique_faces = UniqueIndexMap(ObjDataFaceComparator(face_indices, schema.face_type));
+        if(thread_count == 0)
+            thread_count = hrs::hardware_thread_count();
+
+        //every vertex is usually referenced at least once, so it's a good lower bound
+        std::size_t expected_count = vertices.size() / schema.vertex_components;
+        expected_count = std::max(expected_count,
+                                  texture_coordinates.size() / schema.texture_components);
+        expected_count = std::max(expected_count, normals.size() / 3);
+
+        DispatchFaceType(schema.face_type,
+                         [&]<FaceType Type>(std::integral_constant<FaceType, Type>)
+                         {
+                             std::size_t corner_count =
+                                 face_indices.size() / ObjDataFaceTraits<Type>::COUNT;
+                             if(thread_count == 1 || corner_count < PARALLEL_UNIQUE_MIN_CORNERS)
+                                 construct_unique_faces<Type>(expected_count);
+                             else
+                                 construct_unique_faces_parallel<Type>(expected_count,
+                                                                       thread_count);
+                         });
+    }
+
+    template<FaceType Type>
+    void ObjData::construct_unique_faces(std::size_t expected_count)
+    {
+        using Traits = ObjDataFaceTraits<Type>;
+
+        std::size_t corner_count = face_indices.size() / Traits::COUNT;
+        indices.resize(corner_count);
+        unique_faces.reserve(expected_count);
+
+        ObjDataFaceTable<Type> table(expected_count);
+        for(std::size_t i = 0; i < corner_count; i++)
+        {
+            auto key = Traits::MakeKey(face_indices.data() + i * Traits::COUNT);
+            auto [id, inserted] =
+                table.Emplace(key, static_cast<std::uint32_t>(unique_faces.size()));
+            if(inserted)
+                unique_faces.push_back(key);
+
+            indices[i] = id;
+        }
+    }
+
+    //Corners are hashed once and bucketed by hash into one partition per thread,
+    //every thread then deduplicates its own bucket and remembers the first corner of each key.
+    //Buckets keep corner order, so ids handed out to first corners in corner order
+    //give exactly the serial numbering.
+    template<FaceType Type>
+    void ObjData::construct_unique_faces_parallel(std::size_t expected_count,
+                                                  std::size_t thread_count)
+    {
+        using Traits = ObjDataFaceTraits<Type>;
 
-        std::uint32_t id = 0;
-        for(std::size_t i = 0; i < face_indices.size(); i += FaceTypeToCount(schema.face_type))
+        std::size_t corner_count = face_indices.size() / Traits::COUNT;
+        std::size_t partition_count = std::min(thread_count, corner_count);
+        //low half picks the partition, the table itself indexes by the high bits
+        auto partition_of = [partition_count](std::uint64_t hash) noexcept -> std::size_t
         {
-            auto it = unique_faces.insert({i, 0});
-            if(it.second) //inserted -> add vertex data
-                it.first->second = id++;
+            return ((hash & 0xFFFF'FFFF) * partition_count) >> 32;
+        };
+
+        std::vector<std::uint64_t> hashes(corner_count);
+        //counts of every (range, partition) pair, range-major
+        std::vector<std::size_t> bucket_offsets(partition_count * partition_count);
+        hrs::parallel_for(corner_count,
+                          partition_count,
+                          [&](std::size_t begin, std::size_t end, std::size_t range)
+                          {
+                              std::size_t* counts = bucket_offsets.data() + range * partition_count;
+                              for(std::size_t i = begin; i < end; i++)
+                              {
+                                  hashes[i] = Traits::Hash(
+                                      Traits::MakeKey(face_indices.data() + i * Traits::COUNT));
+                                  counts[partition_of(hashes[i])]++;
+                              }
+                          });
+
+        //a bucket holds the corners of its partition from all ranges in range order
+        std::vector<std::size_t> bucket_begins(partition_count + 1);
+        std::size_t offset = 0;
+        for(std::size_t partition = 0; partition < partition_count; partition++)
+        {
+            bucket_begins[partition] = offset;
+            for(std::size_t range = 0; range < partition_count; range++)
+                offset += std::exchange(bucket_offsets[range * partition_count + partition], offset);
         }
+        bucket_begins[partition_count] = offset;
+
+        std::vector<std::uint32_t> buckets(corner_count);
+        hrs::parallel_for(corner_count,
+                          partition_count,
+                          [&](std::size_t begin, std::size_t end, std::size_t range)
+                          {
+                              std::size_t* offsets = bucket_offsets.data() + range * partition_count;
+                              for(std::size_t i = begin; i < end; i++)
+                                  buckets[offsets[partition_of(hashes[i])]++] =
+                                      static_cast<std::uint32_t>(i);
+                          });
+
+        std::vector<std::uint32_t> first_corners(corner_count);
+        std::vector<std::uint8_t> is_first(corner_count);
+        hrs::parallel_for(
+            partition_count,
+            partition_count,
+            [&](std::size_t begin, std::size_t end, std::size_t)
+            {
+                for(std::size_t partition = begin; partition < end; partition++)
+                {
+                    ObjDataFaceTable<Type> table(expected_count / partition_count);
+                    for(std::size_t j = bucket_begins[partition]; j < bucket_begins[partition + 1];
+                        j++)
+                    {
+                        std::uint32_t i = buckets[j];
+                        auto key = Traits::MakeKey(face_indices.data() + i * Traits::COUNT);
+                        auto [first_corner, inserted] = table.Emplace(key, i, hashes[i]);
+                        is_first[i] = inserted;
+                        first_corners[i] = first_corner;
+                    }
+                }
+            });
+
+        indices.resize(corner_count);
+        unique_faces.reserve(expected_count);
+        for(std::size_t i = 0; i < corner_count; i++)
+        {
+            if(!is_first[i])
+                continue;
+
+            indices[i] = static_cast<std::uint32_t>(unique_faces.size());
+            unique_faces.push_back(Traits::MakeKey(face_indices.data() + i * Traits::COUNT));
+        }
+
+        hrs::parallel_for(corner_count,
+                          thread_count,
+                          [&](std::size_t begin, std::size_t end, std::size_t)
+                          {
+                              for(std::size_t i = begin; i < end; i++)
+                                  if(!is_first[i])
+                                      indices[i] = indices[first_corners[i]];
+                          });
     }
 
     const std::vector<float>& ObjData::GetVertices() const noexcept
@@ -290,7 +670,7 @@ namespace GeometryParser
         return schema;
     }
 
-    const ObjData::UniqueIndexMap& ObjData::GetUniqueFaceIndices() const noexcept
+    const std::vector<ObjDataFaceKey>& ObjData::GetUniqueFaces() const noexcept
     {
         return unique_faces;
     }
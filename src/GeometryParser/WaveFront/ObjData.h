@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ObjDataFaceTable.h"
 #include "ObjSchema.h"
 #include "hrs/expected.hpp"
 #include "hrs/flags.hpp"
@@ -7,12 +8,15 @@
 #include <cstdint>
 #include <filesystem>
 #include <functional>
-#include <map>
+#include <string_view>
 #include <vector>
 
 namespace GeometryParser
 {
     class ObjParserRange;
+    struct ObjStreamLinkSettings;
+    struct ObjStreamTarget;
+    struct ObjStreamLinkResult;
 
     enum class ObjDataLinkFlags
     {
@@ -31,88 +35,6 @@ namespace GeometryParser
         float texture_coordinates_w_component;
     };
 
-    struct ObjDataFaceComparator
-    {
-        using ComparatorType = bool (ObjDataFaceComparator::*)(std::size_t,
-                                                               std::size_t) const noexcept;
-
-        const std::vector<std::uint32_t>* face_indices;
-        ComparatorType comparator;
-
-        ObjDataFaceComparator() = default;
-
-        constexpr ObjDataFaceComparator(const std::vector<std::uint32_t>& _face_indices,
-                                        FaceType type) noexcept
-            : face_indices(&_face_indices),
-              comparator(SelectComparator(type))
-        {}
-
-        constexpr bool operator()(std::size_t ind1, std::size_t ind2) const noexcept
-        {
-            return (this->*comparator)(ind1, ind2);
-        }
-
-        constexpr bool ComparatorV(std::size_t ind1, std::size_t ind2) const noexcept
-        {
-            return (*face_indices)[ind1] < (*face_indices)[ind2];
-        }
-
-        constexpr bool ComparatorVT(std::size_t ind1, std::size_t ind2) const noexcept
-        {
-            bool cmp = (*face_indices)[ind1] == (*face_indices)[ind2];
-            if(cmp)
-                return (*face_indices)[ind1 + 1] < (*face_indices)[ind2 + 1];
-
-            return (*face_indices)[ind1] < (*face_indices)[ind2];
-        }
-
-        constexpr bool ComparatorVN(std::size_t ind1, std::size_t ind2) const noexcept
-        {
-            bool cmp = (*face_indices)[ind1] == (*face_indices)[ind2];
-            if(cmp)
-                return (*face_indices)[ind1 + 1] < (*face_indices)[ind2 + 1];
-
-            return (*face_indices)[ind1] < (*face_indices)[ind2];
-        }
-
-        constexpr bool ComparatorVTN(std::size_t ind1, std::size_t ind2) const noexcept
-        {
-            bool cmp_v = (*face_indices)[ind1] == (*face_indices)[ind2];
-            if(cmp_v)
-            {
-                bool cmp_t = (*face_indices)[ind1 + 1] == (*face_indices)[ind2 + 1];
-                if(cmp_t)
-                    return (*face_indices)[ind1 + 2] < (*face_indices)[ind2 + 2];
-
-                return (*face_indices)[ind1 + 1] < (*face_indices)[ind2 + 1];
-            }
-
-            return (*face_indices)[ind1] < (*face_indices)[ind2];
-        }
-
-        constexpr static ComparatorType SelectComparator(FaceType type) noexcept
-        {
-            switch(type)
-            {
-                case FaceType::Vertex:
-                    return &ObjDataFaceComparator::ComparatorV;
-                    break;
-                case FaceType::VertexTextureCoordinates:
-                    return &ObjDataFaceComparator::ComparatorVT;
-                    break;
-                case FaceType::VertexNormal:
-                    return &ObjDataFaceComparator::ComparatorVN;
-                    break;
-                case FaceType::VertexTextureCoordinatesNormal:
-                    return &ObjDataFaceComparator::ComparatorVTN;
-                    break;
-                default:
-                    assert(false);
-                    break;
-            }
-        }
-    };
-
     struct ObjDataGroup
     {
         std::string name;
@@ -127,10 +49,16 @@ namespace GeometryParser
         std::uint8_t face_count;
     };
 
+    class ObjCache;
+
     class ObjData
     {
     public:
-        using UniqueIndexMap = std::map<std::size_t, std::uint32_t, ObjDataFaceComparator>;
+        friend class ObjCache;
+
+        //smaller inputs are not worth splitting between threads
+        constexpr static std::size_t PARALLEL_LINK_MIN_CHUNK_SIZE = 1 << 20;
+        constexpr static std::size_t PARALLEL_UNIQUE_MIN_CORNERS = 1 << 16;
 
         ObjData() = default;
         ~ObjData() = default;
@@ -147,7 +75,7 @@ namespace GeometryParser
                 std::size_t groups_reserve);
 
         Error Link(const std::filesystem::path& path,
-                   bool read_all,
+                   ObjParserOpenMode mode,
                    hrs::flags<ObjDataLinkFlags> flags,
                    const ObjDataReplaceValue& replace);
 
@@ -164,9 +92,43 @@ namespace GeometryParser
                    const ObjDataReplaceValue& replace,
                    bool close_range);
 
+        //splits data into line chunks that are parsed concurrently and merged afterwards,
+        //the result is identical to Link, thread_count == 0 means all hardware threads
+        Error LinkParallel(const std::filesystem::path& path,
+                           hrs::flags<ObjDataLinkFlags> flags,
+                           const ObjDataReplaceValue& replace,
+                           std::size_t thread_count = 0);
+
+        Error LinkParallel(std::string_view data,
+                           hrs::flags<ObjDataLinkFlags> flags,
+                           const ObjDataReplaceValue& replace,
+                           std::size_t thread_count = 0);
+
+        //Deduplicates corners and writes interleaved vertices and triangulated indices
+        //into target blocks while parsing (see ObjStreamLink.h). Only vertices, texture
+        //coordinates, normals and groups are stored, face indices, indices and unique faces
+        //stay empty, group start indices refer to the written indices.
+        hrs::expected<ObjStreamLinkResult, Error> LinkStream(const std::filesystem::path& path,
+                                                             ObjParserOpenMode mode,
+                                                             hrs::flags<ObjDataLinkFlags> flags,
+                                                             const ObjDataReplaceValue& replace,
+                                                             const ObjStreamLinkSettings& settings,
+                                                             const ObjStreamTarget& target);
+
+        //close_range closes rng on errors as well
+        hrs::expected<ObjStreamLinkResult, Error> LinkStream(ObjParserRange& rng,
+                                                             hrs::flags<ObjDataLinkFlags> flags,
+                                                             const ObjDataReplaceValue& replace,
+                                                             const ObjStreamLinkSettings& settings,
+                                                             const ObjStreamTarget& target,
+                                                             bool close_range);
+
         void Clear() noexcept;
         void ClearUniqueFaces() noexcept;
-        void ConstructUniqueFaces() noexcept;
+        //assigns ids to unique v/vt/vn tuples in order of their first appearance
+        //and rebuilds indices, thread_count != 1 distributes tuples between threads by hash,
+        //thread_count == 0 means all hardware threads
+        void ConstructUniqueFaces(std::size_t thread_count = 1);
 
         const std::vector<float>& GetVertices() const noexcept;
         const std::vector<float>& GetTextureCoordinates() const noexcept;
@@ -175,7 +137,7 @@ namespace GeometryParser
         const std::vector<std::uint32_t>& GetIndices() const noexcept;
         const std::vector<ObjDataGroup>& GetGroups() const noexcept;
         const ObjDataSchema& GetSchema() const noexcept;
-        const UniqueIndexMap& GetUniqueFaceIndices() const noexcept;
+        const std::vector<ObjDataFaceKey>& GetUniqueFaces() const noexcept; //by id
 
         const float* GetVertexByIndex(std::size_t index) const noexcept;
         const float* GetTextureCoordinatesByIndex(std::size_t index) const noexcept;
@@ -183,6 +145,20 @@ namespace GeometryParser
 
         std::pair<const std::uint32_t*, std::uint32_t>
         GetFaceIndexIdPair(std::size_t index) const noexcept;
+    private:
+        Error link_range(ObjParserRange& rng,
+                         hrs::flags<ObjDataLinkFlags> flags,
+                         const ObjDataReplaceValue& replace);
+
+        void link_attribute(const ElementData& elem,
+                            hrs::flags<ObjDataLinkFlags> flags,
+                            const ObjDataReplaceValue& replace);
+
+        template<FaceType Type>
+        void construct_unique_faces(std::size_t expected_count);
+
+        template<FaceType Type>
+        void construct_unique_faces_parallel(std::size_t expected_count, std::size_t thread_count);
     private:
         std::vector<float> vertices;
         std::vector<float> texture_coordinates;
@@ -191,6 +167,6 @@ namespace GeometryParser
         std::vector<std::uint32_t> indices;
         std::vector<ObjDataGroup> groups;
         ObjDataSchema schema;
-        UniqueIndexMap unique_faces;
+        std::vector<ObjDataFaceKey> unique_faces;
     };
 };
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "ObjSchema.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace GeometryParser
+{
+    //v/vt/vn index tuple of a face corner, components absent in the face type are zero
+    struct ObjDataFaceKey
+    {
+        std::uint32_t vertex;
+        std::uint32_t texture_coordinates;
+        std::uint32_t normal;
+
+        bool operator==(const ObjDataFaceKey&) const noexcept = default;
+    };
+
+    template<FaceType Type>
+    struct ObjDataFaceTraits
+    {
+        constexpr static std::size_t COUNT =
+            (Type == FaceType::Vertex ? 1
+                                      : (Type == FaceType::VertexTextureCoordinatesNormal ? 3 : 2));
+
+        static ObjDataFaceKey MakeKey(const std::uint32_t* face_index) noexcept
+        {
+            if constexpr(Type == FaceType::Vertex)
+                return {face_index[0], 0, 0};
+            else if constexpr(Type == FaceType::VertexTextureCoordinates)
+                return {face_index[0], face_index[1], 0};
+            else if constexpr(Type == FaceType::VertexNormal)
+                return {face_index[0], 0, face_index[1]};
+            else
+                return {face_index[0], face_index[1], face_index[2]};
+        }
+
+        //multiplicative hashing, the table takes the high bits
+        static std::uint64_t Hash(const ObjDataFaceKey& key) noexcept
+        {
+            constexpr std::uint64_t MUL_0 = 0x9E3779B97F4A7C15;
+            constexpr std::uint64_t MUL_1 = 0xC2B2AE3D27D4EB4F;
+
+            if constexpr(Type == FaceType::Vertex)
+                return key.vertex * MUL_0;
+            else if constexpr(Type == FaceType::VertexTextureCoordinates)
+                return (key.vertex | (std::uint64_t(key.texture_coordinates) << 32)) * MUL_0;
+            else if constexpr(Type == FaceType::VertexNormal)
+                return (key.vertex | (std::uint64_t(key.normal) << 32)) * MUL_0;
+            else
+            {
+                std::uint64_t h =
+                    (key.vertex | (std::uint64_t(key.texture_coordinates) << 32)) * MUL_0;
+                return (h ^ (h >> 29) ^ key.normal) * MUL_1;
+            }
+        }
+
+        static bool Equal(const ObjDataFaceKey& key1, const ObjDataFaceKey& key2) noexcept
+        {
+            if constexpr(Type == FaceType::Vertex)
+                return key1.vertex == key2.vertex;
+            else if constexpr(Type == FaceType::VertexTextureCoordinates)
+                return key1.vertex == key2.vertex &&
+                       key1.texture_coordinates == key2.texture_coordinates;
+            else if constexpr(Type == FaceType::VertexNormal)
+                return key1.vertex == key2.vertex && key1.normal == key2.normal;
+            else
+                return key1 == key2;
+        }
+    };
+
+    //Calls func(std::integral_constant<FaceType, type>{}) so the callee is compiled per face type
+    template<typename F>
+    decltype(auto) DispatchFaceType(FaceType type, F&& func)
+    {
+        switch(type)
+        {
+            case FaceType::Vertex:
+                return std::forward<F>(func)(std::integral_constant<FaceType, FaceType::Vertex>{});
+            case FaceType::VertexTextureCoordinates:
+                return std::forward<F>(func)(
+                    std::integral_constant<FaceType, FaceType::VertexTextureCoordinates>{});
+            case FaceType::VertexNormal:
+                return std::forward<F>(func)(
+                    std::integral_constant<FaceType, FaceType::VertexNormal>{});
+            case FaceType::VertexTextureCoordinatesNormal:
+            default:
+                return std::forward<F>(func)(
+                    std::integral_constant<FaceType, FaceType::VertexTextureCoordinatesNormal>{});
+        }
+    }
+
+    //Open-addressing table with linear probing that maps face keys to 32-bit values.
+    //Keys are stored inline, so a probe touches only the slot array.
+    template<FaceType Type>
+    class ObjDataFaceTable
+    {
+    public:
+        using Traits = ObjDataFaceTraits<Type>;
+        constexpr static std::uint32_t EMPTY_VALUE = std::numeric_limits<std::uint32_t>::max();
+
+        explicit ObjDataFaceTable(std::size_t expected_count = 0)
+            : size(0)
+        {
+            rehash(capacity_for(expected_count));
+        }
+
+        //returns the stored value and true if the key has been inserted with the passed value
+        std::pair<std::uint32_t, bool> Emplace(const ObjDataFaceKey& key, std::uint32_t value)
+        {
+            return Emplace(key, value, Traits::Hash(key));
+        }
+
+        std::pair<std::uint32_t, bool>
+        Emplace(const ObjDataFaceKey& key, std::uint32_t value, std::uint64_t hash)
+        {
+            if((size + 1) * 2 > slots.size())
+                rehash(slots.size() * 2);
+
+            std::size_t mask = slots.size() - 1;
+            for(std::size_t i = hash >> shift;; i = (i + 1) & mask)
+            {
+                auto& s = slots[i];
+                if(s.value == EMPTY_VALUE)
+                {
+                    s.key = key;
+                    s.value = value;
+                    size++;
+                    return {value, true};
+                }
+
+                if(Traits::Equal(s.key, key))
+                    return {s.value, false};
+            }
+        }
+
+        std::size_t Size() const noexcept
+        {
+            return size;
+        }
+    private:
+        struct slot
+        {
+            ObjDataFaceKey key;
+            std::uint32_t value;
+        };
+
+        static std::size_t capacity_for(std::size_t count) noexcept
+        {
+            return std::bit_ceil(std::max<std::size_t>(count * 2, 16));
+        }
+
+        void rehash(std::size_t capacity)
+        {
+            std::vector<slot> old_slots(capacity, slot{.key = {}, .value = EMPTY_VALUE});
+            old_slots.swap(slots);
+            shift = 64 - std::countr_zero(capacity);
+
+            std::size_t mask = capacity - 1;
+            for(const auto& s: old_slots)
+            {
+                if(s.value == EMPTY_VALUE)
+                    continue;
+
+                std::size_t i = Traits::Hash(s.key) >> shift;
+                while(slots[i].value != EMPTY_VALUE)
+                    i = (i + 1) & mask;
+
+                slots[i] = s;
+            }
+        }
+    private:
+        std::vector<slot> slots;
+        std::size_t size;
+        unsigned shift;
+    };
+};
@@ -1,5 +1,5 @@
 #include "ObjParserRange.h"
-#include <ranges>
+#include <limits>
 
 namespace GeometryParser
 {
@@ -11,7 +11,9 @@ namespace GeometryParser
     ObjParserRange::ObjParserRange(ObjParserRange&& rng) noexcept
         : stream(std::move(rng.stream)),
           schema(std::move(rng.schema)),
+          element_count(rng.element_count),
           line(std::move(rng.line)),
+          last_line(),
           face_indices(std::move(rng.face_indices))
     {}
 
@@ -21,16 +23,33 @@ namespace GeometryParser
 
         stream = std::move(rng.stream);
         schema = std::move(rng.schema);
+        element_count = rng.element_count;
         line = std::move(rng.line);
+        last_line = {};
         face_indices = std::move(rng.face_indices);
 
         return *this;
     }
 
-    Result ObjParserRange::Open(const std::filesystem::path& path, bool read_all) noexcept
+    Result ObjParserRange::Open(const std::filesystem::path& path, ObjParserOpenMode mode) noexcept
     {
         Close();
         schema = {};
+        element_count = {};
+
+        if(mode == ObjParserOpenMode::Map)
+        {
+            if(!std::holds_alternative<mapped_stream>(stream))
+                stream = mapped_stream{};
+
+            auto& mapped = std::get<mapped_stream>(stream);
+            if(!mapped.file.open(path))
+                return Result::BadFile;
+
+            mapped.data = mapped.file.get_string_view();
+            mapped.offset = 0;
+            return Result::Success;
+        }
 
         if(!std::holds_alternative<std::ifstream>(stream))
             stream = std::ifstream{};
@@ -40,7 +59,7 @@ namespace GeometryParser
         if(!file_stream.is_open())
             return Result::BadFile;
 
-        if(read_all)
+        if(mode == ObjParserOpenMode::ReadAll)
         {
             std::error_code code;
             auto file_size = std::filesystem::file_size(path, code);
@@ -60,6 +79,7 @@ namespace GeometryParser
     {
         Close();
         schema = {};
+        element_count = {};
 
         if(!std::holds_alternative<std::istringstream>(stream))
             stream = std::istringstream{};
@@ -73,6 +93,7 @@ namespace GeometryParser
     {
         Close();
         schema = {};
+        element_count = {};
 
         if(!std::holds_alternative<std::istringstream>(stream))
             stream = std::istringstream{};
@@ -82,64 +103,82 @@ namespace GeometryParser
         return Result::Success;
     }
 
+    Result ObjParserRange::ConsumeView(std::string_view data,
+                                       const ObjParserElementCount& base) noexcept
+    {
+        Close();
+        schema = {};
+        element_count = base;
+
+        if(!std::holds_alternative<mapped_stream>(stream))
+            stream = mapped_stream{};
+
+        auto& mapped = std::get<mapped_stream>(stream);
+        mapped.data = data;
+        mapped.offset = 0;
+
+        return Result::Success;
+    }
+
     void ObjParserRange::Close() noexcept
     {
+        last_line = {};
         if(std::holds_alternative<std::ifstream>(stream))
         {
             auto& file_stream = std::get<std::ifstream>(stream);
             if(IsOpen())
                 file_stream.close();
         }
+        else if(std::holds_alternative<mapped_stream>(stream))
+        {
+            auto& mapped = std::get<mapped_stream>(stream);
+            mapped.file.close();
+            mapped.data = {};
+            mapped.offset = 0;
+        }
     }
 
     bool ObjParserRange::IsOpen() const noexcept
     {
         if(std::holds_alternative<std::ifstream>(stream))
             return std::get<std::ifstream>(stream).is_open();
+        else if(std::holds_alternative<mapped_stream>(stream))
+        {
+            auto& mapped = std::get<mapped_stream>(stream);
+            return mapped.file.is_open() || mapped.data.data() != nullptr;
+        }
 
         return true;
     }
 
     hrs::expected<ElementData, Error> ObjParserRange::Next()
     {
-        auto create_error = [](const std::string& line, const parse_result& res)
+        auto create_error = [](std::string_view line, const parse_result& res)
         {
             return Error{.result = res.result,
-                         .str = line,
+                         .str = std::string(line),
                          .column = static_cast<size_t>(res.ptr - line.data())};
         };
 
-        auto read_line = [&]() -> bool
-        {
-            if(std::holds_alternative<std::ifstream>(stream))
-            {
-                auto& file_stream = std::get<std::ifstream>(stream);
-                std::getline(file_stream, line);
-                return file_stream.eof();
-            }
-            else
-            {
-                auto& str_stream = std::get<std::istringstream>(stream);
-                std::getline(str_stream, line);
-                return str_stream.eof();
-            }
-        };
-
         if(!IsOpen())
             return Error{.result = Result::BadFile};
 
+        std::string_view line;
         while(true)
         {
-            bool eof = read_line();
+            bool eof = read_line(line);
             if(eof)
                 return Error{.result = Result::EndOfFile};
 
+            last_line = line;
+
             if(line.starts_with("v "))
             {
                 auto exp = parse_vertex(line);
                 if(!exp)
                     return create_error(line, exp.error());
 
+                element_count.vertices++;
                 return ElementData{.tag = schema.GetVertexElement(), .data = exp.value()};
             }
             else if(line.starts_with("vt "))
@@ -148,6 +187,7 @@ namespace GeometryParser
                 if(!exp)
                     return create_error(line, exp.error());
 
+                element_count.texture_coordinates++;
                 return ElementData{.tag = schema.GetTextureCoordinatesElement(),
                                    .data = exp.value()};
             }
@@ -157,6 +197,7 @@ namespace GeometryParser
                 if(!exp)
                     return create_error(line, exp.error());
 
+                element_count.normals++;
                 return ElementData{.tag = Element::Normal, .data = exp.value()};
             }
             else if(line.starts_with("f "))
@@ -180,16 +221,57 @@ namespace GeometryParser
         return Error{.result = Result::EndOfFile};
     }
 
+    std::string_view ObjParserRange::GetLine() const noexcept
+    {
+        return last_line;
+    }
+
     const ObjParserSchema& ObjParserRange::GetSchema() const noexcept
     {
         return schema;
     }
 
+    const ObjParserElementCount& ObjParserRange::GetElementCount() const noexcept
+    {
+        return element_count;
+    }
+
+    bool ObjParserRange::read_line(std::string_view& out_line)
+    {
+        if(std::holds_alternative<mapped_stream>(stream))
+        {
+            auto& mapped = std::get<mapped_stream>(stream);
+            if(mapped.offset == mapped.data.size())
+                return true;
+
+            auto end = FindChar(mapped.data, '\n', mapped.offset);
+            if(end == std::string_view::npos)
+                end = mapped.data.size();
+
+            out_line = mapped.data.substr(mapped.offset, end - mapped.offset);
+            mapped.offset = (end == mapped.data.size() ? end : end + 1);
+            return false;
+        }
+
+        std::istream* str_stream;
+        if(std::holds_alternative<std::ifstream>(stream))
+            str_stream = &std::get<std::ifstream>(stream);
+        else
+            str_stream = &std::get<std::istringstream>(stream);
+
+        //the last line may be not terminated by a new line, so fail state is the real end
+        if(!std::getline(*str_stream, line))
+            return true;
+
+        out_line = line;
+        return false;
+    }
+
     std::string_view ObjParserRange::trim_spaces_back(std::string_view str) const noexcept
     {
         for(auto rit = str.rbegin(); rit != str.rend(); rit++)
         {
-            if(!(*rit.base() == ' ' || *rit.base() == '\t'))
+            if(!(*rit == ' ' || *rit == '\t'))
             {
                 str = std::string_view(str.begin(), rit.base());
                 break;
@@ -214,12 +296,12 @@ namespace GeometryParser
         if(schema_components == 0) //no schema
         {
             std::uint8_t i = 0;
-            for(const auto value: std::ranges::split_view(trimmed, ' ') | std::views::drop(1))
+            for(const auto value: ObjSplitRange(SkipFirstToken(trimmed, ' '), ' '))
             {
                 if((i + 1) > max_components)
                     return parse_result{.result = bad_result, .ptr = value.data()};
 
-                auto float_opt = parse_value<float>(std::string_view(value.begin(), value.end()));
+                auto float_opt = parse_value<float>(value);
                 if(!float_opt)
                     return parse_result{.result = bad_result, .ptr = value.data()};
 
@@ -235,12 +317,12 @@ namespace GeometryParser
         else
         {
             std::uint8_t i = 0;
-            for(const auto value: std::ranges::split_view(trimmed, ' ') | std::views::drop(1))
+            for(const auto value: ObjSplitRange(SkipFirstToken(trimmed, ' '), ' '))
             {
                 if((i + 1) > schema_components)
                     return parse_result{.result = bad_result, .ptr = value.data()};
 
-                auto float_opt = parse_value<float>(std::string_view(value.begin(), value.end()));
+                auto float_opt = parse_value<float>(value);
                 if(!float_opt)
                     return parse_result{.result = bad_result, .ptr = value.data()};
 
@@ -259,14 +341,34 @@ namespace GeometryParser
     ObjParserRange::find_face_slashes(std::string_view str) const noexcept
     {
         face_parse_slashes out{.first = std::string_view::npos, .second = std::string_view::npos};
-        out.first = str.find('/');
+        out.first = FindChar(str, '/');
         if(out.first == std::string_view::npos)
             return out;
 
-        out.second = str.find('/', out.first + 1);
+        out.second = FindChar(str, '/', out.first + 1);
         return out;
     }
 
+    std::optional<std::uint32_t> ObjParserRange::parse_face_index(std::string_view str,
+                                                                  std::uint32_t count) const noexcept
+    {
+        auto value_opt = parse_value<std::int64_t>(str);
+        if(!value_opt)
+            return {};
+
+        std::int64_t value = *value_opt;
+        if(value < 0) //relative index: -1 is the last element defined before this face
+        {
+            value += static_cast<std::int64_t>(count) + 1;
+            if(value < 1)
+                return {};
+        }
+        else if(value > std::numeric_limits<std::uint32_t>::max())
+            return {};
+
+        return static_cast<std::uint32_t>(value);
+    }
+
     ObjParserRange::parse_result
     ObjParserRange::parse_face_element(std::string_view str,
                                        const face_parse_slashes& slashes) noexcept
@@ -275,7 +377,7 @@ namespace GeometryParser
         {
             case FaceType::Vertex:
             {
-                auto value_opt = parse_value<std::uint32_t>(str);
+                auto value_opt = parse_face_index(str, element_count.vertices);
                 if(!value_opt)
                     return parse_result{.result = Result::BadFace, .ptr = str.data()};
 
@@ -287,10 +389,12 @@ namespace GeometryParser
                 std::string_view values[2] = {
                     std::string_view(str.begin(), str.begin() + slashes.first),
                     std::string_view(str.begin() + slashes.first + 1, str.end())};
+                std::uint32_t counts[2] = {element_count.vertices,
+                                           element_count.texture_coordinates};
 
-                for(const auto& val: values)
+                for(std::size_t i = 0; i < 2; i++)
                 {
-                    auto value_opt = parse_value<std::uint32_t>(val);
+                    auto value_opt = parse_face_index(values[i], counts[i]);
                     if(!value_opt)
                         return parse_result{.result = Result::BadFace, .ptr = str.data()};
 
@@ -303,10 +407,11 @@ namespace GeometryParser
                 std::string_view values[2] = {
                     std::string_view(str.begin(), str.begin() + slashes.first),
                     std::string_view(str.begin() + slashes.second + 1, str.end())};
+                std::uint32_t counts[2] = {element_count.vertices, element_count.normals};
 
-                for(const auto& val: values)
+                for(std::size_t i = 0; i < 2; i++)
                 {
-                    auto value_opt = parse_value<std::uint32_t>(val);
+                    auto value_opt = parse_face_index(values[i], counts[i]);
                     if(!value_opt)
                         return parse_result{.result = Result::BadFace, .ptr = str.data()};
 
@@ -320,10 +425,13 @@ namespace GeometryParser
                     std::string_view(str.begin(), str.begin() + slashes.first),
                     std::string_view(str.begin() + slashes.first + 1, str.begin() + slashes.second),
                     std::string_view(str.begin() + slashes.second + 1, str.end())};
+                std::uint32_t counts[3] = {element_count.vertices,
+                                           element_count.texture_coordinates,
+                                           element_count.normals};
 
-                for(const auto& val: values)
+                for(std::size_t i = 0; i < 3; i++)
                 {
-                    auto value_opt = parse_value<std::uint32_t>(val);
+                    auto value_opt = parse_face_index(values[i], counts[i]);
                     if(!value_opt)
                         return parse_result{.result = Result::BadFace, .ptr = str.data()};
 
@@ -369,13 +477,12 @@ namespace GeometryParser
         face_indices.clear();
         if(schema.face_count == 0) //no schema
         {
-            for(const auto face_line: std::ranges::split_view(trimmed, ' ') | std::views::drop(1))
+            for(const auto face_line: ObjSplitRange(SkipFirstToken(trimmed, ' '), ' '))
             {
                 if((schema.face_count + 1) == 255)
                     return parse_result{.result = Result::BadFace, .ptr = face_line.data()};
 
-                auto slashes =
-                    find_face_slashes(std::string_view(face_line.begin(), face_line.end()));
+                auto slashes = find_face_slashes(face_line);
 
                 if(schema.face_count == 0)
                     schema.face_type = slashes.GetFaceType();
@@ -386,8 +493,7 @@ namespace GeometryParser
                         return parse_result{.result = Result::BadFace, .ptr = face_line.data()};
                 }
 
-                auto res = parse_face_element(std::string_view(face_line.begin(), face_line.end()),
-                                              slashes);
+                auto res = parse_face_element(face_line, slashes);
 
                 if(res.result != Result::Success)
                     return res;
@@ -401,20 +507,18 @@ namespace GeometryParser
         else
         {
             std::uint8_t i = 0;
-            for(const auto face_line: std::ranges::split_view(trimmed, ' ') | std::views::drop(1))
+            for(const auto face_line: ObjSplitRange(SkipFirstToken(trimmed, ' '), ' '))
             {
                 if((i + 1) > schema.face_count)
                     return parse_result{.result = Result::BadFace, .ptr = face_line.data()};
 
-                auto slashes =
-                    find_face_slashes(std::string_view(face_line.begin(), face_line.end()));
+                auto slashes = find_face_slashes(face_line);
 
                 bool satisfy = slashes.IsSatisfy(schema.face_type);
                 if(!satisfy)
                     return parse_result{.result = Result::BadFace, .ptr = face_line.data()};
 
-                auto res = parse_face_element(std::string_view(face_line.begin(), face_line.end()),
-                                              slashes);
+                auto res = parse_face_element(face_line, slashes);
 
                 if(res.result != Result::Success)
                     return res;
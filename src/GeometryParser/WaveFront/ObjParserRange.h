@@ -1,14 +1,18 @@
 #pragma once
 
+#include "ObjScanner.h"
 #include "ObjSchema.h"
 #include "hrs/expected.hpp"
 #include "hrs/flags.hpp"
+#include "hrs/mapped_file.hpp"
 #include "hrs/non_creatable.hpp"
 #include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <optional>
+#include <sstream>
+#include <string_view>
 
 namespace GeometryParser
 {
@@ -20,18 +24,30 @@ namespace GeometryParser
         ObjParserRange(ObjParserRange&& rng) noexcept;
         ObjParserRange& operator=(ObjParserRange&& rng) noexcept;
 
-        Result Open(const std::filesystem::path& path, bool read_all) noexcept;
+        Result Open(const std::filesystem::path& path, ObjParserOpenMode mode) noexcept;
         Result Consume(const std::string& data);
         Result Consume(std::string&& data) noexcept;
+        //data must outlive parsing, base is used for chunks that don't start at the beginning of a file
+        Result ConsumeView(std::string_view data, const ObjParserElementCount& base = {}) noexcept;
 
         void Close() noexcept;
 
         bool IsOpen() const noexcept;
 
         hrs::expected<ElementData, Error> Next();
+        //line of the element returned by the last Next, valid until the next call
+        std::string_view GetLine() const noexcept;
 
         const ObjParserSchema& GetSchema() const noexcept;
+        const ObjParserElementCount& GetElementCount() const noexcept;
     private:
+        struct mapped_stream
+        {
+            hrs::mapped_file file;
+            std::string_view data;
+            std::string_view::size_type offset;
+        };
+
         struct parse_result
         {
             Result result;
@@ -72,9 +88,14 @@ namespace GeometryParser
             }
         };
 
+        bool read_line(std::string_view& out_line);
+
         template<typename T>
         std::optional<T> parse_value(std::string_view str) const noexcept;
 
+        std::optional<std::uint32_t> parse_face_index(std::string_view str,
+                                                      std::uint32_t count) const noexcept;
+
         std::string_view trim_spaces_back(std::string_view str) const noexcept;
 
         hrs::expected<VectorElement, parse_result>
@@ -95,9 +116,11 @@ namespace GeometryParser
         hrs::expected<FaceElement, parse_result> parse_face(std::string_view str) noexcept;
         hrs::expected<GroupElement, parse_result> parse_group(std::string_view str) noexcept;
     private:
-        std::variant<std::ifstream, std::istringstream> stream;
+        std::variant<std::ifstream, std::istringstream, mapped_stream> stream;
         ObjParserSchema schema;
+        ObjParserElementCount element_count;
         std::string line;
+        std::string_view last_line;
         std::vector<std::uint32_t> face_indices;
     };
 
@@ -105,6 +128,18 @@ namespace GeometryParser
     std::optional<T> ObjParserRange::parse_value(std::string_view str) const noexcept
     {
         T value;
+        if constexpr(std::is_same_v<T, float>)
+        {
+            if(FastParseFloat(str, value))
+                return value;
+        }
+        else if constexpr(std::is_same_v<T, std::int64_t>)
+        {
+            if(FastParseInteger(str, value))
+                return value;
+        }
+
+        //covers everything fast paths reject, including malformed input
         std::from_chars_result res = std::from_chars(str.data(), str.data() + str.size(), value);
         if(!(res.ec == std::errc(0) && res.ptr == (str.data() + str.size())))
             return {};
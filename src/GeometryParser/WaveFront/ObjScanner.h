@@ -0,0 +1,256 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define GEOMETRY_PARSER_SCANNER_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace GeometryParser
+{
+    //Scans 32 bytes per step with AVX2 (GEOMETRY_PARSER_AVX2 build option),
+    //16 bytes with SSE2 otherwise. Loads never cross last, the tail is scanned bytewise.
+    //Returns last if ch isn't found.
+    inline const char* FindChar(const char* first, const char* last, char ch) noexcept
+    {
+#if defined(__AVX2__)
+        const __m256i needle = _mm256_set1_epi8(ch);
+        for(; last - first >= 32; first += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            auto mask = static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+            if(mask != 0)
+                return first + std::countr_zero(mask);
+        }
+#elif defined(GEOMETRY_PARSER_SCANNER_SSE2)
+        const __m128i needle = _mm_set1_epi8(ch);
+        for(; last - first >= 16; first += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            auto mask =
+                static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            if(mask != 0)
+                return first + std::countr_zero(mask);
+        }
+#endif
+        for(; first != last; first++)
+            if(*first == ch)
+                return first;
+
+        return last;
+    }
+
+    inline std::string_view::size_type
+    FindChar(std::string_view str, char ch, std::string_view::size_type pos = 0) noexcept
+    {
+        if(pos >= str.size())
+            return std::string_view::npos;
+
+        const char* end = str.data() + str.size();
+        const char* ptr = FindChar(str.data() + pos, end, ch);
+        return (ptr == end ? std::string_view::npos : ptr - str.data());
+    }
+
+    //everything after the first delimiter, e.g. values of a 'v 1 2 3' line
+    inline std::string_view SkipFirstToken(std::string_view str, char delimiter) noexcept
+    {
+        auto pos = FindChar(str, delimiter);
+        if(pos == std::string_view::npos)
+            return {};
+
+        return str.substr(pos + 1);
+    }
+
+    //Same tokens as std::ranges::split_view over a string_view,
+    //but the delimiter search goes through FindChar
+    class ObjSplitRange
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+
+            Iterator(std::string_view _rest, char _delimiter) noexcept
+                : rest(_rest),
+                  delimiter(_delimiter),
+                  last_token(false),
+                  finished(_rest.empty())
+            {
+                if(!finished)
+                    advance();
+            }
+
+            std::string_view operator*() const noexcept
+            {
+                return current;
+            }
+
+            Iterator& operator++() noexcept
+            {
+                advance();
+                return *this;
+            }
+
+            bool operator==(std::default_sentinel_t) const noexcept
+            {
+                return finished;
+            }
+        private:
+            void advance() noexcept
+            {
+                if(last_token)
+                {
+                    finished = true;
+                    return;
+                }
+
+                auto pos = FindChar(rest, delimiter);
+                if(pos == std::string_view::npos)
+                {
+                    current = rest;
+                    last_token = true;
+                }
+                else
+                {
+                    current = rest.substr(0, pos);
+                    rest = rest.substr(pos + 1);
+                }
+            }
+        private:
+            std::string_view rest;
+            std::string_view current;
+            char delimiter;
+            bool last_token;
+            bool finished;
+        };
+
+        ObjSplitRange(std::string_view _str, char _delimiter) noexcept
+            : str(_str),
+              delimiter(_delimiter)
+        {}
+
+        Iterator begin() const noexcept
+        {
+            return Iterator(str, delimiter);
+        }
+
+        std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        }
+    private:
+        std::string_view str;
+        char delimiter;
+    };
+
+    //Clinger's fast path: a mantissa of at most 2^24 and a power of ten of at most 10^10
+    //are both exact in float, so one multiplication or division is correctly rounded,
+    //exactly like std::from_chars. Returns false if the input isn't covered, not only if it's bad.
+    inline bool FastParseFloat(std::string_view str, float& value) noexcept
+    {
+        constexpr static float POWERS_OF_TEN[] =
+            {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+        constexpr std::uint64_t MAX_EXACT_MANTISSA = std::uint64_t(1) << 24;
+        constexpr int MAX_EXACT_EXPONENT = 10;
+        constexpr int MAX_DIGITS = 19;
+
+        const char* ptr = str.data();
+        const char* end = ptr + str.size();
+
+        bool negative = (ptr != end && *ptr == '-');
+        if(negative)
+            ptr++;
+
+        std::uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        for(; ptr != end && static_cast<unsigned char>(*ptr - '0') < 10; ptr++, digits++)
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*ptr - '0');
+
+        if(ptr != end && *ptr == '.')
+        {
+            ptr++;
+            for(; ptr != end && static_cast<unsigned char>(*ptr - '0') < 10;
+                ptr++, digits++, exponent--)
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(*ptr - '0');
+        }
+
+        if(digits == 0 || digits > MAX_DIGITS)
+            return false;
+
+        if(ptr != end && (*ptr == 'e' || *ptr == 'E'))
+        {
+            ptr++;
+            bool exponent_negative = false;
+            if(ptr != end && (*ptr == '-' || *ptr == '+'))
+                exponent_negative = (*ptr++ == '-');
+
+            int exponent_value = 0;
+            int exponent_digits = 0;
+            for(; ptr != end && static_cast<unsigned char>(*ptr - '0') < 10 && exponent_digits < 4;
+                ptr++, exponent_digits++)
+                exponent_value = exponent_value * 10 + (*ptr - '0');
+
+            if(exponent_digits == 0)
+                return false;
+
+            exponent += (exponent_negative ? -exponent_value : exponent_value);
+        }
+
+        if(ptr != end)
+            return false;
+
+        if(mantissa > MAX_EXACT_MANTISSA || exponent < -MAX_EXACT_EXPONENT ||
+           exponent > MAX_EXACT_EXPONENT)
+            return false;
+
+        float result = static_cast<float>(mantissa);
+        if(exponent < 0)
+            result /= POWERS_OF_TEN[-exponent];
+        else
+            result *= POWERS_OF_TEN[exponent];
+
+        value = (negative ? -result : result);
+        return true;
+    }
+
+    //plain decimal integers of up to 18 digits can't overflow
+    inline bool FastParseInteger(std::string_view str, std::int64_t& value) noexcept
+    {
+        constexpr std::size_t MAX_DIGITS = 18;
+
+        const char* ptr = str.data();
+        const char* end = ptr + str.size();
+
+        bool negative = (ptr != end && *ptr == '-');
+        if(negative)
+            ptr++;
+
+        if(ptr == end || static_cast<std::size_t>(end - ptr) > MAX_DIGITS)
+            return false;
+
+        std::int64_t result = 0;
+        for(; ptr != end; ptr++)
+        {
+            auto digit = static_cast<unsigned char>(*ptr - '0');
+            if(digit >= 10)
+                return false;
+
+            result = result * 10 + digit;
+        }
+
+        value = (negative ? -result : result);
+        return true;
+    }
+};
@@ -88,6 +88,14 @@ namespace GeometryParser
         std::size_t IndicesPerFace() const noexcept;
     };
 
+    //elements defined so far, relative (negative) face indices are resolved against them
+    struct ObjParserElementCount
+    {
+        std::uint32_t vertices;
+        std::uint32_t texture_coordinates;
+        std::uint32_t normals;
+    };
+
     enum class Result
     {
         Success,
@@ -100,6 +108,13 @@ namespace GeometryParser
         BadGroup
     };
 
+    enum class ObjParserOpenMode
+    {
+        Stream, //line by line through std::ifstream
+        ReadAll, //whole file is read into memory and parsed from there
+        Map //whole file is memory-mapped and parsed in-place without copies
+    };
+
     struct Error
     {
         Result result;
@@ -0,0 +1,237 @@
+#include "ObjStreamLink.h"
+#include "ObjParserRange.h"
+#include "hrs/debug.hpp"
+#include "hrs/scoped_call.hpp"
+#include <cstring>
+
+namespace GeometryParser
+{
+    //copies records into acquired blocks, so the output is never held in full
+    class obj_stream_writer
+    {
+    public:
+        obj_stream_writer(const ObjStreamAcquire& _acquire, std::size_t _block_size) noexcept
+            : acquire(&_acquire),
+              block_size(_block_size),
+              written(0)
+        {}
+
+        //GetWritten counts only the bytes that were copied into blocks
+        bool Write(const std::byte* data, std::size_t size)
+        {
+            while(size != 0)
+            {
+                if(block.empty())
+                {
+                    block = (*acquire)(block_size);
+                    if(block.empty())
+                        return false;
+                }
+
+                std::size_t count = std::min(size, block.size());
+                std::memcpy(block.data(), data, count);
+                block = block.subspan(count);
+                data += count;
+                size -= count;
+                written += count;
+            }
+
+            return true;
+        }
+
+        std::size_t GetWritten() const noexcept
+        {
+            return written;
+        }
+    private:
+        const ObjStreamAcquire* acquire;
+        std::size_t block_size;
+        std::size_t written;
+        std::span<std::byte> block;
+    };
+
+    hrs::expected<ObjStreamLinkResult, Error>
+    ObjData::LinkStream(const std::filesystem::path& path,
+                        ObjParserOpenMode mode,
+                        hrs::flags<ObjDataLinkFlags> flags,
+                        const ObjDataReplaceValue& replace,
+                        const ObjStreamLinkSettings& settings,
+                        const ObjStreamTarget& target)
+    {
+        ObjParserRange rng;
+        auto res = rng.Open(path, mode);
+        if(res != Result::Success)
+            return Error{.result = res};
+
+        return LinkStream(rng, flags, replace, settings, target, true);
+    }
+
+    hrs::expected<ObjStreamLinkResult, Error>
+    ObjData::LinkStream(ObjParserRange& rng,
+                        hrs::flags<ObjDataLinkFlags> flags,
+                        const ObjDataReplaceValue& replace,
+                        const ObjStreamLinkSettings& settings,
+                        const ObjStreamTarget& target,
+                        bool close_range)
+    {
+        hrs::assert_true_debug(settings.encoding.position == PositionEncoding::Float32,
+                               "Streaming link can't quantize positions without mesh bounds!");
+        hrs::assert_true_debug(settings.block_size != 0, "Block size must be greater than zero!");
+
+        //error returns close the range too
+        hrs::scoped_call range_close(
+            [&rng, close_range]()
+            {
+                if(close_range)
+                    rng.Close();
+            });
+
+        Clear();
+        schema.vertex_components = 3;
+        schema.texture_components = 1;
+
+        //the widest key type fits all face types, absent components are zero
+        ObjDataFaceTable<FaceType::VertexTextureCoordinatesNormal> table;
+        obj_stream_writer vertex_writer(target.vertices, settings.block_size);
+        obj_stream_writer index_writer(target.indices, settings.block_size);
+        ObjStreamLinkResult result = {.layout = {}, .vertex_count = 0, .index_count = 0};
+        std::vector<std::byte> record;
+        std::vector<std::uint32_t> face_ids;
+        bool has_faces = false;
+        constexpr VertexDecodeParameters NO_DECODE = {.position_offset = {0, 0, 0, 0},
+                                                      .position_scale = {1, 1, 1, 0}};
+
+        //points at the corner token like the parser errors do
+        auto bad_face = [&rng](std::size_t corner)
+        {
+            std::string_view line = rng.GetLine();
+            std::string_view token = line;
+            for(const auto face_line: ObjSplitRange(SkipFirstToken(line, ' '), ' '))
+                if(corner-- == 0)
+                {
+                    token = face_line;
+                    break;
+                }
+
+            return Error{.result = Result::BadFace,
+                         .str = std::string(line),
+                         .column = static_cast<std::size_t>(token.data() - line.data())};
+        };
+
+        auto exp = rng.Next();
+        for(; exp.has_value(); exp = rng.Next())
+        {
+            const auto& elem = exp.value();
+            switch(elem.tag)
+            {
+                case Element::Group:
+                    groups.push_back({elem.GetGroupElement().data, result.index_count});
+                    break;
+                case Element::FaceV:
+                case Element::FaceVT:
+                case Element::FaceVN:
+                case Element::FaceVTN:
+                {
+                    if(!has_faces)
+                    {
+                        has_faces = true;
+                        schema.face_type = rng.GetSchema().face_type;
+                        result.layout = GetVertexLayout(*this, settings.encoding);
+                        record.resize(result.layout.stride);
+                    }
+
+                    const auto& face = elem.GetFaceElement().data.get();
+                    std::size_t stride = FaceTypeToCount(schema.face_type);
+                    bool has_texture_coordinates =
+                        (schema.face_type == FaceType::VertexTextureCoordinates ||
+                         schema.face_type == FaceType::VertexTextureCoordinatesNormal);
+                    bool has_normals =
+                        (schema.face_type == FaceType::VertexNormal ||
+                         schema.face_type == FaceType::VertexTextureCoordinatesNormal);
+
+                    face_ids.clear();
+                    for(std::size_t corner = 0; corner < face.size() / stride; corner++)
+                    {
+                        const std::uint32_t* indices = face.data() + corner * stride;
+                        ObjDataFaceKey key = {.vertex = indices[0],
+                                              .texture_coordinates =
+                                                  (has_texture_coordinates ? indices[1] : 0),
+                                              .normal = (has_normals ? indices[stride - 1] : 0)};
+
+                        //attributes are read right away, so they must be defined already
+                        if(key.vertex == 0 ||
+                           (has_texture_coordinates && key.texture_coordinates == 0) ||
+                           (has_normals && key.normal == 0) ||
+                           key.vertex * schema.vertex_components > vertices.size() ||
+                           key.texture_coordinates * schema.texture_components >
+                               texture_coordinates.size() ||
+                           key.normal * 3 > normals.size())
+                            return bad_face(corner);
+
+                        auto [id, inserted] =
+                            table.Emplace(key, static_cast<std::uint32_t>(result.vertex_count));
+                        if(inserted)
+                        {
+                            const float* texture_coordinates_ptr =
+                                (has_texture_coordinates
+                                     ? GetTextureCoordinatesByIndex(key.texture_coordinates - 1)
+                                     : nullptr);
+                            EncodeVertex(record.data(),
+                                         result.layout,
+                                         settings.encoding,
+                                         NO_DECODE,
+                                         GetVertexByIndex(key.vertex - 1),
+                                         (has_normals ? GetNormalByIndex(key.normal - 1) : nullptr),
+                                         texture_coordinates_ptr);
+
+                            if(!vertex_writer.Write(record.data(), record.size()))
+                                return Error{.result = Result::BadFile};
+
+                            result.vertex_count++;
+                        }
+
+                        face_ids.push_back(id);
+                    }
+
+                    //same fan as Triangulator: (0, 1, 2), then (k, k + 1, 0)
+                    auto write_index = [&](std::uint32_t id)
+                    {
+                        if(!index_writer.Write(reinterpret_cast<const std::byte*>(&id),
+                                               sizeof(id)))
+                            return false;
+
+                        result.index_count++;
+                        return true;
+                    };
+
+                    bool written = true;
+                    if(face_ids.size() < 3)
+                        for(auto id: face_ids)
+                            written = written && write_index(id);
+                    else
+                    {
+                        written = write_index(face_ids[0]) && write_index(face_ids[1]) &&
+                                  write_index(face_ids[2]);
+                        for(std::size_t k = 2; k + 1 < face_ids.size(); k++)
+                            written = written && write_index(face_ids[k]) &&
+                                      write_index(face_ids[k + 1]) && write_index(face_ids[0]);
+                    }
+
+                    if(!written)
+                        return Error{.result = Result::BadFile};
+                }
+                break;
+                default:
+                    link_attribute(elem, flags, replace);
+                    break;
+            }
+        }
+
+        schema.face_count = rng.GetSchema().face_count;
+
+        if(exp.error().result != Result::EndOfFile)
+            return exp.error();
+
+        return result;
+    }
+};
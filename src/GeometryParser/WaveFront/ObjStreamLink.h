@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ObjData.h"
+#include "VertexEncoder.h"
+#include <functional>
+#include <span>
+
+namespace GeometryParser
+{
+    //Returns writable memory for the next size bytes of an output stream, e.g. a mapped
+    //staging buffer region from TransferChannel::Embed. An empty span stops linking.
+    using ObjStreamAcquire = std::function<std::span<std::byte>(std::size_t size)>;
+
+    struct ObjStreamLinkSettings
+    {
+        //Unorm16 positions aren't supported, the bounds are unknown until the end of the file
+        VertexEncodingSettings encoding;
+        //bytes requested by every acquire, only the last block of a stream may be partially
+        //filled, records may straddle blocks
+        std::size_t block_size;
+    };
+
+    struct ObjStreamTarget
+    {
+        ObjStreamAcquire vertices;
+        ObjStreamAcquire indices; //std::uint32_t, polygons are fanned, lines and points are kept
+    };
+
+    struct ObjStreamLinkResult
+    {
+        VertexLayout layout;
+        std::size_t vertex_count;
+        std::size_t index_count;
+    };
+};
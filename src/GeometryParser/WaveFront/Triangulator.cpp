@@ -1,4 +1,6 @@
 #include "Triangulator.h"
+#include "hrs/parallel_for.hpp"
+#include <algorithm>
 #include <utility>
 
 namespace GeometryParser
@@ -56,4 +58,73 @@ namespace GeometryParser
 
         return out;
     }
+
+    std::size_t Triangulator::GetIndexCount(const ObjData& _obj_data) noexcept
+    {
+        std::size_t face_count = _obj_data.GetSchema().face_count;
+        if(face_count < 3)
+            return 0;
+
+        return _obj_data.GetIndices().size() / face_count * (face_count - 2) * COMPONENTS;
+    }
+
+    bool Triangulator::TriangulateAll(const ObjData& _obj_data,
+                                      std::span<std::uint32_t> out,
+                                      std::size_t thread_count)
+    {
+        std::size_t index_count = GetIndexCount(_obj_data);
+        if(out.size() < index_count)
+            return false;
+
+        if(index_count == 0)
+            return true;
+
+        std::size_t face_count = _obj_data.GetSchema().face_count;
+        std::size_t faces = _obj_data.GetIndices().size() / face_count;
+        std::size_t indices_per_face = (face_count - 2) * COMPONENTS;
+        if(thread_count == 0)
+            thread_count = hrs::hardware_thread_count();
+
+        thread_count = std::clamp<std::size_t>(faces / PARALLEL_MIN_FACES, 1, thread_count);
+        hrs::parallel_for(
+            faces,
+            thread_count,
+            [&](std::size_t begin, std::size_t end, std::size_t)
+            {
+                const std::uint32_t* ids = _obj_data.GetIndices().data() + begin * face_count;
+                std::uint32_t* dst = out.data() + begin * indices_per_face;
+                if(face_count == 3)
+                    std::copy(ids, ids + (end - begin) * 3, dst);
+                else if(face_count == 4)
+                {
+                    for(std::size_t face = begin; face < end; face++, ids += 4, dst += 6)
+                    {
+                        dst[0] = ids[0];
+                        dst[1] = ids[1];
+                        dst[2] = ids[2];
+                        dst[3] = ids[2];
+                        dst[4] = ids[3];
+                        dst[5] = ids[0];
+                    }
+                }
+                else
+                {
+                    //same fan as Next: (0, 1, 2), then (k, k + 1, 0)
+                    for(std::size_t face = begin; face < end; face++, ids += face_count)
+                    {
+                        *dst++ = ids[0];
+                        *dst++ = ids[1];
+                        *dst++ = ids[2];
+                        for(std::size_t k = 2; k + 1 < face_count; k++)
+                        {
+                            *dst++ = ids[k];
+                            *dst++ = ids[k + 1];
+                            *dst++ = ids[0];
+                        }
+                    }
+                }
+            });
+
+        return true;
+    }
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ObjData.h"
+#include <span>
 
 namespace GeometryParser
 {
@@ -8,6 +9,8 @@ namespace GeometryParser
     {
     public:
         constexpr static std::size_t COMPONENTS = 3;
+        //smaller meshes are not worth splitting between threads
+        constexpr static std::size_t PARALLEL_MIN_FACES = 1 << 16;
 
         Triangulator(ObjData& _obj_data) noexcept;
         ~Triangulator() = default;
@@ -21,6 +24,17 @@ namespace GeometryParser
         explicit operator bool() const noexcept;
 
         std::optional<std::array<std::size_t, 3>> Next() noexcept;
+
+        //indices written by TriangulateAll: faces are fanned into face_count - 2 triangles
+        static std::size_t GetIndexCount(const ObjData& _obj_data) noexcept;
+
+        //Writes unique face ids of all triangles in the order of Next.
+        //All-triangle and all-quad meshes take branch-free loops, face ranges are split
+        //between threads, thread_count == 0 means all hardware threads.
+        //Returns false if out is smaller than GetIndexCount.
+        static bool TriangulateAll(const ObjData& _obj_data,
+                                   std::span<std::uint32_t> out,
+                                   std::size_t thread_count = 0);
     private:
         ObjData* obj_data;
         std::size_t index;
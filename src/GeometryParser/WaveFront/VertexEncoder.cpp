@@ -0,0 +1,247 @@
+#include "VertexEncoder.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace GeometryParser
+{
+    template<typename T>
+    static void write_value(std::byte* dst, T value) noexcept
+    {
+        std::memcpy(dst, &value, sizeof(T));
+    }
+
+    template<std::signed_integral T>
+    static T quantize_snorm(float value) noexcept
+    {
+        constexpr float MAX = std::numeric_limits<T>::max();
+        return static_cast<T>(std::lround(std::clamp(value, -1.0f, 1.0f) * MAX));
+    }
+
+    std::uint16_t FloatToHalf(float value) noexcept
+    {
+        std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+        std::uint32_t sign = (bits >> 16) & 0x8000;
+        std::uint32_t abs = bits & 0x7FFF'FFFF;
+
+        //infinity or NaN
+        if(abs >= 0x7F80'0000)
+            return static_cast<std::uint16_t>(sign | 0x7C00 | (abs > 0x7F80'0000 ? 0x0200 : 0));
+
+        //too large even before rounding
+        if(abs >= 0x4780'0000)
+            return static_cast<std::uint16_t>(sign | 0x7C00);
+
+        //subnormal half, 2^24 moves the smallest one to 1, nearbyint rounds half to even
+        if(abs < 0x3880'0000)
+        {
+            float scaled = std::bit_cast<float>(abs) * 16777216.0f;
+            auto mantissa = static_cast<std::uint32_t>(std::nearbyint(scaled));
+            return static_cast<std::uint16_t>(sign | mantissa);
+        }
+
+        //rebias the exponent and round the mantissa half to even, a carry may reach infinity
+        abs += 0xC800'0000 + 0x0FFF + ((abs >> 13) & 1);
+        return static_cast<std::uint16_t>(sign | (abs >> 13));
+    }
+
+    std::array<float, 2> EncodeOctahedral(const float* normal) noexcept
+    {
+        float len = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+        if(len == 0)
+            return {0, 0};
+
+        float x = normal[0] / len;
+        float y = normal[1] / len;
+        if(normal[2] < 0)
+        {
+            float folded_x = (1 - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+            float folded_y = (1 - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+            x = folded_x;
+            y = folded_y;
+        }
+
+        return {x, y};
+    }
+
+    VertexLayout GetVertexLayout(const ObjData& obj_data,
+                                 const VertexEncodingSettings& settings) noexcept
+    {
+        VertexLayout layout = {.stride = 0,
+                               .position_offset = 0,
+                               .normal_offset = VertexLayout::NO_ATTRIBUTE,
+                               .texture_coordinates_offset = VertexLayout::NO_ATTRIBUTE,
+                               .texture_coordinates_count = 0};
+
+        std::size_t offset = (settings.position == PositionEncoding::Float32 ? 12 : 8);
+        if(settings.normal != NormalEncoding::None)
+        {
+            layout.normal_offset = offset;
+            offset += (settings.normal == NormalEncoding::Float32 ? 12 : 4);
+        }
+
+        FaceType face_type = obj_data.GetSchema().face_type;
+        bool has_texture_coordinates = (face_type == FaceType::VertexTextureCoordinates ||
+                                        face_type == FaceType::VertexTextureCoordinatesNormal);
+        if(settings.texture_coordinates != TextureCoordinatesEncoding::None &&
+           has_texture_coordinates && obj_data.GetSchema().texture_components != 0)
+        {
+            layout.texture_coordinates_offset = offset;
+            layout.texture_coordinates_count = obj_data.GetSchema().texture_components;
+            if(settings.texture_coordinates == TextureCoordinatesEncoding::Float32)
+                offset += layout.texture_coordinates_count * 4;
+            else
+                offset += (layout.texture_coordinates_count + 1) / 2 * 4;
+        }
+
+        layout.stride = std::max(settings.stride, offset);
+        return layout;
+    }
+
+    void EncodeVertex(std::byte* dst,
+                      const VertexLayout& layout,
+                      const VertexEncodingSettings& settings,
+                      const VertexDecodeParameters& decode,
+                      const float* position,
+                      const float* normal,
+                      const float* texture_coordinates) noexcept
+    {
+        if(settings.position == PositionEncoding::Float32)
+        {
+            for(int i = 0; i < 3; i++)
+                write_value(dst + layout.position_offset + i * 4, position[i]);
+        }
+        else
+        {
+            for(int i = 0; i < 3; i++)
+            {
+                float scale = decode.position_scale[i];
+                float value = (scale > 0 ? (position[i] - decode.position_offset[i]) / scale : 0);
+                auto quantized =
+                    static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0f, 65535.0f)));
+                write_value(dst + layout.position_offset + i * 2, quantized);
+            }
+        }
+
+        if(layout.normal_offset != VertexLayout::NO_ATTRIBUTE)
+        {
+            constexpr float ZERO_NORMAL[3] = {0, 0, 0};
+            if(!normal)
+                normal = ZERO_NORMAL;
+
+            std::byte* normal_dst = dst + layout.normal_offset;
+            if(settings.normal == NormalEncoding::Float32)
+            {
+                for(int i = 0; i < 3; i++)
+                    write_value(normal_dst + i * 4, normal[i]);
+            }
+            else
+            {
+                auto [x, y] = EncodeOctahedral(normal);
+                if(settings.normal == NormalEncoding::Octahedral16)
+                {
+                    write_value(normal_dst, quantize_snorm<std::int16_t>(x));
+                    write_value(normal_dst + 2, quantize_snorm<std::int16_t>(y));
+                }
+                else
+                {
+                    write_value(normal_dst, quantize_snorm<std::int8_t>(x));
+                    write_value(normal_dst + 1, quantize_snorm<std::int8_t>(y));
+                }
+            }
+        }
+
+        if(layout.texture_coordinates_offset != VertexLayout::NO_ATTRIBUTE)
+        {
+            std::byte* texture_coordinates_dst = dst + layout.texture_coordinates_offset;
+            for(std::size_t i = 0; i < layout.texture_coordinates_count; i++)
+            {
+                if(settings.texture_coordinates == TextureCoordinatesEncoding::Float32)
+                    write_value(texture_coordinates_dst + i * 4, texture_coordinates[i]);
+                else
+                    write_value(texture_coordinates_dst + i * 2,
+                                FloatToHalf(texture_coordinates[i]));
+            }
+        }
+    }
+
+    EncodedVertices EncodeVertices(const ObjData& obj_data,
+                                   const VertexEncodingSettings& settings,
+                                   std::span<const std::uint32_t> remap,
+                                   std::span<const float> position_normals)
+    {
+        EncodedVertices encoded;
+        encoded.layout = GetVertexLayout(obj_data, settings);
+        encoded.decode = {.position_offset = {0, 0, 0, 0}, .position_scale = {1, 1, 1, 0}};
+
+        const auto& unique_faces = obj_data.GetUniqueFaces();
+        std::size_t vertex_count = unique_faces.size();
+        if(!remap.empty())
+            vertex_count = std::ranges::count_if(remap,
+                                                 [](std::uint32_t index)
+                                                 {
+                                                     return index != UNUSED_VERTEX;
+                                                 });
+
+        std::array<float, 3> min_point = {0, 0, 0};
+        std::array<float, 3> max_point = {0, 0, 0};
+        if(!unique_faces.empty())
+        {
+            const float* first = obj_data.GetVertexByIndex(unique_faces[0].vertex - 1);
+            std::copy_n(first, 3, min_point.begin());
+            std::copy_n(first, 3, max_point.begin());
+            for(const auto& face: unique_faces)
+            {
+                const float* vertex = obj_data.GetVertexByIndex(face.vertex - 1);
+                for(int i = 0; i < 3; i++)
+                {
+                    min_point[i] = std::min(min_point[i], vertex[i]);
+                    max_point[i] = std::max(max_point[i], vertex[i]);
+                }
+            }
+        }
+
+        if(settings.position == PositionEncoding::Unorm16)
+            for(int i = 0; i < 3; i++)
+            {
+                encoded.decode.position_offset[i] = min_point[i];
+                encoded.decode.position_scale[i] = (max_point[i] - min_point[i]) / 65535.0f;
+            }
+
+        FaceType face_type = obj_data.GetSchema().face_type;
+        bool has_normals = (face_type == FaceType::VertexNormal ||
+                            face_type == FaceType::VertexTextureCoordinatesNormal);
+        encoded.data.assign(vertex_count * encoded.layout.stride, std::byte{0});
+        for(std::size_t id = 0; id < unique_faces.size(); id++)
+        {
+            std::size_t index = (remap.empty() ? id : remap[id]);
+            if(index == UNUSED_VERTEX)
+                continue;
+
+            const auto& face = unique_faces[id];
+            const float* normal = nullptr;
+            if(has_normals)
+                normal = obj_data.GetNormalByIndex(face.normal - 1);
+            else if(position_normals.size() >= face.vertex * 3)
+                normal = position_normals.data() + (face.vertex - 1) * 3;
+
+            const float* texture_coordinates = nullptr;
+            if(encoded.layout.texture_coordinates_offset != VertexLayout::NO_ATTRIBUTE)
+                texture_coordinates =
+                    obj_data.GetTextureCoordinatesByIndex(face.texture_coordinates - 1);
+
+            EncodeVertex(encoded.data.data() + index * encoded.layout.stride,
+                         encoded.layout,
+                         settings,
+                         encoded.decode,
+                         obj_data.GetVertexByIndex(face.vertex - 1),
+                         normal,
+                         texture_coordinates);
+        }
+
+        return encoded;
+    }
+};
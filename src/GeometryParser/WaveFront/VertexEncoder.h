@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ObjData.h"
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace GeometryParser
+{
+    enum class PositionEncoding
+    {
+        Float32, //3 x float
+        Unorm16 //4 x unorm16 relative to the mesh bounds, the last one is zero
+    };
+
+    enum class NormalEncoding
+    {
+        None,
+        Float32, //3 x float
+        Octahedral16, //2 x snorm16
+        Octahedral8 //2 x snorm8 + 2 bytes of padding
+    };
+
+    enum class TextureCoordinatesEncoding
+    {
+        None,
+        Float32, //texture_components x float
+        Half //texture_components x half, padded to an even count
+    };
+
+    struct VertexEncodingSettings
+    {
+        PositionEncoding position;
+        NormalEncoding normal;
+        TextureCoordinatesEncoding texture_coordinates;
+        std::size_t stride; //0 means packed, smaller strides are raised to the packed size
+    };
+
+    //std430 uniform block for shaders: position = offset + scale * unorm16
+    struct VertexDecodeParameters
+    {
+        std::array<float, 4> position_offset;
+        std::array<float, 4> position_scale;
+    };
+
+    //attribute offsets are in bytes inside a vertex, NO_ATTRIBUTE if the attribute is absent
+    struct VertexLayout
+    {
+        constexpr static std::size_t NO_ATTRIBUTE = static_cast<std::size_t>(-1);
+
+        std::size_t stride;
+        std::size_t position_offset;
+        std::size_t normal_offset;
+        std::size_t texture_coordinates_offset;
+        std::size_t texture_coordinates_count;
+    };
+
+    struct EncodedVertices
+    {
+        std::vector<std::byte> data;
+        VertexLayout layout;
+        VertexDecodeParameters decode;
+    };
+
+    std::uint16_t FloatToHalf(float value) noexcept;
+
+    //Maps a unit vector onto the octahedron unfolded into [-1, 1]^2.
+    //Shaders decode it with n = (x, y, 1 - |x| - |y|); t = max(-n.z, 0); n.xy -= sign(n.xy) * t.
+    std::array<float, 2> EncodeOctahedral(const float* normal) noexcept;
+
+    //Writes one vertex at dst, normal may be null for a zero normal.
+    //Unorm16 positions are quantized with decode.
+    void EncodeVertex(std::byte* dst,
+                      const VertexLayout& layout,
+                      const VertexEncodingSettings& settings,
+                      const VertexDecodeParameters& decode,
+                      const float* position,
+                      const float* normal,
+                      const float* texture_coordinates) noexcept;
+
+    VertexLayout GetVertexLayout(const ObjData& obj_data,
+                                 const VertexEncodingSettings& settings) noexcept;
+
+    //Encodes one interleaved vertex per unique face id. remap from OptimizeVertexFetch places
+    //ids at their new positions, unused ids are dropped. position_normals (3 floats per v element,
+    //e.g. from CalculateVertexNormals) are used if faces have no normals.
+    EncodedVertices EncodeVertices(const ObjData& obj_data,
+                                   const VertexEncodingSettings& settings,
+                                   std::span<const std::uint32_t> remap = {},
+                                   std::span<const float> position_normals = {});
+};
@@ -0,0 +1,114 @@
+#include "../WaveFront/ObjParserRange.h"
+#include "hrs/test/environment.h"
+#include "hrs/test/tests.h"
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <random>
+
+namespace
+{
+    //A vertex/texture/normal mesh written once per run. Its size in MiB is taken from the
+    //GEOMETRY_PARSER_BENCH_OBJ_MIB environment variable, by default it's large enough to
+    //leave the caches, where stream, read and map modes differ
+    class ObjFileFixture
+    {
+    public:
+        constexpr static std::size_t DEFAULT_SIZE_MIB = 256;
+        //a vertex with its vt/vn lines and two faces
+        constexpr static std::size_t BYTES_PER_VERTEX = 200;
+
+        ObjFileFixture()
+            : path(std::filesystem::temp_directory_path() / "GeometryParserBench.obj")
+        {
+            const std::size_t vertex_count =
+                std::max<std::size_t>(get_size_mib() * 1024 * 1024 / BYTES_PER_VERTEX, 1);
+            const std::size_t face_count = vertex_count * 2;
+
+            std::mt19937 gen(1);
+            std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+            std::uniform_int_distribution<std::size_t> index(1, vertex_count);
+
+            std::ofstream file(path, std::ios::binary);
+            for(std::size_t i = 0; i < vertex_count; i++)
+                file << std::format("v {:.6f} {:.6f} {:.6f}\n", coord(gen), coord(gen), coord(gen));
+
+            for(std::size_t i = 0; i < vertex_count; i++)
+                file << std::format("vt {:.6f} {:.6f}\n", coord(gen) / 100.0f, coord(gen) / 100.0f);
+
+            for(std::size_t i = 0; i < vertex_count; i++)
+                file << std::format("vn {:.6f} {:.6f} {:.6f}\n",
+                                    coord(gen) / 100.0f,
+                                    coord(gen) / 100.0f,
+                                    coord(gen) / 100.0f);
+
+            for(std::size_t i = 0; i < face_count; i++)
+            {
+                std::size_t a = index(gen), b = index(gen), c = index(gen);
+                file << std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, b, c);
+            }
+        }
+
+        ~ObjFileFixture()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+
+        static const std::filesystem::path& GetPath()
+        {
+            static ObjFileFixture fixture;
+            return fixture.path;
+        }
+    private:
+        static std::size_t get_size_mib()
+        {
+            const char* value = std::getenv("GEOMETRY_PARSER_BENCH_OBJ_MIB");
+            if(!value)
+                return DEFAULT_SIZE_MIB;
+
+            char* end;
+            unsigned long long size = std::strtoull(value, &end, 10);
+            if(end == value || *end != '\0' || size == 0)
+                return DEFAULT_SIZE_MIB;
+
+            return static_cast<std::size_t>(size);
+        }
+    private:
+        std::filesystem::path path;
+    };
+
+    //an iteration opens the file and walks every element through Next()
+    void parse_file(hrs::test::bench_state& state, GeometryParser::ObjParserOpenMode mode)
+    {
+        const auto& path = ObjFileFixture::GetPath();
+        while(state.keep_running())
+        {
+            GeometryParser::ObjParserRange rng;
+            if(rng.Open(path, mode) != GeometryParser::Result::Success)
+                HRS_FAIL_TEST("Failed to open the benchmark file!");
+
+            auto exp = rng.Next();
+            for(; exp.has_value(); exp = rng.Next())
+                hrs::test::do_not_optimize(exp.value());
+
+            if(exp.error().result != GeometryParser::Result::EndOfFile)
+                HRS_FAIL_TEST("Failed to parse the benchmark file!");
+        }
+    }
+};
+
+HRS_BENCH(parse_stream, hrs::test::test_config().set_group("ObjParserRange"))
+{
+    parse_file(state, GeometryParser::ObjParserOpenMode::Stream);
+}
+
+HRS_BENCH(parse_read_all, hrs::test::test_config().set_group("ObjParserRange"))
+{
+    parse_file(state, GeometryParser::ObjParserOpenMode::ReadAll);
+}
+
+HRS_BENCH(parse_map, hrs::test::test_config().set_group("ObjParserRange"))
+{
+    parse_file(state, GeometryParser::ObjParserOpenMode::Map);
+}
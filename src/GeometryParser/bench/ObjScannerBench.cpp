@@ -0,0 +1,192 @@
+#include "../WaveFront/ObjScanner.h"
+#include "hrs/test/environment.h"
+#include "hrs/test/tests.h"
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+//Every stage is timed next to what the parser used before the scanner and reports the
+//throughput of its input. Line ends are searched from line to line, like the parser does,
+//and across a span without matches, where the SIMD loop of FindChar runs for the whole span
+namespace
+{
+    struct ScannerFixture
+    {
+        //64 KiB of 'v' lines
+        std::string lines;
+        //64 KiB without line ends
+        std::string span;
+        std::vector<std::string> float_tokens;
+        std::vector<std::string> index_tokens;
+        std::size_t float_token_bytes = 0;
+        std::size_t index_token_bytes = 0;
+
+        ScannerFixture()
+        {
+            std::mt19937 gen(1);
+            std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+            std::uniform_int_distribution<std::uint32_t> index(1, 1'000'000);
+
+            while(lines.size() < 64 * 1024)
+                lines +=
+                    std::format("v {:.6f} {:.6f} {:.6f}\n", coord(gen), coord(gen), coord(gen));
+
+            span.assign(64 * 1024, 'x');
+
+            for(std::size_t i = 0; i < 4096; i++)
+            {
+                float_tokens.push_back(std::format("{:.6f}", coord(gen)));
+                index_tokens.push_back(std::format("{}", index(gen)));
+                float_token_bytes += float_tokens.back().size();
+                index_token_bytes += index_tokens.back().size();
+            }
+        }
+
+        static const ScannerFixture& Get()
+        {
+            static ScannerFixture fixture;
+            return fixture;
+        }
+    };
+
+    template<typename F>
+    std::size_t count_lines(std::string_view data, F&& find)
+    {
+        std::size_t count = 0;
+        for(std::size_t pos = find(data, 0); pos != std::string_view::npos;
+            pos = find(data, pos + 1))
+            count++;
+
+        return count;
+    }
+
+    //an iteration parses every token
+    template<typename F>
+    void parse_tokens(hrs::test::bench_state& state,
+                      const std::vector<std::string>& tokens,
+                      std::size_t token_bytes,
+                      F&& parse)
+    {
+        state.set_bytes_per_iteration(token_bytes);
+        while(state.keep_running())
+            for(const auto& token: tokens)
+                hrs::test::do_not_optimize(parse(token));
+    }
+};
+
+HRS_BENCH(line_ends_find_char, hrs::test::test_config().set_group("ObjScanner"))
+{
+    std::string_view data = ScannerFixture::Get().lines;
+    state.set_bytes_per_iteration(data.size());
+    while(state.keep_running())
+        hrs::test::do_not_optimize(count_lines(data,
+                                               [](std::string_view str, std::size_t pos)
+                                               {
+                                                   return GeometryParser::FindChar(str, '\n', pos);
+                                               }));
+}
+
+HRS_BENCH(line_ends_string_view_find, hrs::test::test_config().set_group("ObjScanner"))
+{
+    std::string_view data = ScannerFixture::Get().lines;
+    state.set_bytes_per_iteration(data.size());
+    while(state.keep_running())
+        hrs::test::do_not_optimize(count_lines(data,
+                                               [](std::string_view str, std::size_t pos)
+                                               {
+                                                   return str.find('\n', pos);
+                                               }));
+}
+
+HRS_BENCH(span_find_char, hrs::test::test_config().set_group("ObjScanner"))
+{
+    std::string_view data = ScannerFixture::Get().span;
+    state.set_bytes_per_iteration(data.size());
+    while(state.keep_running())
+        hrs::test::do_not_optimize(GeometryParser::FindChar(data, '\n'));
+}
+
+HRS_BENCH(span_string_view_find, hrs::test::test_config().set_group("ObjScanner"))
+{
+    std::string_view data = ScannerFixture::Get().span;
+    state.set_bytes_per_iteration(data.size());
+    while(state.keep_running())
+        hrs::test::do_not_optimize(data.find('\n'));
+}
+
+//an iteration splits one 'v' line into its values
+HRS_BENCH(split_obj_split_range, hrs::test::test_config().set_group("ObjScanner"))
+{
+    std::string_view line = "v -12.345678 98.765432 0.500000";
+    state.set_bytes_per_iteration(line.size());
+    while(state.keep_running())
+        for(std::string_view token: GeometryParser::ObjSplitRange(
+                GeometryParser::SkipFirstToken(line, ' '),
+                ' '))
+            hrs::test::do_not_optimize(token);
+}
+
+HRS_BENCH(split_ranges_split_view, hrs::test::test_config().set_group("ObjScanner"))
+{
+    std::string_view line = "v -12.345678 98.765432 0.500000";
+    state.set_bytes_per_iteration(line.size());
+    while(state.keep_running())
+        for(auto token: line | std::views::split(' ') | std::views::drop(1))
+            hrs::test::do_not_optimize(std::string_view(token.begin(), token.end()));
+}
+
+HRS_BENCH(float_fast_parse, hrs::test::test_config().set_group("ObjScanner"))
+{
+    parse_tokens(state,
+                 ScannerFixture::Get().float_tokens,
+                 ScannerFixture::Get().float_token_bytes,
+                 [](std::string_view str)
+                 {
+                     float value = 0.0f;
+                     GeometryParser::FastParseFloat(str, value);
+                     return value;
+                 });
+}
+
+HRS_BENCH(float_from_chars, hrs::test::test_config().set_group("ObjScanner"))
+{
+    parse_tokens(state,
+                 ScannerFixture::Get().float_tokens,
+                 ScannerFixture::Get().float_token_bytes,
+                 [](std::string_view str)
+                 {
+                     float value = 0.0f;
+                     std::from_chars(str.data(), str.data() + str.size(), value);
+                     return value;
+                 });
+}
+
+HRS_BENCH(integer_fast_parse, hrs::test::test_config().set_group("ObjScanner"))
+{
+    parse_tokens(state,
+                 ScannerFixture::Get().index_tokens,
+                 ScannerFixture::Get().index_token_bytes,
+                 [](std::string_view str)
+                 {
+                     std::int64_t value = 0;
+                     GeometryParser::FastParseInteger(str, value);
+                     return value;
+                 });
+}
+
+HRS_BENCH(integer_from_chars, hrs::test::test_config().set_group("ObjScanner"))
+{
+    parse_tokens(state,
+                 ScannerFixture::Get().index_tokens,
+                 ScannerFixture::Get().index_token_bytes,
+                 [](std::string_view str)
+                 {
+                     std::int64_t value = 0;
+                     std::from_chars(str.data(), str.data() + str.size(), value);
+                     return value;
+                 });
+}
@@ -0,0 +1,513 @@
+#include "BytecodeCache.h"
+#include "hrs/hash.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace LuaWay
+{
+    constexpr static char BYTECODE_ENTRY_MAGIC[8] = {'M', 'D', 'E', 'N', 'G', 'L', 'B', 'C'};
+    constexpr static char BYTECODE_ARCHIVE_MAGIC[8] = {'M', 'D', 'E', 'N', 'G', 'L', 'B', 'A'};
+    constexpr static std::uint32_t BYTECODE_CACHE_ENDIANNESS = 0x01020304;
+    //the first byte of every LuaJIT bytecode dump
+    constexpr static char BYTECODE_SIGNATURE = '\x1b';
+
+    //followed by the source path key and the bytecode
+    struct bytecode_entry_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t endianness;
+        std::uint64_t source_size;
+        std::int64_t source_mtime;
+        std::uint64_t source_hash;
+        std::uint64_t path_size;
+        std::uint64_t bytecode_size;
+        std::uint64_t bytecode_hash;
+    };
+
+    //followed by entry_count entries sorted by path_hash and their data
+    struct bytecode_archive_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t endianness;
+        std::uint64_t entry_count;
+    };
+
+    struct bytecode_archive_entry
+    {
+        std::uint64_t path_hash;
+        std::uint64_t source_size;
+        std::int64_t source_mtime;
+        std::uint64_t source_hash;
+        std::uint64_t path_offset;
+        std::uint64_t path_size;
+        std::uint64_t bytecode_offset;
+        std::uint64_t bytecode_size;
+        std::uint64_t bytecode_hash;
+    };
+
+    static_assert(std::is_trivially_copyable_v<bytecode_entry_header>);
+    static_assert(std::is_trivially_copyable_v<bytecode_archive_header>);
+    static_assert(std::is_trivially_copyable_v<bytecode_archive_entry>);
+
+    //the same file must give the same key regardless of the way it's referenced
+    static std::string source_path_key(const std::filesystem::path& path)
+    {
+        std::error_code code;
+        auto canonical = std::filesystem::weakly_canonical(path, code);
+        auto str = (code ? path : canonical).generic_u8string();
+        return std::string(reinterpret_cast<const char*>(str.data()), str.size());
+    }
+
+    static std::int64_t source_mtime(const std::filesystem::file_time_type& time) noexcept
+    {
+        return static_cast<std::int64_t>(time.time_since_epoch().count());
+    }
+
+    static std::span<const std::byte> as_byte_span(std::string_view str) noexcept
+    {
+        return std::as_bytes(std::span(str.data(), str.size()));
+    }
+
+    static std::string_view as_string_view(std::span<const std::byte> bytes) noexcept
+    {
+        return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    //exceptions must not unwind through lua_dump, a non-zero result stops it
+    static int bytecode_writer([[maybe_unused]] lua_State* state,
+                               const void* p,
+                               std::size_t sz,
+                               void* ud) noexcept
+    {
+        try
+        {
+            std::string* out = static_cast<std::string*>(ud);
+            out->append(static_cast<const char*>(p), sz);
+            return 0;
+        }
+        catch(const std::bad_alloc&)
+        {
+            return 1;
+        }
+    }
+
+    //the loader doesn't check bytecode, so broken entries must never reach it
+    static bool load_bytecode(lua_State* state,
+                              std::string_view bytecode,
+                              std::uint64_t bytecode_hash,
+                              const std::string& chunk_name) noexcept
+    {
+        if(bytecode.empty() || bytecode.front() != BYTECODE_SIGNATURE ||
+           hrs::hash_bytes(as_byte_span(bytecode)) != bytecode_hash)
+            return false;
+
+        if(luaL_loadbuffer(state, bytecode.data(), bytecode.size(), chunk_name.c_str()) != 0)
+        {
+            lua_pop(state, 1);
+            return false;
+        }
+
+        return true;
+    }
+
+    //splits an entry file into its header, path key and bytecode
+    static bool parse_entry(std::span<const std::byte> bytes,
+                            bytecode_entry_header& header,
+                            std::string_view& key,
+                            std::string_view& bytecode) noexcept
+    {
+        if(bytes.size() < sizeof(header))
+            return false;
+
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if(std::memcmp(header.magic, BYTECODE_ENTRY_MAGIC, sizeof(BYTECODE_ENTRY_MAGIC)) != 0 ||
+           header.version != BytecodeCache::VERSION ||
+           header.endianness != BYTECODE_CACHE_ENDIANNESS)
+            return false;
+
+        std::uint64_t data_size = bytes.size() - sizeof(header);
+        if(header.path_size > data_size || header.bytecode_size != data_size - header.path_size)
+            return false;
+
+        auto data = as_string_view(bytes.subspan(sizeof(header)));
+        key = data.substr(0, header.path_size);
+        bytecode = data.substr(header.path_size);
+        return true;
+    }
+
+    static bool write_file_atomically(const std::filesystem::path& path, std::string_view data)
+    {
+        //readers of other processes never see a partially written file
+        auto temporary_path = path;
+        temporary_path += ".tmp";
+        {
+            std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+            if(!out.is_open())
+                return false;
+
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if(!out.good())
+            {
+                out.close();
+                std::error_code code;
+                std::filesystem::remove(temporary_path, code);
+                return false;
+            }
+        }
+
+        std::error_code code;
+        std::filesystem::rename(temporary_path, path, code);
+        if(code)
+        {
+            std::filesystem::remove(temporary_path, code);
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    static void append_bytes(std::string& out, const T& value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    BytecodeCache::BytecodeCache(const std::filesystem::path& cache_directory,
+                                 BytecodeCacheValidation _validation)
+        : directory(cache_directory),
+          validation(_validation),
+          statistics{}
+    {
+        //failures show up as write failures
+        std::error_code code;
+        std::filesystem::create_directories(directory, code);
+    }
+
+    int BytecodeCache::Load(lua_State* state, const std::filesystem::path& path)
+    {
+        std::string key = source_path_key(path);
+        std::uint64_t key_hash = hrs::hash_bytes(as_byte_span(key));
+        std::string chunk_name = "@" + path.string();
+
+        if(archive.is_open() && load_archive_entry(state, path, key, key_hash, chunk_name))
+        {
+            statistics.archive_hits++;
+            return 0;
+        }
+
+        if(load_directory_entry(state, path, key, key_hash, chunk_name))
+        {
+            statistics.directory_hits++;
+            return 0;
+        }
+
+        statistics.misses++;
+        //metadata is taken before the contents, a concurrent change only makes the entry outdated
+        std::error_code code;
+        source_info info;
+        info.size = std::filesystem::file_size(path, code);
+        if(!code)
+            info.mtime = source_mtime(std::filesystem::last_write_time(path, code));
+
+        hrs::mapped_file source;
+        if(code || !source.open(path))
+            return luaL_loadfile(state, path.string().c_str()); //reports the error as usual
+
+        std::string_view text = source.get_string_view();
+        std::uint64_t source_hash = hrs::hash_bytes(source.get_bytes());
+        //luaL_loadfile skips the first line if it starts with '#', the newline keeps line numbers
+        if(text.starts_with('#'))
+            text.remove_prefix(std::min(text.find('\n'), text.size()));
+
+        int res = luaL_loadbuffer(state, text.data(), text.size(), chunk_name.c_str());
+        if(res != 0)
+            return res;
+
+        //the chunk is loaded already, a failed write only costs the next load
+        try
+        {
+            std::string bytecode;
+            if(lua_dump(state, bytecode_writer, &bytecode) != 0 ||
+               !write_entry(key, key_hash, info, source_hash, bytecode))
+                statistics.write_failures++;
+        }
+        catch(const std::exception&)
+        {
+            statistics.write_failures++;
+        }
+
+        return 0;
+    }
+
+    bool BytecodeCache::WriteArchive(const std::filesystem::path& archive_path) const
+    {
+        struct packed_entry
+        {
+            bytecode_archive_entry entry;
+            std::string_view key;
+            std::string_view bytecode;
+        };
+
+        std::vector<hrs::mapped_file> files;
+        std::vector<packed_entry> entries;
+        std::error_code code;
+        for(const auto& dir_entry: std::filesystem::directory_iterator(directory, code))
+        {
+            if(!dir_entry.is_regular_file(code) || dir_entry.path().extension() != ".luac")
+                continue;
+
+            hrs::mapped_file file;
+            if(!file.open(dir_entry.path()))
+                continue;
+
+            bytecode_entry_header header;
+            packed_entry packed;
+            if(!parse_entry(file.get_bytes(), header, packed.key, packed.bytecode) ||
+               !is_valid(std::filesystem::path(std::u8string(packed.key.begin(), packed.key.end())),
+                         header.source_size,
+                         header.source_mtime,
+                         header.source_hash))
+                continue;
+
+            packed.entry = {.path_hash = hrs::hash_bytes(as_byte_span(packed.key)),
+                            .source_size = header.source_size,
+                            .source_mtime = header.source_mtime,
+                            .source_hash = header.source_hash,
+                            .path_offset = 0, //assigned once the entries are sorted
+                            .path_size = packed.key.size(),
+                            .bytecode_offset = 0,
+                            .bytecode_size = packed.bytecode.size(),
+                            .bytecode_hash = header.bytecode_hash};
+            entries.push_back(packed);
+            files.push_back(std::move(file));
+        }
+
+        if(code)
+            return false;
+
+        std::sort(entries.begin(),
+                  entries.end(),
+                  [](const packed_entry& a, const packed_entry& b)
+                  {
+                      return a.entry.path_hash < b.entry.path_hash;
+                  });
+
+        std::uint64_t offset =
+            sizeof(bytecode_archive_header) + entries.size() * sizeof(bytecode_archive_entry);
+        for(auto& packed: entries)
+        {
+            packed.entry.path_offset = offset;
+            packed.entry.bytecode_offset = offset + packed.key.size();
+            offset += packed.key.size() + packed.bytecode.size();
+        }
+
+        bytecode_archive_header header = {};
+        std::memcpy(header.magic, BYTECODE_ARCHIVE_MAGIC, sizeof(BYTECODE_ARCHIVE_MAGIC));
+        header.version = VERSION;
+        header.endianness = BYTECODE_CACHE_ENDIANNESS;
+        header.entry_count = entries.size();
+
+        std::string out;
+        out.reserve(offset);
+        append_bytes(out, header);
+        for(const auto& packed: entries)
+            append_bytes(out, packed.entry);
+
+        for(const auto& packed: entries)
+        {
+            out.append(packed.key);
+            out.append(packed.bytecode);
+        }
+
+        return write_file_atomically(archive_path, out);
+    }
+
+    bool BytecodeCache::OpenArchive(const std::filesystem::path& archive_path) noexcept
+    {
+        if(!archive.open(archive_path))
+            return false;
+
+        auto bytes = archive.get_bytes();
+        bytecode_archive_header header;
+        if(bytes.size() < sizeof(header))
+        {
+            archive.close();
+            return false;
+        }
+
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        std::uint64_t max_entry_count =
+            (bytes.size() - sizeof(header)) / sizeof(bytecode_archive_entry);
+        if(std::memcmp(header.magic, BYTECODE_ARCHIVE_MAGIC, sizeof(BYTECODE_ARCHIVE_MAGIC)) != 0 ||
+           header.version != VERSION || header.endianness != BYTECODE_CACHE_ENDIANNESS ||
+           header.entry_count > max_entry_count)
+        {
+            archive.close();
+            return false;
+        }
+
+        //lookups trust the ranges from here on
+        for(std::uint64_t i = 0; i < header.entry_count; i++)
+        {
+            bytecode_archive_entry entry;
+            std::memcpy(&entry,
+                        bytes.data() + sizeof(header) + i * sizeof(entry),
+                        sizeof(entry));
+            if(entry.path_offset > bytes.size() ||
+               entry.path_size > bytes.size() - entry.path_offset ||
+               entry.bytecode_offset > bytes.size() ||
+               entry.bytecode_size > bytes.size() - entry.bytecode_offset)
+            {
+                archive.close();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void BytecodeCache::CloseArchive() noexcept
+    {
+        archive.close();
+    }
+
+    const std::filesystem::path& BytecodeCache::GetDirectory() const noexcept
+    {
+        return directory;
+    }
+
+    const BytecodeCacheStatistics& BytecodeCache::GetStatistics() const noexcept
+    {
+        return statistics;
+    }
+
+    bool BytecodeCache::is_valid(const std::filesystem::path& path,
+                                 std::uint64_t source_size,
+                                 std::int64_t _source_mtime,
+                                 std::uint64_t source_hash) const noexcept
+    {
+        if(validation == BytecodeCacheValidation::None)
+            return true;
+
+        std::error_code code;
+        auto size = std::filesystem::file_size(path, code);
+        if(code || size != source_size)
+            return false;
+
+        auto time = std::filesystem::last_write_time(path, code);
+        if(code || source_mtime(time) != _source_mtime)
+            return false;
+
+        if(validation == BytecodeCacheValidation::Content)
+        {
+            hrs::mapped_file source;
+            if(!source.open(path) || hrs::hash_bytes(source.get_bytes()) != source_hash)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool BytecodeCache::load_archive_entry(lua_State* state,
+                                           const std::filesystem::path& path,
+                                           std::string_view key,
+                                           std::uint64_t key_hash,
+                                           const std::string& chunk_name)
+    {
+        auto bytes = archive.get_bytes();
+        bytecode_archive_header header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        //the table is 8-byte aligned right after the header in the mapping
+        auto entries = std::span(
+            reinterpret_cast<const bytecode_archive_entry*>(bytes.data() + sizeof(header)),
+            static_cast<std::size_t>(header.entry_count));
+        auto it = std::lower_bound(entries.begin(),
+                                   entries.end(),
+                                   key_hash,
+                                   [](const bytecode_archive_entry& entry, std::uint64_t hash)
+                                   {
+                                       return entry.path_hash < hash;
+                                   });
+
+        for(; it != entries.end() && it->path_hash == key_hash; it++)
+        {
+            if(as_string_view(bytes.subspan(it->path_offset, it->path_size)) != key)
+                continue;
+
+            auto bytecode = as_string_view(bytes.subspan(it->bytecode_offset, it->bytecode_size));
+            if(is_valid(path, it->source_size, it->source_mtime, it->source_hash) &&
+               load_bytecode(state, bytecode, it->bytecode_hash, chunk_name))
+                return true;
+
+            statistics.outdated++;
+            return false;
+        }
+
+        return false;
+    }
+
+    bool BytecodeCache::load_directory_entry(lua_State* state,
+                                             const std::filesystem::path& path,
+                                             std::string_view key,
+                                             std::uint64_t key_hash,
+                                             const std::string& chunk_name)
+    {
+        hrs::mapped_file file;
+        if(!file.open(get_entry_path(key_hash)))
+            return false;
+
+        bytecode_entry_header header;
+        std::string_view stored_key;
+        std::string_view bytecode;
+        if(parse_entry(file.get_bytes(), header, stored_key, bytecode) && stored_key == key &&
+           is_valid(path, header.source_size, header.source_mtime, header.source_hash) &&
+           load_bytecode(state, bytecode, header.bytecode_hash, chunk_name))
+            return true;
+
+        statistics.outdated++;
+        return false;
+    }
+
+    bool BytecodeCache::write_entry(std::string_view key,
+                                    std::uint64_t key_hash,
+                                    const source_info& info,
+                                    std::uint64_t source_hash,
+                                    std::string_view bytecode) const
+    {
+        bytecode_entry_header header = {};
+        std::memcpy(header.magic, BYTECODE_ENTRY_MAGIC, sizeof(BYTECODE_ENTRY_MAGIC));
+        header.version = VERSION;
+        header.endianness = BYTECODE_CACHE_ENDIANNESS;
+        header.source_size = info.size;
+        header.source_mtime = info.mtime;
+        header.source_hash = source_hash;
+        header.path_size = key.size();
+        header.bytecode_size = bytecode.size();
+        header.bytecode_hash = hrs::hash_bytes(as_byte_span(bytecode));
+
+        std::string out;
+        out.reserve(sizeof(header) + key.size() + bytecode.size());
+        append_bytes(out, header);
+        out.append(key);
+        out.append(bytecode);
+        return write_file_atomically(get_entry_path(key_hash), out);
+    }
+
+    std::filesystem::path BytecodeCache::get_entry_path(std::uint64_t key_hash) const
+    {
+        constexpr static char DIGITS[] = "0123456789abcdef";
+        std::string name(16, '0');
+        for(std::size_t i = 0; i < name.size(); i++)
+            name[name.size() - 1 - i] = DIGITS[(key_hash >> (i * 4)) & 0xF];
+
+        return directory / (name + ".luac");
+    }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "hrs/mapped_file.hpp"
+#include "hrs/non_creatable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <lua.hpp>
+#include <string>
+#include <string_view>
+
+namespace LuaWay
+{
+    enum class BytecodeCacheValidation
+    {
+        None, //trust the cache, the source isn't touched on a hit
+        Metadata, //source size and modification time
+        Content //metadata and hash of the source file contents
+    };
+
+    struct BytecodeCacheStatistics
+    {
+        std::size_t archive_hits;
+        std::size_t directory_hits;
+        std::size_t misses; //compiled from source
+        std::size_t outdated; //entries rejected by validation, their hash or the loader
+        std::size_t write_failures;
+    };
+
+    //Compiled chunks of source files stored in a directory, one entry file per source path.
+    //An entry holds the source metadata and the output of lua_dump, a hit is a single
+    //luaL_loadbuffer of the mapped entry. Entries that fail validation, their hash or the
+    //loader (e.g. bytecode of another LuaJIT build) are compiled again and rewritten.
+    //Entries can be packed into one archive that is mapped once and searched before
+    //the directory. The hash only catches damaged files, the cache must be trusted.
+    //The cache isn't synchronized, VMs of different threads need their own caches.
+    class BytecodeCache : public hrs::non_copyable
+    {
+    public:
+        constexpr static std::uint32_t VERSION = 1;
+
+        BytecodeCache(const std::filesystem::path& cache_directory,
+                      BytecodeCacheValidation validation);
+        ~BytecodeCache() = default;
+        BytecodeCache(BytecodeCache&&) = default;
+        BytecodeCache& operator=(BytecodeCache&&) = default;
+
+        //the same contract as luaL_loadfile: pushes the chunk or an error message.
+        //Filesystem and allocation failures before the chunk is loaded are thrown
+        int Load(lua_State* state, const std::filesystem::path& path);
+
+        //packs all valid entries of the directory
+        bool WriteArchive(const std::filesystem::path& archive_path) const;
+        bool OpenArchive(const std::filesystem::path& archive_path) noexcept;
+        void CloseArchive() noexcept;
+
+        const std::filesystem::path& GetDirectory() const noexcept;
+        const BytecodeCacheStatistics& GetStatistics() const noexcept;
+    private:
+        struct source_info
+        {
+            std::uint64_t size;
+            std::int64_t mtime;
+        };
+
+        bool is_valid(const std::filesystem::path& path,
+                      std::uint64_t source_size,
+                      std::int64_t source_mtime,
+                      std::uint64_t source_hash) const noexcept;
+        bool load_archive_entry(lua_State* state,
+                                const std::filesystem::path& path,
+                                std::string_view key,
+                                std::uint64_t key_hash,
+                                const std::string& chunk_name);
+        bool load_directory_entry(lua_State* state,
+                                  const std::filesystem::path& path,
+                                  std::string_view key,
+                                  std::uint64_t key_hash,
+                                  const std::string& chunk_name);
+        bool write_entry(std::string_view key,
+                         std::uint64_t key_hash,
+                         const source_info& info,
+                         std::uint64_t source_hash,
+                         std::string_view bytecode) const;
+        std::filesystem::path get_entry_path(std::uint64_t key_hash) const;
+    private:
+        std::filesystem::path directory;
+        BytecodeCacheValidation validation;
+        hrs::mapped_file archive;
+        BytecodeCacheStatistics statistics;
+    };
+};
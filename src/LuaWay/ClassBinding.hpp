@@ -0,0 +1,519 @@
+#pragma once
+
+#include "NativeType.h"
+#include "Ref.h"
+#include "VMBase.h"
+#include "hrs/debug.hpp"
+#include "hrs/function_traits.hpp"
+#include "hrs/member_class.hpp"
+#include "hrs/meta/reflexpr.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <string_view>
+#include <tuple>
+
+//Generates Lua bindings for classes described with HRS_REFL_BEGIN/HRS_REFL_END.
+//Objects live inline in userdata, methods are C closures with the class metatable cached in
+//the first upvalue, so the self check is one lua_rawequal. Arguments of numbers, strings
+//and bound classes are read with direct lua_to* calls.
+//Fields of bound class types are read as references: a userdata with a pointer into the
+//owner and the reference metatable of the class, the owner is kept in its environment.
+//Wrappers aren't noexcept: LuaJIT raises errors by unwinding through them.
+namespace LuaWay
+{
+    //specialize as true to move a reflected class by value as a table of its data fields
+    //(see Containers.hpp) instead of binding it as userdata, a class has one representation
+    template<typename C>
+    constexpr bool table_struct = false;
+
+    template<typename C>
+    concept BindableClass = std::is_class_v<C> && (hrs::reflexpr<C>::name.size != 0) &&
+                            (alignof(C) <= alignof(double)) && !table_struct<C>;
+
+    namespace detail
+    {
+        //its address is the registry key of the class metatable
+        template<typename C>
+        struct class_binding_tag
+        {
+            constexpr static char key = 0;
+        };
+
+        template<typename C>
+        struct class_reference_binding_tag
+        {
+            constexpr static char key = 0;
+        };
+
+        template<typename C>
+        void push_class_metatable(lua_State* state) noexcept
+        {
+            lua_pushlightuserdata(state, const_cast<char*>(&class_binding_tag<C>::key));
+            lua_rawget(state, LUA_REGISTRYINDEX);
+        }
+
+        template<typename C>
+        void push_class_reference_metatable(lua_State* state) noexcept
+        {
+            lua_pushlightuserdata(state, const_cast<char*>(&class_reference_binding_tag<C>::key));
+            lua_rawget(state, LUA_REGISTRYINDEX);
+        }
+
+        template<hrs::static_string name>
+        void push_static_string(lua_State* state) noexcept
+        {
+            lua_pushlstring(state, name.begin(), name.size);
+        }
+
+        //static_string isn't null-terminated
+        template<typename C>
+        constexpr auto class_name = []()
+        {
+            constexpr auto name = hrs::reflexpr<C>::name;
+            std::array<char, name.size + 1> out{};
+            std::copy(name.begin(), name.end(), out.begin());
+            return out;
+        }();
+
+        [[noreturn]] inline void argument_error(lua_State* state, int index, const char* expected)
+        {
+            luaL_error(state,
+                       "bad argument #%d (%s expected, got %s)",
+                       index,
+                       expected,
+                       lua_typename(state, lua_type(state, index)));
+            hrs::assert_true_debug(false, "luaL_error has returned!");
+            std::abort();
+        }
+
+        //metatable_index is the stack or upvalue index of the metatable of C,
+        //references to C are accepted as well
+        template<typename C>
+        C* check_object(lua_State* state, int index, int metatable_index)
+        {
+            void* data = lua_touserdata(state, index);
+            if(data && lua_getmetatable(state, index))
+            {
+                if(lua_rawequal(state, -1, metatable_index))
+                {
+                    lua_pop(state, 1);
+                    return static_cast<C*>(data);
+                }
+
+                push_class_reference_metatable<C>(state);
+                bool reference = lua_rawequal(state, -1, -2);
+                lua_pop(state, 2);
+                if(reference)
+                    return *static_cast<C**>(data);
+            }
+
+            argument_error(state, index, class_name<C>.data());
+        }
+
+        template<typename C>
+        C* check_object(lua_State* state, int index)
+        {
+            push_class_metatable<C>(state);
+            C* obj = check_object<C>(state, index, lua_gettop(state));
+            lua_pop(state, 1);
+            return obj;
+        }
+
+        template<typename T>
+        decltype(auto) check_argument(lua_State* state, int index)
+        {
+            using U = std::remove_cvref_t<T>;
+            using P = std::remove_cv_t<std::remove_pointer_t<U>>;
+            if constexpr(std::is_pointer_v<U> && BindableClass<P>)
+            {
+                if(lua_isnil(state, index))
+                    return static_cast<U>(nullptr);
+
+                return static_cast<U>(check_object<P>(state, index));
+            }
+            else if constexpr(BindableClass<U>)
+            {
+                if constexpr(std::is_reference_v<T>)
+                    return static_cast<T>(*check_object<U>(state, index));
+                else
+                    return U(*check_object<U>(state, index));
+            }
+            else if constexpr(std::same_as<U, bool>)
+                return static_cast<bool>(lua_toboolean(state, index));
+            else if constexpr(std::is_arithmetic_v<U>)
+            {
+                //lua_tonumber returns 0 for non-numbers, so only 0 needs a second look
+                lua_Number value = lua_tonumber(state, index);
+                if(value == 0 && !lua_isnumber(state, index))
+                    argument_error(state, index, "number");
+
+                return static_cast<U>(value);
+            }
+            else if constexpr(std::same_as<U, const char*>)
+            {
+                const char* str = lua_tolstring(state, index, nullptr);
+                if(!str)
+                    argument_error(state, index, "string");
+
+                return str;
+            }
+            else if constexpr(std::same_as<U, std::string_view> || std::same_as<U, String>)
+            {
+                std::size_t len;
+                const char* str = lua_tolstring(state, index, &len);
+                if(!str)
+                    argument_error(state, index, "string");
+
+                return U(str, len);
+            }
+            else
+            {
+                static_assert(Retrievable<U>, "Argument type must be Retrievable!");
+                if(!Stack<U>::ConvertibleFromVm(LuaWay::GetType(state, index)))
+                    argument_error(state, index, "convertible value");
+
+                return Stack<U>::Retrieve(state, index);
+            }
+        }
+
+        template<BindableClass C, typename... Args>
+        void push_object(lua_State* state, Args&&... args)
+        {
+            void* data = lua_newuserdata(state, sizeof(C));
+            new(data) C(std::forward<Args>(args)...);
+            push_class_metatable<C>(state);
+            lua_setmetatable(state, -2);
+        }
+
+        //obj aliases a part of the value at owner_index, which stays alive while the reference does
+        template<BindableClass C>
+        void push_reference(lua_State* state, C* obj, int owner_index)
+        {
+            *static_cast<C**>(lua_newuserdata(state, sizeof(C*))) = obj;
+            push_class_reference_metatable<C>(state);
+            lua_setmetatable(state, -2);
+            lua_createtable(state, 1, 0);
+            lua_pushvalue(state, owner_index);
+            lua_rawseti(state, -2, 1);
+            lua_setfenv(state, -2);
+        }
+
+        template<typename T>
+        void push_result(lua_State* state, T&& value)
+        {
+            using U = std::remove_cvref_t<T>;
+            if constexpr(BindableClass<U>)
+                push_object<U>(state, std::forward<T>(value));
+            else if constexpr(std::same_as<U, bool>)
+                lua_pushboolean(state, value);
+            else if constexpr(std::is_arithmetic_v<U>)
+                lua_pushnumber(state, static_cast<lua_Number>(value));
+            else if constexpr(std::same_as<U, const char*> || std::same_as<U, char*>)
+                lua_pushstring(state, value);
+            else if constexpr(std::same_as<U, std::string_view> || std::same_as<U, String>)
+                lua_pushlstring(state, value.data(), value.size());
+            else
+            {
+                static_assert(Pushable<U>, "Return type must be Pushable!");
+                Stack<U>::Push(state, std::forward<T>(value));
+            }
+        }
+
+        template<typename R, typename F, typename... Args, std::size_t... Indices>
+        int invoke_bound(lua_State* state,
+                         int first_argument,
+                         F&& func,
+                         hrs::variadic<Args...>,
+                         std::index_sequence<Indices...>)
+        {
+            if constexpr(std::same_as<R, void>)
+            {
+                std::forward<F>(func)(
+                    check_argument<Args>(state, first_argument + static_cast<int>(Indices))...);
+                return 0;
+            }
+            else
+            {
+                push_result(state,
+                            std::forward<F>(func)(check_argument<Args>(
+                                state,
+                                first_argument + static_cast<int>(Indices))...));
+                return 1;
+            }
+        }
+
+        //upvalue 1 - class metatable
+        template<BindableClass C, auto method>
+        int bound_method_wrapper(lua_State* state)
+        {
+            using traits = hrs::function_traits<hrs::member_class_type_field_t<decltype(method)>>;
+
+            C* self = check_object<C>(state, 1, lua_upvalueindex(1));
+            return invoke_bound<typename traits::return_type>(
+                state,
+                2,
+                [self]<typename... Args>(Args&&... args) -> decltype(auto)
+                { return (self->*method)(std::forward<Args>(args)...); },
+                typename traits::arguments{},
+                std::make_index_sequence<traits::arguments::COUNT>{});
+        }
+
+        template<auto func>
+        int bound_function_wrapper(lua_State* state)
+        {
+            using traits = hrs::function_traits<std::remove_pointer_t<decltype(func)>>;
+
+            return invoke_bound<typename traits::return_type>(
+                state,
+                1,
+                func,
+                typename traits::arguments{},
+                std::make_index_sequence<traits::arguments::COUNT>{});
+        }
+
+        template<BindableClass C, typename... Args>
+        int bound_constructor_wrapper(lua_State* state)
+        {
+            [state]<std::size_t... Indices>(std::index_sequence<Indices...>)
+            {
+                push_object<C>(state,
+                               check_argument<Args>(state, static_cast<int>(Indices) + 1)...);
+            }(std::make_index_sequence<sizeof...(Args)>{});
+
+            return 1;
+        }
+
+        template<BindableClass C>
+        int bound_destructor_wrapper(lua_State* state)
+        {
+            static_cast<C*>(lua_touserdata(state, 1))->~C();
+            return 0;
+        }
+
+        template<typename Field>
+        constexpr bool is_method_field =
+            std::is_function_v<
+                hrs::member_class_type_field_t<std::remove_cv_t<decltype(Field::ptr)>>>;
+
+        template<typename Field>
+        constexpr bool is_function_field = std::is_function_v<typename Field::type>;
+
+        template<typename Field>
+        constexpr bool is_field_name(std::string_view name) noexcept
+        {
+            return std::string_view(Field::name.begin(), Field::name.size) == name;
+        }
+
+        //the object is at index 1, mutable fields of bound classes are pushed as references,
+        //const ones as copies
+        template<typename Field, typename C>
+        bool push_field(lua_State* state, C* self, std::string_view name)
+        {
+            if(!is_field_name<Field>(name))
+                return false;
+
+            using T = typename Field::type;
+            if constexpr(std::is_const_v<T>)
+                push_result(state, self->*Field::ptr);
+            else if constexpr(BindableClass<T>)
+                push_reference<T>(state, &(self->*Field::ptr), 1);
+            else
+                push_result(state, self->*Field::ptr);
+
+            return true;
+        }
+
+        //the value is at index 3, const fields are read-only
+        template<typename Field, typename C>
+        bool assign_field(lua_State* state, C* self, std::string_view name)
+        {
+            if(!is_field_name<Field>(name))
+                return false;
+
+            if constexpr(std::is_const_v<typename Field::type>)
+                luaL_error(state, "%s field '%s' is read-only", class_name<C>.data(), name.data());
+            else
+                self->*Field::ptr = check_argument<typename Field::type>(state, 3);
+
+            return true;
+        }
+
+        //upvalue 1 - class metatable, upvalue 2 - methods
+        template<BindableClass C, typename... Fields>
+        int bound_index_wrapper(lua_State* state)
+        {
+            //obj, key
+            lua_pushvalue(state, 2);
+            lua_rawget(state, lua_upvalueindex(2));
+            if(!lua_isnil(state, -1))
+                return 1;
+
+            lua_pop(state, 1);
+            std::size_t len;
+            const char* key = lua_tolstring(state, 2, &len);
+            if(!key)
+                return 0;
+
+            C* self = check_object<C>(state, 1, lua_upvalueindex(1));
+            std::string_view name(key, len);
+            bool found = (push_field<Fields>(state, self, name) || ...);
+
+            return (found ? 1 : 0);
+        }
+
+        //upvalue 1 - class metatable
+        template<BindableClass C, typename... Fields>
+        int bound_new_index_wrapper(lua_State* state)
+        {
+            //obj, key, value
+            C* self = check_object<C>(state, 1, lua_upvalueindex(1));
+            std::size_t len;
+            const char* key = lua_tolstring(state, 2, &len);
+            std::string_view name(key ? key : "", key ? len : 0);
+            bool found = (assign_field<Fields>(state, self, name) || ...);
+
+            if(!found)
+                luaL_error(state, "%s has no field '%s'", class_name<C>.data(), key);
+
+            return 0;
+        }
+
+        template<typename... Fields>
+        auto filter_method_fields(hrs::variadic<Fields...>) noexcept
+        {
+            return (std::conditional_t<is_method_field<Fields>,
+                                       hrs::variadic<Fields>,
+                                       hrs::variadic<>>{} +
+                    ... + hrs::variadic<>{});
+        }
+
+        template<typename... Fields>
+        auto filter_data_fields(hrs::variadic<Fields...>) noexcept
+        {
+            return (std::conditional_t<!is_method_field<Fields>,
+                                       hrs::variadic<Fields>,
+                                       hrs::variadic<>>{} +
+                    ... + hrs::variadic<>{});
+        }
+
+        template<typename... Fields>
+        auto filter_function_fields(hrs::variadic<Fields...>) noexcept
+        {
+            return (std::conditional_t<is_function_field<Fields>,
+                                       hrs::variadic<Fields>,
+                                       hrs::variadic<>>{} +
+                    ... + hrs::variadic<>{});
+        }
+    };
+
+    //Creates the metatable of C and a global table named after C with a new(Args...)
+    //constructor and the static functions of C. Member functions become methods and
+    //member variables become fields, const ones are read-only, parent classes aren't walked.
+    //Returns the class table
+    template<BindableClass C, typename... ConstructorArgs>
+    requires std::constructible_from<C, ConstructorArgs...>
+    Ref BindClass(const VMBase& vm)
+    {
+        using meta = hrs::reflexpr<C>;
+        using methods = decltype(detail::filter_method_fields(typename meta::member_fields{}));
+        using fields = decltype(detail::filter_data_fields(typename meta::member_fields{}));
+        using functions =
+            decltype(detail::filter_function_fields(typename meta::static_fields{}));
+
+        lua_State* state = vm.GetState();
+        //metatable
+        lua_newtable(state);
+        int metatable = lua_gettop(state);
+        lua_pushlightuserdata(state, const_cast<char*>(&detail::class_binding_tag<C>::key));
+        lua_pushvalue(state, metatable);
+        lua_rawset(state, LUA_REGISTRYINDEX);
+
+        //methods
+        lua_newtable(state);
+        int method_table = lua_gettop(state);
+        [&]<typename... Methods>(hrs::variadic<Methods...>)
+        {
+            ((detail::push_static_string<Methods::name>(state),
+              lua_pushvalue(state, metatable),
+              lua_pushcclosure(state, detail::bound_method_wrapper<C, Methods::ptr>, 1),
+              lua_rawset(state, method_table)),
+             ...);
+        }(methods{});
+
+        lua_pushliteral(state, "__index");
+        if constexpr(fields::COUNT == 0)
+            lua_pushvalue(state, method_table);
+        else
+            [&]<typename... Fields>(hrs::variadic<Fields...>)
+            {
+                lua_pushvalue(state, metatable);
+                lua_pushvalue(state, method_table);
+                lua_pushcclosure(state, detail::bound_index_wrapper<C, Fields...>, 2);
+                lua_rawset(state, metatable);
+
+                lua_pushliteral(state, "__newindex");
+                lua_pushvalue(state, metatable);
+                lua_pushcclosure(state, detail::bound_new_index_wrapper<C, Fields...>, 1);
+            }(fields{});
+
+        lua_rawset(state, metatable);
+
+        //references share __index and __newindex, they don't own the object
+        lua_newtable(state);
+        int reference_metatable = lua_gettop(state);
+        lua_pushlightuserdata(state,
+                              const_cast<char*>(&detail::class_reference_binding_tag<C>::key));
+        lua_pushvalue(state, reference_metatable);
+        lua_rawset(state, LUA_REGISTRYINDEX);
+        for(const char* event: {"__index", "__newindex"})
+        {
+            lua_pushstring(state, event);
+            lua_pushvalue(state, -1);
+            lua_rawget(state, metatable);
+            lua_rawset(state, reference_metatable);
+        }
+
+        lua_pop(state, 1);
+
+        if constexpr(!std::is_trivially_destructible_v<C>)
+        {
+            lua_pushliteral(state, "__gc");
+            lua_pushcfunction(state, detail::bound_destructor_wrapper<C>);
+            lua_rawset(state, metatable);
+        }
+
+        lua_pop(state, 2);
+
+        //class table
+        lua_newtable(state);
+        int class_table = lua_gettop(state);
+        lua_pushliteral(state, "new");
+        lua_pushcfunction(state, (detail::bound_constructor_wrapper<C, ConstructorArgs...>));
+        lua_rawset(state, class_table);
+
+        [&]<typename... Functions>(hrs::variadic<Functions...>)
+        {
+            ((detail::push_static_string<Functions::name>(state),
+              lua_pushcfunction(state, detail::bound_function_wrapper<Functions::ptr>),
+              lua_rawset(state, class_table)),
+             ...);
+        }(functions{});
+
+        detail::push_static_string<meta::name>(state);
+        lua_pushvalue(state, class_table);
+        lua_settable(state, LUA_GLOBALSINDEX);
+
+        Ref class_ref = Stack<Ref>::Retrieve(state, class_table);
+        lua_pop(state, 1);
+        return class_ref;
+    }
+
+    //copies or moves obj into a new userdata of the bound class C and pushes it
+    template<typename C>
+    requires BindableClass<std::remove_cvref_t<C>>
+    void PushObject(lua_State* state, C&& obj)
+    {
+        detail::push_object<std::remove_cvref_t<C>>(state, std::forward<C>(obj));
+    }
+};
@@ -0,0 +1,499 @@
+#pragma once
+
+#include "ClassBinding.hpp"
+#include <array>
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+//Stack specializations that move whole containers in one pass.
+//Tables are created with exact sizes and filled with raw sets, elements of arithmetic types,
+//bools and strings skip Stack with direct lua_push*/lua_to* calls.
+//Retrieved elements that can't be converted are value-initialized, map pairs are dropped.
+//ArrayView is the zero-copy alternative for large numeric arrays.
+namespace LuaWay
+{
+    //reflected classes marked with table_struct are moved as tables of their data fields,
+    //the others are bound as userdata by ClassBinding.hpp
+    template<typename C>
+    concept TableStruct = table_struct<C> && std::is_class_v<C> &&
+                          (hrs::reflexpr<C>::name.size != 0) && std::is_default_constructible_v<C>;
+
+    //Userdata over C++ memory, the memory must outlive every use of the view by scripts.
+    //Lua side: view[i] with 1-based i, #view, view.data is a light userdata for ffi.cast.
+    //Views of const elements raise errors on writes
+    template<typename T>
+    requires std::is_arithmetic_v<std::remove_const_t<T>>
+    struct ArrayView
+    {
+        T* data;
+        std::size_t size;
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        void push_element(lua_State* state, const T& value)
+        {
+            if constexpr(std::same_as<T, bool>)
+                lua_pushboolean(state, value);
+            else if constexpr(std::is_arithmetic_v<T>)
+                lua_pushnumber(state, static_cast<lua_Number>(value));
+            else if constexpr(std::same_as<T, String> || std::same_as<T, std::string_view>)
+                lua_pushlstring(state, value.data(), value.size());
+            else
+            {
+                static_assert(Pushable<T>, "Element type must be Pushable!");
+                Stack<T>::Push(state, value);
+            }
+        }
+
+        template<typename T>
+        bool retrieve_element(lua_State* state, int index, T& out)
+        {
+            if constexpr(std::same_as<T, bool>)
+            {
+                if(lua_type(state, index) != LUA_TBOOLEAN)
+                    return false;
+
+                out = lua_toboolean(state, index);
+            }
+            else if constexpr(std::is_arithmetic_v<T>)
+            {
+                //lua_tonumber returns 0 for non-numbers, so only 0 needs a second look
+                lua_Number value = lua_tonumber(state, index);
+                if(value == 0 && !lua_isnumber(state, index))
+                    return false;
+
+                out = static_cast<T>(value);
+            }
+            else if constexpr(std::same_as<T, String>)
+            {
+                //lua_tolstring converts numbers in place, that breaks lua_next over keys
+                if(lua_type(state, index) != LUA_TSTRING)
+                    return false;
+
+                std::size_t len;
+                const char* str = lua_tolstring(state, index, &len);
+                out.assign(str, len);
+            }
+            else
+            {
+                static_assert(Retrievable<T>, "Element type must be Retrievable!");
+                if(!Stack<T>::ConvertibleFromVm(LuaWay::GetType(state, index)))
+                    return false;
+
+                out = Stack<T>::Retrieve(state, index);
+            }
+
+            return true;
+        }
+
+        template<typename T>
+        void push_array(lua_State* state, std::span<const T> values)
+        {
+            lua_createtable(state, static_cast<int>(values.size()), 0);
+            for(std::size_t i = 0; i < values.size(); i++)
+            {
+                push_element(state, values[i]);
+                lua_rawseti(state, -2, static_cast<int>(i + 1));
+            }
+        }
+
+        template<typename M>
+        void push_map(lua_State* state, const M& map)
+        {
+            lua_createtable(state, 0, static_cast<int>(map.size()));
+            for(const auto& [key, value]: map)
+            {
+                push_element(state, key);
+                push_element(state, value);
+                lua_rawset(state, -3);
+            }
+        }
+
+        template<typename M>
+        M retrieve_map(lua_State* state, int index)
+        {
+            if(index < 0 && index > LUA_REGISTRYINDEX)
+                index = lua_gettop(state) + index + 1;
+
+            M map;
+            lua_pushnil(state);
+            while(lua_next(state, index))
+            {
+                typename M::key_type key{};
+                typename M::mapped_type value{};
+                if(retrieve_element(state, -2, key) && retrieve_element(state, -1, value))
+                    map.insert_or_assign(std::move(key), std::move(value));
+
+                lua_pop(state, 1);
+            }
+
+            return map;
+        }
+
+        template<typename... Fields>
+        auto filter_table_fields(hrs::variadic<Fields...>) noexcept
+        {
+            return (std::conditional_t<!is_method_field<Fields> && !is_function_field<Fields>,
+                                       hrs::variadic<Fields>,
+                                       hrs::variadic<>>{} +
+                    ... + hrs::variadic<>{});
+        }
+
+        template<typename C>
+        using table_fields =
+            decltype(filter_table_fields(typename hrs::reflexpr<C>::member_fields{}));
+
+        //its address is the registry key of the view metatable
+        template<typename T>
+        struct array_view_tag
+        {
+            constexpr static char key = 0;
+        };
+
+        template<typename T>
+        ArrayView<T>* check_array_view(lua_State* state, int index)
+        {
+            void* data = lua_touserdata(state, index);
+            if(data && lua_getmetatable(state, index))
+            {
+                lua_pushlightuserdata(state, const_cast<char*>(&array_view_tag<T>::key));
+                lua_rawget(state, LUA_REGISTRYINDEX);
+                bool same = lua_rawequal(state, -1, -2);
+                lua_pop(state, 2);
+                if(same)
+                    return static_cast<ArrayView<T>*>(data);
+            }
+
+            return nullptr;
+        }
+
+        //upvalue 1 - view metatable, so the self check is one lua_rawequal
+        template<typename T>
+        ArrayView<T>* check_view_self(lua_State* state)
+        {
+            void* data = lua_touserdata(state, 1);
+            if(data && lua_getmetatable(state, 1))
+            {
+                bool same = lua_rawequal(state, -1, lua_upvalueindex(1));
+                lua_pop(state, 1);
+                if(same)
+                    return static_cast<ArrayView<T>*>(data);
+            }
+
+            argument_error(state, 1, "array view");
+        }
+
+        //the 1-based key at index 2 if it's an integer in [1, size], 0 otherwise,
+        //lua_tointegerx truncates fractions, so the result is compared with the number
+        inline std::size_t array_view_index(lua_State* state, std::size_t size) noexcept
+        {
+            int is_number = 0;
+            lua_Integer index = lua_tointegerx(state, 2, &is_number);
+            if(!is_number || static_cast<lua_Number>(index) != lua_tonumber(state, 2) ||
+               index < 1 || static_cast<std::size_t>(index) > size)
+                return 0;
+
+            return static_cast<std::size_t>(index);
+        }
+
+        template<typename T>
+        int array_view_index_wrapper(lua_State* state)
+        {
+            ArrayView<T>* view = check_view_self<T>(state);
+            if(lua_type(state, 2) == LUA_TNUMBER)
+            {
+                std::size_t index = array_view_index(state, view->size);
+                if(index != 0)
+                {
+                    push_element(state, view->data[index - 1]);
+                    return 1;
+                }
+
+                return 0;
+            }
+
+            std::size_t len;
+            const char* key = lua_tolstring(state, 2, &len);
+            if(key && std::string_view(key, len) == "data")
+            {
+                lua_pushlightuserdata(state, const_cast<std::remove_const_t<T>*>(view->data));
+                return 1;
+            }
+
+            return 0;
+        }
+
+        template<typename T>
+        int array_view_new_index_wrapper(lua_State* state)
+        {
+            ArrayView<T>* view = check_view_self<T>(state);
+            if constexpr(std::is_const_v<T>)
+                luaL_error(state, "array view is read-only");
+            else
+            {
+                if(lua_type(state, 2) != LUA_TNUMBER)
+                    argument_error(state, 2, "integer");
+
+                std::size_t index = array_view_index(state, view->size);
+                if(index == 0)
+                    luaL_error(state, "array view index must be an integer in [1, #view]");
+
+                view->data[index - 1] = check_argument<T>(state, 3);
+            }
+
+            return 0;
+        }
+
+        template<typename T>
+        int array_view_length_wrapper(lua_State* state)
+        {
+            lua_pushnumber(state, static_cast<lua_Number>(check_view_self<T>(state)->size));
+            return 1;
+        }
+
+        template<typename T>
+        void push_array_view_metatable(lua_State* state)
+        {
+            lua_pushlightuserdata(state, const_cast<char*>(&array_view_tag<T>::key));
+            lua_rawget(state, LUA_REGISTRYINDEX);
+            if(!lua_isnil(state, -1))
+                return;
+
+            lua_pop(state, 1);
+            lua_createtable(state, 0, 3);
+            int metatable = lua_gettop(state);
+            auto set_method = [&](const char* name, lua_CFunction func)
+            {
+                lua_pushvalue(state, metatable);
+                lua_pushcclosure(state, func, 1);
+                lua_setfield(state, metatable, name);
+            };
+
+            set_method("__index", array_view_index_wrapper<T>);
+            set_method("__newindex", array_view_new_index_wrapper<T>);
+            set_method("__len", array_view_length_wrapper<T>);
+
+            lua_pushlightuserdata(state, const_cast<char*>(&array_view_tag<T>::key));
+            lua_pushvalue(state, metatable);
+            lua_rawset(state, LUA_REGISTRYINDEX);
+        }
+    };
+
+    template<typename T, typename A>
+    struct Stack<std::vector<T, A>>
+    {
+        using Type = std::vector<T, A>;
+
+        static void Push(lua_State* state, const Type& value)
+        {
+            if constexpr(std::same_as<T, bool>)
+            {
+                //vector<bool> isn't contiguous
+                lua_createtable(state, static_cast<int>(value.size()), 0);
+                for(std::size_t i = 0; i < value.size(); i++)
+                {
+                    lua_pushboolean(state, value[i]);
+                    lua_rawseti(state, -2, static_cast<int>(i + 1));
+                }
+            }
+            else
+                detail::push_array<T>(state, value);
+        }
+
+        static Type Retrieve(lua_State* state, int index)
+        {
+            std::size_t size = lua_objlen(state, index);
+            Type out(size);
+            for(std::size_t i = 0; i < size; i++)
+            {
+                lua_rawgeti(state, index, static_cast<int>(i + 1));
+                if constexpr(std::same_as<T, bool>)
+                    out[i] = lua_toboolean(state, -1);
+                else
+                    detail::retrieve_element(state, -1, out[i]);
+
+                lua_pop(state, 1);
+            }
+
+            return out;
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::Table;
+        }
+    };
+
+    template<typename T, std::size_t N>
+    struct Stack<std::array<T, N>>
+    {
+        using Type = std::array<T, N>;
+
+        static void Push(lua_State* state, const Type& value)
+        {
+            detail::push_array<T>(state, value);
+        }
+
+        static Type Retrieve(lua_State* state, int index)
+        {
+            Type out{};
+            std::size_t size = std::min(lua_objlen(state, index), N);
+            for(std::size_t i = 0; i < size; i++)
+            {
+                lua_rawgeti(state, index, static_cast<int>(i + 1));
+                detail::retrieve_element(state, -1, out[i]);
+                lua_pop(state, 1);
+            }
+
+            return out;
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::Table;
+        }
+    };
+
+    //push only, a span can't own retrieved elements
+    template<typename T, std::size_t EXTENT>
+    struct Stack<std::span<T, EXTENT>>
+    {
+        using Type = std::span<T, EXTENT>;
+
+        static void Push(lua_State* state, Type value)
+        {
+            detail::push_array<std::remove_const_t<T>>(state, value);
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::Table;
+        }
+    };
+
+    template<typename K, typename V, typename Compare, typename A>
+    struct Stack<std::map<K, V, Compare, A>>
+    {
+        using Type = std::map<K, V, Compare, A>;
+
+        static void Push(lua_State* state, const Type& value)
+        {
+            detail::push_map(state, value);
+        }
+
+        static Type Retrieve(lua_State* state, int index)
+        {
+            return detail::retrieve_map<Type>(state, index);
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::Table;
+        }
+    };
+
+    template<typename K, typename V, typename Hash, typename Equal, typename A>
+    struct Stack<std::unordered_map<K, V, Hash, Equal, A>>
+    {
+        using Type = std::unordered_map<K, V, Hash, Equal, A>;
+
+        static void Push(lua_State* state, const Type& value)
+        {
+            detail::push_map(state, value);
+        }
+
+        static Type Retrieve(lua_State* state, int index)
+        {
+            return detail::retrieve_map<Type>(state, index);
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::Table;
+        }
+    };
+
+    template<TableStruct C>
+    struct Stack<C>
+    {
+        using Type = C;
+        using fields = detail::table_fields<C>;
+
+        static void Push(lua_State* state, const Type& value)
+        {
+            [&]<typename... Fields>(hrs::variadic<Fields...>)
+            {
+                lua_createtable(state, 0, static_cast<int>(sizeof...(Fields)));
+                ((detail::push_static_string<Fields::name>(state),
+                  detail::push_element(state, value.*Fields::ptr),
+                  lua_rawset(state, -3)),
+                 ...);
+            }(fields{});
+        }
+
+        //missing and unconvertible fields keep their default values
+        static Type Retrieve(lua_State* state, int index)
+        {
+            if(index < 0 && index > LUA_REGISTRYINDEX)
+                index = lua_gettop(state) + index + 1;
+
+            Type out{};
+            [&]<typename... Fields>(hrs::variadic<Fields...>)
+            {
+                ((detail::push_static_string<Fields::name>(state),
+                  lua_rawget(state, index),
+                  retrieve_field<Fields>(state, out),
+                  lua_pop(state, 1)),
+                 ...);
+            }(fields{});
+
+            return out;
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::Table;
+        }
+    private:
+        template<typename Field>
+        static void retrieve_field(lua_State* state, Type& out)
+        {
+            if constexpr(!std::is_const_v<typename Field::type>)
+            {
+                typename Field::type value{};
+                if(detail::retrieve_element(state, -1, value))
+                    out.*Field::ptr = std::move(value);
+            }
+        }
+    };
+
+    template<typename T>
+    struct Stack<ArrayView<T>>
+    {
+        using Type = ArrayView<T>;
+
+        static void Push(lua_State* state, Type value)
+        {
+            void* data = lua_newuserdata(state, sizeof(Type));
+            new(data) Type(value);
+            detail::push_array_view_metatable<T>(state);
+            lua_setmetatable(state, -2);
+        }
+
+        //{nullptr, 0} if the userdata isn't a view of T
+        static Type Retrieve(lua_State* state, int index) noexcept
+        {
+            Type* view = detail::check_array_view<T>(state, index);
+            return (view ? *view : Type{nullptr, 0});
+        }
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept
+        {
+            return vm_type == VmType::UserData;
+        }
+    };
+};
@@ -0,0 +1,99 @@
+#include "FFIBinding.h"
+#include <algorithm>
+
+namespace LuaWay
+{
+    //args: {name, declaration, ...}, {name, signature, pointer, ...}
+    constexpr static const char* FFI_MODULE_LOADER = R"(
+        local declarations, functions = ...
+        local ffi = require("ffi")
+        for i = 1, #declarations, 2 do
+            if not pcall(ffi.typeof, declarations[i]) then
+                ffi.cdef(declarations[i + 1])
+            end
+        end
+
+        local module = {}
+        for i = 1, #functions, 3 do
+            module[functions[i]] = ffi.cast(functions[i + 1], functions[i + 2])
+        end
+
+        return module
+    )";
+
+    bool FFIModule::AddDeclaration(std::string_view name, std::string declaration)
+    {
+        if(IsDeclared(name))
+            return false;
+
+        declarations.push_back({std::string(name), std::move(declaration)});
+        return true;
+    }
+
+    bool FFIModule::IsDeclared(std::string_view name) const noexcept
+    {
+        return std::ranges::any_of(declarations,
+                                   [name](const declaration& decl)
+                                   {
+                                       return decl.name == name;
+                                   });
+    }
+
+    std::string FFIModule::GetDeclarations() const
+    {
+        std::string out;
+        for(const auto& decl: declarations)
+        {
+            out += decl.code;
+            out += '\n';
+        }
+
+        return out;
+    }
+
+    hrs::expected<Ref, Status> FFIModule::Load(const VMBase& vm) const
+    {
+        auto loader = vm.LoadString(FFI_MODULE_LOADER);
+        if(!loader)
+            return loader.error();
+
+        lua_State* state = vm.GetState();
+        Stack<Ref>::Push(state, loader.value());
+
+        lua_createtable(state, static_cast<int>(declarations.size() * 2), 0);
+        int index = 1;
+        for(const auto& decl: declarations)
+        {
+            lua_pushlstring(state, decl.name.data(), decl.name.size());
+            lua_rawseti(state, -2, index++);
+            lua_pushlstring(state, decl.code.data(), decl.code.size());
+            lua_rawseti(state, -2, index++);
+        }
+
+        lua_createtable(state, static_cast<int>(functions.size() * 3), 0);
+        index = 1;
+        for(const auto& func: functions)
+        {
+            lua_pushlstring(state, func.name.data(), func.name.size());
+            lua_rawseti(state, -2, index++);
+            lua_pushlstring(state, func.signature.data(), func.signature.size());
+            lua_rawseti(state, -2, index++);
+            lua_pushlightuserdata(state, func.ptr);
+            lua_rawseti(state, -2, index++);
+        }
+
+        int res = lua_pcall(state, 2, 1, 0);
+        if(res != 0)
+        {
+            //error
+            Status status(static_cast<StatusCode>(res), lua_tostring(state, -1));
+            lua_pop(state, 1);
+            return status;
+        }
+
+        //module
+        Ref module = vm.GetStackValue(-1);
+        lua_pop(state, 1);
+        return module;
+    }
+};
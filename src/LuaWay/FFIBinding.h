@@ -0,0 +1,474 @@
+#pragma once
+
+#include "ClassBinding.hpp"
+#include "Ref.h"
+#include "Status.h"
+#include "VMBase.h"
+#include "hrs/debug.hpp"
+#include "hrs/expected.hpp"
+#include "hrs/math/matrix.hpp"
+#include "hrs/math/vector.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//LuaJIT FFI bindings: C declarations of POD types and C-ABI trampolines of native functions.
+//A loaded module is a table of cdata function pointers, calls through them are compiled into
+//JIT traces, while a lua_CFunction call aborts the trace.
+namespace LuaWay
+{
+    class FFIModule;
+
+    //Name() - C name of T, Declare(module) - adds the declarations T depends on.
+    //Specialize it for own types, reflected standard layout classes are covered.
+    template<typename T>
+    struct FFIType;
+
+    template<typename T>
+    concept FFIRepresentable = requires(FFIModule& module) {
+        {
+            FFIType<T>::Name()
+        } -> std::convertible_to<std::string>;
+        FFIType<T>::Declare(module);
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        constexpr bool is_ffi_value = false;
+
+        template<typename T>
+        requires std::is_void_v<T>
+        constexpr bool is_ffi_value<T> = true;
+
+        template<typename T>
+        requires FFIRepresentable<std::remove_cv_t<T>>
+        constexpr bool is_ffi_value<T> = true;
+
+        template<typename T>
+        requires std::is_pointer_v<T> || std::is_reference_v<T>
+        constexpr bool is_ffi_value<T> =
+            is_ffi_value<std::remove_pointer_t<std::remove_reference_t<T>>>;
+
+        template<typename T>
+        requires std::is_bounded_array_v<T> && (std::rank_v<T> == 1)
+        constexpr bool is_ffi_value<T> = is_ffi_value<std::remove_extent_t<T>>;
+    };
+
+    //void, FFIType specializations, pointers and references to them
+    template<typename T>
+    concept FFIValue = detail::is_ffi_value<T>;
+
+    template<typename C>
+    concept FFIStruct = std::is_class_v<C> && (hrs::reflexpr<C>::name.size != 0) &&
+                        std::is_standard_layout_v<C> && std::is_trivially_copyable_v<C>;
+
+    //Collects C declarations and function pointers, Load passes them to ffi.cdef and ffi.cast
+    class FFIModule
+    {
+    public:
+        FFIModule() = default;
+        ~FFIModule() = default;
+        FFIModule(const FFIModule&) = default;
+        FFIModule(FFIModule&&) = default;
+        FFIModule& operator=(const FFIModule&) = default;
+        FFIModule& operator=(FFIModule&&) = default;
+
+        template<FFIValue T>
+        FFIModule& Type();
+
+        //also declares typedef T alias;
+        template<FFIValue T>
+        FFIModule& Type(std::string_view alias);
+
+        //free and static functions, member functions take the object pointer first
+        template<auto func>
+        FFIModule& Function(std::string_view name);
+
+        //false if name has already been declared, called by FFIType specializations
+        bool AddDeclaration(std::string_view name, std::string declaration);
+        bool IsDeclared(std::string_view name) const noexcept;
+        std::string GetDeclarations() const;
+
+        //declarations that already exist in the VM are skipped, so modules may share types.
+        //Returns the table of functions. Not noexcept: the argument tables are built outside
+        //of the protected call, so Lua memory errors unwind through it
+        hrs::expected<Ref, Status> Load(const VMBase& vm) const;
+    private:
+        struct declaration
+        {
+            std::string name;
+            std::string code;
+        };
+
+        struct function
+        {
+            std::string name;
+            std::string signature;
+            void* ptr;
+        };
+    private:
+        std::vector<declaration> declarations;
+        std::vector<function> functions;
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        std::string ffi_type_name()
+        {
+            if constexpr(std::is_void_v<T>)
+                return "void";
+            else if constexpr(std::is_pointer_v<T>)
+            {
+                using P = std::remove_pointer_t<T>;
+                return (std::is_const_v<P> ? "const " : "") + ffi_type_name<std::remove_cv_t<P>>() +
+                       "*";
+            }
+            else if constexpr(std::is_reference_v<T>)
+                return ffi_type_name<std::remove_reference_t<T>*>();
+            else
+                return FFIType<std::remove_cv_t<T>>::Name();
+        }
+
+        template<typename T>
+        void ffi_declare(FFIModule& module)
+        {
+            using U = std::remove_cv_t<
+                std::remove_extent_t<std::remove_pointer_t<std::remove_reference_t<T>>>>;
+            if constexpr(std::is_pointer_v<U> || std::is_reference_v<U>)
+                ffi_declare<U>(module);
+            else if constexpr(!std::is_void_v<U>)
+                FFIType<U>::Declare(module);
+        }
+
+        //references cross the C boundary as pointers
+        template<typename T>
+        struct ffi_abi
+        {
+            using type = T;
+        };
+
+        template<typename T>
+        struct ffi_abi<T&>
+        {
+            using type = T*;
+        };
+
+        template<typename T>
+        struct ffi_abi<T&&>
+        {
+            using type = T*;
+        };
+
+        template<typename T>
+        using ffi_abi_t = typename ffi_abi<T>::type;
+
+        template<typename T>
+        decltype(auto) from_ffi(ffi_abi_t<T> value) noexcept
+        {
+            if constexpr(std::is_lvalue_reference_v<T>)
+                return *value;
+            else if constexpr(std::is_rvalue_reference_v<T>)
+                return std::move(*value);
+            else
+                return value;
+        }
+
+        //exceptions can't unwind through FFI frames, so trampolines are noexcept
+        template<auto func, typename R, typename... Args>
+        ffi_abi_t<R> ffi_function_trampoline(ffi_abi_t<Args>... args) noexcept
+        {
+            if constexpr(std::is_reference_v<R>)
+                return &func(from_ffi<Args>(args)...);
+            else
+                return func(from_ffi<Args>(args)...);
+        }
+
+        template<auto method, typename Self, typename R, typename... Args>
+        ffi_abi_t<R> ffi_method_trampoline(Self* self, ffi_abi_t<Args>... args) noexcept
+        {
+            if constexpr(std::is_reference_v<R>)
+                return &(self->*method)(from_ffi<Args>(args)...);
+            else
+                return (self->*method)(from_ffi<Args>(args)...);
+        }
+
+        template<typename R, typename... Args>
+        std::string ffi_signature(hrs::variadic<Args...>)
+        {
+            std::string signature = ffi_type_name<R>() + " (*)(";
+            if constexpr(sizeof...(Args) == 0)
+                signature += "void";
+            else
+            {
+                ((signature += ffi_type_name<Args>(), signature += ", "), ...);
+                signature.resize(signature.size() - 2);
+            }
+
+            signature += ")";
+            return signature;
+        }
+
+        template<typename... Fields>
+        auto filter_ffi_fields(hrs::variadic<Fields...>) noexcept
+        {
+            return (std::conditional_t<!is_method_field<Fields> && !is_function_field<Fields>,
+                                       hrs::variadic<Fields>,
+                                       hrs::variadic<>>{} +
+                    ... + hrs::variadic<>{});
+        }
+
+        //C name of a reflected class: scopes are joined with "__", which C++ reserves, so
+        //game::Vec and Vec never share a ctype
+        inline std::string ffi_mangle_class_name(std::string_view name)
+        {
+            if(name.starts_with("::"))
+                name.remove_prefix(2);
+
+            std::string out;
+            out.reserve(name.size());
+            for(std::size_t i = 0; i < name.size(); i++)
+            {
+                if(name.substr(i).starts_with("::"))
+                {
+                    out += "__";
+                    i++;
+                }
+                else
+                    out += name[i];
+            }
+
+            auto is_identifier_char = [](char ch)
+            {
+                return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+            };
+
+            hrs::assert_true_debug(!out.empty() &&
+                                       !std::isdigit(static_cast<unsigned char>(out[0])) &&
+                                       std::ranges::all_of(out, is_identifier_char),
+                                   "Reflected name {} isn't a C identifier!",
+                                   out);
+            return out;
+        }
+
+        inline std::size_t ffi_align_up(std::size_t value, std::size_t alignment) noexcept
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        //LuaJIT lays out the declaration by C rules, so every field must be listed
+        //in declaration order
+        template<FFIStruct C, typename... Fields>
+        bool ffi_matches_layout(hrs::variadic<Fields...>) noexcept
+        {
+            alignas(C) std::byte storage[sizeof(C)];
+            const C* object = reinterpret_cast<const C*>(storage);
+            auto offset_of = [object]<typename Field>(Field)
+            {
+                return static_cast<std::size_t>(reinterpret_cast<const std::byte*>(
+                                                    &(object->*Field::ptr)) -
+                                                reinterpret_cast<const std::byte*>(object));
+            };
+
+            std::size_t end = 0;
+            bool matches = true;
+            ((matches = matches &&
+                        ffi_align_up(end, alignof(typename Fields::type)) == offset_of(Fields{}),
+              end = offset_of(Fields{}) + sizeof(typename Fields::type)),
+             ...);
+
+            return matches && ffi_align_up(end, alignof(C)) == sizeof(C);
+        }
+
+        template<typename Field>
+        std::string ffi_field_declaration()
+        {
+            using T = std::remove_cv_t<typename Field::type>;
+            std::string name(Field::name.begin(), Field::name.size);
+            if constexpr(std::is_array_v<T>)
+                return ffi_type_name<std::remove_extent_t<T>>() + " " + name + "[" +
+                       std::to_string(std::extent_v<T>) + "];";
+            else
+                return ffi_type_name<T>() + " " + name + ";";
+        }
+    };
+
+    template<typename T>
+    requires std::is_arithmetic_v<T> && (!std::same_as<T, long double>)
+    struct FFIType<T>
+    {
+        static std::string Name()
+        {
+            if constexpr(std::same_as<T, bool>)
+                return "bool";
+            else if constexpr(std::same_as<T, char>)
+                return "char";
+            else if constexpr(std::same_as<T, float>)
+                return "float";
+            else if constexpr(std::same_as<T, double>)
+                return "double";
+            else
+                return (std::is_signed_v<T> ? "int" : "uint") + std::to_string(sizeof(T) * 8) +
+                       "_t";
+        }
+
+        static void Declare(FFIModule&) noexcept {}
+    };
+
+    template<typename T, std::size_t DIMENSION, std::size_t ALIGNMENT>
+    struct FFIType<hrs::math::vector<T, DIMENSION, ALIGNMENT>>
+    {
+        static std::string Name()
+        {
+            return "hrs_vector_" + FFIType<T>::Name() + "_" + std::to_string(DIMENSION) + "_" +
+                   std::to_string(ALIGNMENT);
+        }
+
+        static void Declare(FFIModule& module)
+        {
+            std::string name = Name();
+            if(module.IsDeclared(name))
+                return;
+
+            module.AddDeclaration(name,
+                                  "typedef struct __attribute__((aligned(" +
+                                      std::to_string(ALIGNMENT) + "))) { " + FFIType<T>::Name() +
+                                      " data[" + std::to_string(DIMENSION) + "]; } " + name + ";");
+        }
+    };
+
+    template<typename T, std::size_t ROWS, std::size_t COLS, std::size_t ALIGNMENT>
+    struct FFIType<hrs::math::matrix<T, ROWS, COLS, ALIGNMENT>>
+    {
+        using row_type = typename hrs::math::matrix<T, ROWS, COLS, ALIGNMENT>::row_type;
+
+        static std::string Name()
+        {
+            return "hrs_matrix_" + FFIType<T>::Name() + "_" + std::to_string(ROWS) + "x" +
+                   std::to_string(COLS) + "_" + std::to_string(ALIGNMENT);
+        }
+
+        static void Declare(FFIModule& module)
+        {
+            std::string name = Name();
+            if(module.IsDeclared(name))
+                return;
+
+            FFIType<row_type>::Declare(module);
+            module.AddDeclaration(name,
+                                  "typedef struct { " + FFIType<row_type>::Name() + " data[" +
+                                      std::to_string(ROWS) + "]; } " + name + ";");
+        }
+    };
+
+    //member variables become struct fields, the other class_meta entries are skipped
+    template<FFIStruct C>
+    struct FFIType<C>
+    {
+        using fields = decltype(detail::filter_ffi_fields(
+            typename hrs::reflexpr<C>::member_fields{}));
+
+        static std::string Name()
+        {
+            return detail::ffi_mangle_class_name(detail::class_name<C>.data());
+        }
+
+        static void Declare(FFIModule& module)
+        {
+            std::string name = Name();
+            if(module.IsDeclared(name))
+                return;
+
+            [&]<typename... Fields>(hrs::variadic<Fields...>)
+            {
+                static_assert((FFIValue<typename Fields::type> && ...),
+                              "Fields must be FFIValue!");
+                hrs::assert_true_debug(detail::ffi_matches_layout<C>(fields{}),
+                                       "Class meta doesn't describe the layout of the class!");
+
+                std::string code = "typedef struct ";
+                if(alignof(C) > std::max({std::size_t(1), alignof(typename Fields::type)...}))
+                    code += "__attribute__((aligned(" + std::to_string(alignof(C)) + "))) ";
+
+                code += "{ ";
+                (detail::ffi_declare<typename Fields::type>(module), ...);
+                ((code += detail::ffi_field_declaration<Fields>(), code += " "), ...);
+                code += "} " + name + ";";
+                module.AddDeclaration(name, std::move(code));
+            }(fields{});
+        }
+    };
+
+    template<FFIValue T>
+    FFIModule& FFIModule::Type()
+    {
+        detail::ffi_declare<T>(*this);
+        return *this;
+    }
+
+    template<FFIValue T>
+    FFIModule& FFIModule::Type(std::string_view alias)
+    {
+        Type<T>();
+        AddDeclaration(alias,
+                       "typedef " + detail::ffi_type_name<T>() + " " + std::string(alias) + ";");
+        return *this;
+    }
+
+    template<auto func>
+    FFIModule& FFIModule::Function(std::string_view name)
+    {
+        using F = decltype(func);
+        if constexpr(std::is_member_function_pointer_v<F>)
+        {
+            using C = hrs::member_class_type_class_t<F>;
+            using traits = hrs::function_traits<hrs::member_class_type_field_t<F>>;
+            using Self = std::conditional_t<traits::is_const_qualified, const C, C>;
+            static_assert(FFIValue<C> && FFIValue<typename traits::return_type>,
+                          "Class and return type must be FFIValue!");
+
+            [&]<typename... Args>(hrs::variadic<Args...>)
+            {
+                static_assert((FFIValue<Args> && ...), "Arguments must be FFIValue!");
+                detail::ffi_declare<C>(*this);
+                detail::ffi_declare<typename traits::return_type>(*this);
+                (detail::ffi_declare<Args>(*this), ...);
+
+                functions.push_back(function{
+                    .name = std::string(name),
+                    .signature = detail::ffi_signature<typename traits::return_type>(
+                        hrs::variadic<Self*, Args...>{}),
+                    .ptr = reinterpret_cast<void*>(
+                        &detail::ffi_method_trampoline<func,
+                                                       Self,
+                                                       typename traits::return_type,
+                                                       Args...>)});
+            }(typename traits::arguments{});
+        }
+        else
+        {
+            using traits = hrs::function_traits<std::remove_pointer_t<F>>;
+            static_assert(FFIValue<typename traits::return_type>, "Return type must be FFIValue!");
+
+            [&]<typename... Args>(hrs::variadic<Args...> arguments)
+            {
+                static_assert((FFIValue<Args> && ...), "Arguments must be FFIValue!");
+                detail::ffi_declare<typename traits::return_type>(*this);
+                (detail::ffi_declare<Args>(*this), ...);
+
+                functions.push_back(function{
+                    .name = std::string(name),
+                    .signature = detail::ffi_signature<typename traits::return_type>(arguments),
+                    .ptr = reinterpret_cast<void*>(
+                        &detail::
+                            ffi_function_trampoline<func, typename traits::return_type, Args...>)});
+            }(typename traits::arguments{});
+        }
+
+        return *this;
+    }
+};
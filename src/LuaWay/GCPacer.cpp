@@ -0,0 +1,186 @@
+#include "GCPacer.h"
+#include <algorithm>
+#include <bit>
+
+namespace LuaWay
+{
+    //smoothing factor of the allocation rate and the step cost
+    constexpr static double AVERAGE_WEIGHT = 0.125;
+    //a step takes a quarter of the budget, so the loop can stop close to it
+    constexpr static double STEPS_PER_BUDGET = 4;
+
+    GCPacer::GCPacer(const VMBase& vm, const GCPacerSettings& _settings) noexcept
+        : state(vm.GetState()),
+          settings(_settings),
+          pool_allocator(vm.GetPoolAllocator()),
+          base_allocator(nullptr),
+          base_allocator_data(nullptr),
+          counted_bytes(0),
+          last_allocated_bytes(0),
+          step_cost(0),
+          cycle_running(false),
+          statistics{}
+    {
+        hrs::assert_true_debug(vm.IsOpen(), "Lua VM isn't opened yet!");
+
+        if(settings.min_step_size == 0)
+            settings.min_step_size = DEFAULT_MIN_STEP_SIZE;
+
+        if(settings.max_step_size == 0)
+            settings.max_step_size = DEFAULT_MAX_STEP_SIZE;
+
+        settings.max_step_size = std::max(settings.max_step_size, settings.min_step_size);
+        if(settings.pause == 0)
+            settings.pause = 200;
+
+        if(settings.work_ratio == 0)
+            settings.work_ratio = 1;
+
+        if(!pool_allocator)
+        {
+            base_allocator = lua_getallocf(state, &base_allocator_data);
+            lua_setallocf(state, counting_allocate, this);
+        }
+
+        lua_gc(state, LUA_GCSTOP, 0);
+        last_allocated_bytes = get_allocated_bytes();
+        statistics.heap_bytes = get_heap_bytes();
+        statistics.heap_after_cycle = statistics.heap_bytes;
+        statistics.peak_heap_bytes = statistics.heap_bytes;
+        statistics.step_size = settings.min_step_size;
+    }
+
+    GCPacer::~GCPacer()
+    {
+        if(base_allocator)
+            lua_setallocf(state, base_allocator, base_allocator_data);
+
+        lua_gc(state, LUA_GCRESTART, 0);
+    }
+
+    void GCPacer::Step() noexcept
+    {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+
+        std::size_t allocated_bytes = get_allocated_bytes();
+        std::size_t delta = allocated_bytes - last_allocated_bytes;
+        last_allocated_bytes = allocated_bytes;
+        statistics.allocation_rate += (static_cast<double>(delta) - statistics.allocation_rate) *
+                                      AVERAGE_WEIGHT;
+
+        std::size_t heap_bytes = get_heap_bytes();
+        std::size_t cycle_threshold =
+            statistics.heap_after_cycle / 100 * static_cast<std::size_t>(settings.pause);
+        if(!cycle_running && heap_bytes >= cycle_threshold)
+            cycle_running = true;
+
+        if(cycle_running)
+            statistics.debt += static_cast<double>(delta) / 1024 * settings.work_ratio;
+
+        bool over_limit = (settings.heap_limit != 0 && heap_bytes > settings.heap_limit);
+        std::size_t frame_steps = 0;
+        while(cycle_running)
+        {
+            //a running cycle makes at least one step per frame, so it always completes
+            if(!over_limit && frame_steps != 0 &&
+               (statistics.debt <= 0 || clock::now() - start >= settings.step_budget))
+                break;
+
+            auto step_start = clock::now();
+            bool finished = lua_gc(state, LUA_GCSTEP, static_cast<int>(statistics.step_size));
+            double step_time = std::chrono::duration<double, std::nano>(clock::now() - step_start)
+                                   .count() /
+                               static_cast<double>(statistics.step_size);
+
+            //expensive steps are taken at once, cheap ones are averaged in
+            step_cost = (step_time > step_cost
+                             ? step_time
+                             : step_cost + (step_time - step_cost) * AVERAGE_WEIGHT);
+            statistics.debt -= static_cast<double>(statistics.step_size);
+            statistics.step_count++;
+            frame_steps++;
+
+            if(finished)
+            {
+                cycle_running = false;
+                statistics.debt = 0;
+                statistics.completed_cycles++;
+                statistics.heap_after_cycle = get_heap_bytes();
+            }
+        }
+
+        //a finished step restores the automatic threshold
+        lua_gc(state, LUA_GCSTOP, 0);
+
+        if(step_cost != 0)
+        {
+            double budget = std::chrono::duration<double, std::nano>(settings.step_budget).count();
+            auto step_size = static_cast<std::size_t>(budget / STEPS_PER_BUDGET / step_cost);
+            statistics.step_size =
+                std::clamp(step_size, settings.min_step_size, settings.max_step_size);
+        }
+
+        statistics.heap_bytes = get_heap_bytes();
+        statistics.peak_heap_bytes = std::max(statistics.peak_heap_bytes, statistics.heap_bytes);
+        statistics.frame_count++;
+        record_pause(clock::now() - start);
+    }
+
+    const GCPacerStatistics& GCPacer::GetStatistics() const noexcept
+    {
+        return statistics;
+    }
+
+    void GCPacer::ResetStatistics() noexcept
+    {
+        statistics.pause_histogram = {};
+        statistics.last_pause = {};
+        statistics.max_pause = {};
+        statistics.frame_count = 0;
+        statistics.step_count = 0;
+        statistics.completed_cycles = 0;
+        statistics.budget_overruns = 0;
+        statistics.peak_heap_bytes = statistics.heap_bytes;
+    }
+
+    void* GCPacer::counting_allocate(void* ud,
+                                     void* ptr,
+                                     std::size_t osize,
+                                     std::size_t nsize) noexcept
+    {
+        GCPacer* pacer = static_cast<GCPacer*>(ud);
+        void* out_ptr = pacer->base_allocator(pacer->base_allocator_data, ptr, osize, nsize);
+        std::size_t old_size = (ptr ? osize : 0);
+        if(out_ptr && nsize > old_size)
+            pacer->counted_bytes += nsize - old_size;
+
+        return out_ptr;
+    }
+
+    std::size_t GCPacer::get_allocated_bytes() const noexcept
+    {
+        if(pool_allocator)
+            return pool_allocator->GetStatistics().allocated_bytes;
+
+        return counted_bytes;
+    }
+
+    std::size_t GCPacer::get_heap_bytes() const noexcept
+    {
+        auto kbytes = static_cast<std::size_t>(lua_gc(state, LUA_GCCOUNT, 0));
+        return kbytes * 1024 + static_cast<std::size_t>(lua_gc(state, LUA_GCCOUNTB, 0));
+    }
+
+    void GCPacer::record_pause(std::chrono::nanoseconds pause) noexcept
+    {
+        auto microseconds = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(pause).count());
+        std::size_t bucket = (microseconds == 0 ? 0 : std::bit_width(microseconds) - 1);
+        statistics.pause_histogram[std::min(bucket, GC_PAUSE_HISTOGRAM_SIZE - 1)]++;
+        statistics.last_pause = pause;
+        statistics.max_pause = std::max(statistics.max_pause, pause);
+        if(pause > settings.step_budget)
+            statistics.budget_overruns++;
+    }
+};
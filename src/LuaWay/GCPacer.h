@@ -0,0 +1,81 @@
+#pragma once
+
+#include "PoolAllocator.h"
+#include "VMBase.h"
+#include "hrs/non_creatable.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace LuaWay
+{
+    constexpr inline std::size_t GC_PAUSE_HISTOGRAM_SIZE = 16;
+
+    struct GCPacerSettings
+    {
+        std::chrono::microseconds step_budget; //time of one Step call
+        std::size_t min_step_size; //KB passed to LUA_GCSTEP, 0 - DEFAULT_MIN_STEP_SIZE
+        std::size_t max_step_size; //KB, 0 - DEFAULT_MAX_STEP_SIZE
+        int pause; //percent of the heap after a cycle that starts the next one, 0 - 200
+        double work_ratio; //step KB per allocated KB, 0 - 1
+        std::size_t heap_limit; //bytes, 0 - none, above it Step ignores the budget
+    };
+
+    struct GCPacerStatistics
+    {
+        //bucket i counts Step pauses in [2^i, 2^(i + 1)) microseconds, the first one also
+        //takes shorter pauses, the last one longer pauses
+        std::array<std::size_t, GC_PAUSE_HISTOGRAM_SIZE> pause_histogram;
+        std::chrono::nanoseconds last_pause;
+        std::chrono::nanoseconds max_pause;
+        std::size_t frame_count;
+        std::size_t step_count;
+        std::size_t completed_cycles;
+        std::size_t budget_overruns; //Step calls that took longer than the budget
+        std::size_t heap_bytes;
+        std::size_t heap_after_cycle;
+        std::size_t peak_heap_bytes;
+        double allocation_rate; //bytes per Step, smoothed
+        std::size_t step_size; //KB
+        double debt; //KB of step work still to do in the current cycle
+    };
+
+    //Runs the incremental collector only inside Step, which is called once per frame at
+    //a chosen point. The automatic collector is stopped while the pacer exists.
+    //Step work follows the allocation rate, the step size follows the measured step cost,
+    //so a Step stays within the budget unless the heap is above heap_limit.
+    //Allocations are counted by the PoolAllocator of the VM or by a counting lua_Alloc
+    //installed over the current one. Must be destroyed before the VM
+    class GCPacer : public hrs::non_copyable
+    {
+    public:
+        constexpr static std::size_t DEFAULT_MIN_STEP_SIZE = 1;
+        constexpr static std::size_t DEFAULT_MAX_STEP_SIZE = 1024;
+
+        GCPacer(const VMBase& vm, const GCPacerSettings& settings) noexcept;
+        ~GCPacer();
+
+        void Step() noexcept;
+
+        const GCPacerStatistics& GetStatistics() const noexcept;
+        void ResetStatistics() noexcept;
+    private:
+        static void*
+        counting_allocate(void* ud, void* ptr, std::size_t osize, std::size_t nsize) noexcept;
+
+        std::size_t get_allocated_bytes() const noexcept;
+        std::size_t get_heap_bytes() const noexcept;
+        void record_pause(std::chrono::nanoseconds pause) noexcept;
+    private:
+        lua_State* state;
+        GCPacerSettings settings;
+        PoolAllocator* pool_allocator;
+        lua_Alloc base_allocator; //nullptr if the pool allocator counts allocations
+        void* base_allocator_data;
+        std::size_t counted_bytes;
+        std::size_t last_allocated_bytes;
+        double step_cost; //nanoseconds per step KB, 0 - not measured yet
+        bool cycle_running;
+        GCPacerStatistics statistics;
+    };
+};
@@ -0,0 +1,277 @@
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace LuaWay
+{
+    constexpr static std::size_t SIZE_CLASS_GRANULARITY = 16;
+    constexpr static std::size_t NO_SIZE_CLASS = POOL_ALLOCATOR_SIZE_CLASS_COUNT;
+    constexpr static std::size_t CHUNK_HEADER_SIZE = SIZE_CLASS_GRANULARITY;
+
+    //size class for every 16-byte step up to the largest class
+    constexpr static auto SIZE_CLASS_LOOKUP = []()
+    {
+        constexpr std::size_t max_size = PoolAllocator::SIZE_CLASSES.back();
+        std::array<std::uint8_t, max_size / SIZE_CLASS_GRANULARITY + 1> lookup{};
+        std::size_t size_class = 0;
+        for(std::size_t i = 0; i < lookup.size(); i++)
+        {
+            while(PoolAllocator::SIZE_CLASSES[size_class] < i * SIZE_CLASS_GRANULARITY)
+                size_class++;
+
+            lookup[i] = static_cast<std::uint8_t>(size_class);
+        }
+
+        return lookup;
+    }();
+
+    PoolAllocator::PoolAllocator(const PoolAllocatorSettings& settings) noexcept
+        : memory_limit(settings.memory_limit),
+          arena_chunk_size(settings.arena_chunk_size == 0 ? DEFAULT_ARENA_CHUNK_SIZE
+                                                          : settings.arena_chunk_size),
+          chunks(nullptr),
+          chunk_position(nullptr),
+          chunk_end(nullptr),
+          free_lists{},
+          statistics{}
+    {
+        arena_chunk_size = std::max(arena_chunk_size, CHUNK_HEADER_SIZE + SIZE_CLASSES.back());
+        arena_chunk_size = (arena_chunk_size + SIZE_CLASS_GRANULARITY - 1) /
+                           SIZE_CLASS_GRANULARITY * SIZE_CLASS_GRANULARITY;
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        while(chunks)
+        {
+            std::byte* next = *reinterpret_cast<std::byte**>(chunks);
+            std::free(chunks);
+            chunks = next;
+        }
+    }
+
+    void* PoolAllocator::Allocate(void* ud,
+                                  void* ptr,
+                                  std::size_t osize,
+                                  std::size_t nsize) noexcept
+    {
+        PoolAllocator* allocator = static_cast<PoolAllocator*>(ud);
+        if(nsize == 0)
+        {
+            if(ptr)
+            {
+                allocator->deallocate(ptr, osize);
+                allocator->statistics.used_bytes -= osize;
+            }
+
+            return nullptr;
+        }
+
+        //Lua expects shrinking to always succeed, so only growth is checked against the limit
+        std::size_t old_size = (ptr ? osize : 0);
+        if(nsize > old_size && allocator->memory_limit != 0 &&
+           allocator->statistics.used_bytes + (nsize - old_size) > allocator->memory_limit)
+        {
+            allocator->statistics.failed_allocations++;
+            return nullptr;
+        }
+
+        void* out_ptr =
+            (ptr ? allocator->reallocate(ptr, osize, nsize) : allocator->allocate(nsize));
+        if(!out_ptr)
+        {
+            allocator->statistics.failed_allocations++;
+            return nullptr;
+        }
+
+        auto& statistics = allocator->statistics;
+        statistics.used_bytes = statistics.used_bytes - old_size + nsize;
+        statistics.allocated_bytes += (nsize > old_size ? nsize - old_size : 0);
+        statistics.peak_bytes = std::max(statistics.peak_bytes, statistics.used_bytes);
+        return out_ptr;
+    }
+
+    const PoolAllocatorStatistics& PoolAllocator::GetStatistics() const noexcept
+    {
+        return statistics;
+    }
+
+    std::size_t PoolAllocator::GetMemoryLimit() const noexcept
+    {
+        return memory_limit;
+    }
+
+    void PoolAllocator::SetMemoryLimit(std::size_t limit) noexcept
+    {
+        memory_limit = limit;
+    }
+
+    std::size_t PoolAllocator::get_size_class(std::size_t size) noexcept
+    {
+        if(size > SIZE_CLASSES.back())
+            return NO_SIZE_CLASS;
+
+        return SIZE_CLASS_LOOKUP[(size + SIZE_CLASS_GRANULARITY - 1) / SIZE_CLASS_GRANULARITY];
+    }
+
+    void* PoolAllocator::allocate(std::size_t size) noexcept
+    {
+        std::size_t size_class = get_size_class(size);
+        if(size_class == NO_SIZE_CLASS)
+        {
+            void* ptr = std::malloc(size);
+            if(ptr)
+            {
+                statistics.large_bytes += size;
+                statistics.reserved_bytes += size;
+            }
+
+            return ptr;
+        }
+
+        void* ptr;
+        if(free_lists[size_class])
+        {
+            free_node* node = free_lists[size_class];
+            free_lists[size_class] = node->next;
+            ptr = node;
+        }
+        else
+        {
+            ptr = allocate_from_arena(size_class);
+            if(!ptr)
+                return nullptr;
+        }
+
+        statistics.size_class_bytes[size_class] += SIZE_CLASSES[size_class];
+        return ptr;
+    }
+
+    void PoolAllocator::deallocate(void* ptr, std::size_t size) noexcept
+    {
+        std::size_t size_class = get_size_class(size);
+        if(size_class == NO_SIZE_CLASS)
+        {
+            std::free(ptr);
+            statistics.large_bytes -= size;
+            statistics.reserved_bytes -= size;
+            return;
+        }
+
+        free_node* node = static_cast<free_node*>(ptr);
+        node->next = free_lists[size_class];
+        free_lists[size_class] = node;
+        statistics.size_class_bytes[size_class] -= SIZE_CLASSES[size_class];
+    }
+
+    void* PoolAllocator::reallocate(void* ptr, std::size_t osize, std::size_t nsize) noexcept
+    {
+        std::size_t old_size_class = get_size_class(osize);
+        std::size_t new_size_class = get_size_class(nsize);
+        if(old_size_class == NO_SIZE_CLASS && new_size_class == NO_SIZE_CLASS)
+        {
+            void* new_ptr = std::realloc(ptr, nsize);
+            if(new_ptr)
+            {
+                statistics.large_bytes = statistics.large_bytes - osize + nsize;
+                statistics.reserved_bytes = statistics.reserved_bytes - osize + nsize;
+            }
+
+            return new_ptr;
+        }
+
+        if(old_size_class == new_size_class)
+            return ptr;
+
+        void* new_ptr = allocate(nsize);
+        if(!new_ptr)
+        {
+            //Lua mustn't see a shrink fail, but it frees the block with the new size later
+            if(nsize > osize)
+                return nullptr;
+
+            if(old_size_class == NO_SIZE_CLASS)
+                return adopt_large_block(ptr, osize, nsize, new_size_class);
+
+            //a slot of a larger class serves as a slot of a smaller one
+            statistics.size_class_bytes[old_size_class] -= SIZE_CLASSES[old_size_class];
+            statistics.size_class_bytes[new_size_class] += SIZE_CLASSES[new_size_class];
+            return ptr;
+        }
+
+        std::memcpy(new_ptr, ptr, std::min(osize, nsize));
+        deallocate(ptr, osize);
+        return new_ptr;
+    }
+
+    void* PoolAllocator::adopt_large_block(void* ptr,
+                                           std::size_t osize,
+                                           std::size_t nsize,
+                                           std::size_t size_class) noexcept
+    {
+        //the block becomes the current arena chunk with the shrunk data in its first slot,
+        //so it's released with the other chunks and the rest of it serves later allocations
+        std::size_t chunk_size = std::max(osize, CHUNK_HEADER_SIZE + SIZE_CLASSES[size_class]);
+        auto chunk = static_cast<std::byte*>(ptr);
+        if(chunk_size != osize)
+        {
+            chunk = static_cast<std::byte*>(std::realloc(ptr, chunk_size));
+            if(!chunk)
+                return nullptr;
+        }
+
+        std::memmove(chunk + CHUNK_HEADER_SIZE, chunk, nsize);
+        release_chunk_tail();
+        *reinterpret_cast<std::byte**>(chunk) = chunks;
+        chunks = chunk;
+        chunk_position = chunk + CHUNK_HEADER_SIZE + SIZE_CLASSES[size_class];
+        chunk_end = chunk + chunk_size;
+
+        statistics.large_bytes -= osize;
+        statistics.reserved_bytes = statistics.reserved_bytes - osize + chunk_size;
+        statistics.size_class_bytes[size_class] += SIZE_CLASSES[size_class];
+        return chunk + CHUNK_HEADER_SIZE;
+    }
+
+    void* PoolAllocator::allocate_from_arena(std::size_t size_class) noexcept
+    {
+        std::size_t size = SIZE_CLASSES[size_class];
+        if(static_cast<std::size_t>(chunk_end - chunk_position) < size)
+        {
+            release_chunk_tail();
+
+            auto chunk = static_cast<std::byte*>(std::malloc(arena_chunk_size));
+            if(!chunk)
+                return nullptr;
+
+            *reinterpret_cast<std::byte**>(chunk) = chunks;
+            chunks = chunk;
+            chunk_position = chunk + CHUNK_HEADER_SIZE;
+            chunk_end = chunk + arena_chunk_size;
+            statistics.reserved_bytes += arena_chunk_size;
+        }
+
+        void* ptr = chunk_position;
+        chunk_position += size;
+        return ptr;
+    }
+
+    void PoolAllocator::release_chunk_tail() noexcept
+    {
+        //the tail goes to the free lists of the largest classes that fit into it
+        auto remaining = static_cast<std::size_t>(chunk_end - chunk_position);
+        while(remaining >= SIZE_CLASSES.front())
+        {
+            std::size_t tail_class = get_size_class(remaining);
+            if(tail_class == NO_SIZE_CLASS || SIZE_CLASSES[tail_class] > remaining)
+                tail_class--;
+
+            free_node* node = reinterpret_cast<free_node*>(chunk_position);
+            node->next = free_lists[tail_class];
+            free_lists[tail_class] = node;
+            chunk_position += SIZE_CLASSES[tail_class];
+            remaining -= SIZE_CLASSES[tail_class];
+        }
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "hrs/non_creatable.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <lua.hpp>
+
+namespace LuaWay
+{
+    constexpr inline std::size_t POOL_ALLOCATOR_SIZE_CLASS_COUNT = 10;
+
+    struct PoolAllocatorSettings
+    {
+        std::size_t memory_limit; //0 - unlimited, allocations above it fail with LUA_ERRMEM
+        std::size_t arena_chunk_size; //0 - DEFAULT_ARENA_CHUNK_SIZE
+    };
+
+    struct PoolAllocatorStatistics
+    {
+        std::array<std::size_t, POOL_ALLOCATOR_SIZE_CLASS_COUNT> size_class_bytes;
+        std::size_t large_bytes; //blocks above the largest size class
+        std::size_t used_bytes; //as requested by Lua, matches GetUsedMemory
+        std::size_t allocated_bytes; //total growth requested by Lua, never decreases
+        std::size_t peak_bytes;
+        std::size_t reserved_bytes; //arena chunks and large blocks
+        std::size_t failed_allocations;
+    };
+
+    //Per-VM lua_Alloc with size classes carved from arena chunks.
+    //Small blocks are reused through per-class free lists and never go back to the heap
+    //until the allocator is destroyed, larger blocks go straight to malloc.
+    //Not thread-safe, like the Lua state that uses it
+    class PoolAllocator : public hrs::non_copyable
+    {
+    public:
+        constexpr static std::array<std::size_t, POOL_ALLOCATOR_SIZE_CLASS_COUNT> SIZE_CLASSES =
+            {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+        constexpr static std::size_t DEFAULT_ARENA_CHUNK_SIZE = 64 * 1024;
+
+        PoolAllocator(const PoolAllocatorSettings& settings) noexcept;
+        ~PoolAllocator();
+
+        //lua_Alloc, ud is the allocator
+        static void* Allocate(void* ud, void* ptr, std::size_t osize, std::size_t nsize) noexcept;
+
+        const PoolAllocatorStatistics& GetStatistics() const noexcept;
+        std::size_t GetMemoryLimit() const noexcept;
+        void SetMemoryLimit(std::size_t limit) noexcept;
+    private:
+        struct free_node
+        {
+            free_node* next;
+        };
+
+        static std::size_t get_size_class(std::size_t size) noexcept;
+
+        void* allocate(std::size_t size) noexcept;
+        void deallocate(void* ptr, std::size_t size) noexcept;
+        void* reallocate(void* ptr, std::size_t osize, std::size_t nsize) noexcept;
+        void* adopt_large_block(void* ptr,
+                                std::size_t osize,
+                                std::size_t nsize,
+                                std::size_t size_class) noexcept;
+        void* allocate_from_arena(std::size_t size_class) noexcept;
+        void release_chunk_tail() noexcept;
+    private:
+        std::size_t memory_limit;
+        std::size_t arena_chunk_size;
+        std::byte* chunks; //linked through their first bytes
+        std::byte* chunk_position;
+        std::byte* chunk_end;
+        std::array<free_node*, POOL_ALLOCATOR_SIZE_CLASS_COUNT> free_lists;
+        PoolAllocatorStatistics statistics;
+    };
+};
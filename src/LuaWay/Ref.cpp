@@ -1,16 +1,110 @@
 #include "Ref.h"
 #include "RefIterator.h"
+#include <new>
 
 namespace LuaWay
 {
+    namespace detail
+    {
+        //Released slots are kept for reuse by the thread that released them.
+        //Slots are plain heap nodes, so a slot may be released by another thread
+        class ref_slot_cache
+        {
+        public:
+            constexpr static std::size_t MAX_CACHED_SLOTS = 1024;
+
+            //null once the cache of the thread is destroyed, the main thread's cache is
+            //destroyed before static Refs that may still release slots
+            static ref_slot_cache* get() noexcept
+            {
+                if(destroyed)
+                    return nullptr;
+
+                thread_local ref_slot_cache cache;
+                return &cache;
+            }
+
+            ~ref_slot_cache()
+            {
+                while(free_slots)
+                    delete std::exchange(free_slots, free_slots->next_free);
+
+                free_count = 0;
+                destroyed = true;
+            }
+
+            ref_slot* Acquire(int ref) noexcept
+            {
+                if(!free_slots)
+                    return new(std::nothrow) ref_slot{.ref = ref, .count = 1, .next_free = nullptr};
+
+                ref_slot* slot = std::exchange(free_slots, free_slots->next_free);
+                free_count--;
+                *slot = ref_slot{.ref = ref, .count = 1, .next_free = nullptr};
+                return slot;
+            }
+
+            void Release(ref_slot* slot) noexcept
+            {
+                if(free_count == MAX_CACHED_SLOTS)
+                {
+                    delete slot;
+                    return;
+                }
+
+                slot->next_free = std::exchange(free_slots, slot);
+                free_count++;
+            }
+        private:
+            ref_slot_cache() noexcept
+                : free_slots(nullptr),
+                  free_count(0)
+            {}
+        private:
+            //trivially destructible, so it stays readable after the cache is destroyed
+            inline static thread_local bool destroyed = false;
+            ref_slot* free_slots;
+            std::size_t free_count;
+        };
+
+        ref_slot* acquire_ref_slot(int ref) noexcept
+        {
+            if(ref_slot_cache* cache = ref_slot_cache::get(); cache)
+                return cache->Acquire(ref);
+
+            return new(std::nothrow) ref_slot{.ref = ref, .count = 1, .next_free = nullptr};
+        }
+
+        void release_ref_slot(ref_slot* slot) noexcept
+        {
+            if(ref_slot_cache* cache = ref_slot_cache::get(); cache)
+                cache->Release(slot);
+            else
+                delete slot;
+        }
+    };
+
     Ref::Ref(lua_State* _state, int _ref) noexcept
         : state(_state),
-          ref(_ref)
-    {}
+          slot(detail::acquire_ref_slot(_ref))
+    {
+        if(!slot)
+        {
+            luaL_unref(state, LUA_REGISTRYINDEX, _ref);
+            state = nullptr;
+        }
+    }
+
+    Ref::Ref(lua_State* _state, detail::ref_slot* _slot) noexcept
+        : state(_state),
+          slot(_slot)
+    {
+        slot->count++;
+    }
 
     Ref::Ref() noexcept
         : state(nullptr),
-          ref(LUA_REFNIL)
+          slot(nullptr)
     {}
 
     Ref::~Ref()
@@ -19,46 +113,41 @@ namespace LuaWay
     }
 
     Ref::Ref(const Ref& r) noexcept
-        : state(r.state)
+        : state(r.state),
+          slot(r.slot)
     {
-        if(!r.IsCreated())
-            ref = LUA_REFNIL;
-        else
-        {
-            Stack<Ref>::Push(r.state, r);
-            int _ref = luaL_ref(r.state, LUA_REGISTRYINDEX);
-            ref = _ref;
-        }
+        if(IsCreated())
+            slot->count++;
     }
 
     Ref::Ref(Ref&& r) noexcept
         : state(std::exchange(r.state, nullptr)),
-          ref(r.ref)
+          slot(std::exchange(r.slot, nullptr))
     {}
 
     Ref& Ref::operator=(const Ref& r) noexcept
     {
+        //r may be the last owner of the slot besides this
+        if(r.IsCreated())
+            r.slot->count++;
+
         Unref();
 
         state = r.state;
-        if(!r.IsCreated())
-            ref = LUA_REFNIL;
-        else
-        {
-            Stack<Ref>::Push(r.state, r);
-            int _ref = luaL_ref(r.state, LUA_REGISTRYINDEX);
-            ref = _ref;
-        }
+        slot = r.slot;
 
         return *this;
     }
 
     Ref& Ref::operator=(Ref&& r) noexcept
     {
+        if(this == &r)
+            return *this;
+
         Unref();
 
         state = std::exchange(r.state, nullptr);
-        ref = r.ref;
+        slot = std::exchange(r.slot, nullptr);
 
         return *this;
     }
@@ -73,8 +162,14 @@ namespace LuaWay
         if(!IsCreated())
             return;
 
-        luaL_unref(state, LUA_REGISTRYINDEX, ref);
+        if(--slot->count == 0)
+        {
+            luaL_unref(state, LUA_REGISTRYINDEX, slot->ref);
+            detail::release_ref_slot(slot);
+        }
+
         state = nullptr;
+        slot = nullptr;
     }
 
     VmType Ref::GetType() const noexcept
@@ -102,7 +197,7 @@ namespace LuaWay
 
     int Ref::GetRawIndex() const noexcept
     {
-        return ref;
+        return (IsCreated() ? slot->ref : LUA_REFNIL);
     }
 
     Ref Ref::GetMetatable() const noexcept
@@ -158,7 +253,8 @@ namespace LuaWay
     {
         hrs::assert_true_debug(IsCreated(), "Lua reference isn't created yet!");
 
-        lua_rawseti(state, LUA_REGISTRYINDEX, ref);
+        //copies share the slot, so the registry entry must never be written
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
         lua_pushnil(state);
         //ref, nil
         int res = lua_next(state, -2);
@@ -172,10 +268,11 @@ namespace LuaWay
         //ref, key, value
         lua_pop(state, 1);
         //ref, key
-        RefIterator iter(state, ref, luaL_ref(state, LUA_REGISTRYINDEX));
+        int key_ref = luaL_ref(state, LUA_REGISTRYINDEX);
         //ref
-        lua_pop(state, 1);
-        return iter;
+        //the iterator releases its refs itself, so it can't borrow the shared slot
+        int iterable_ref = luaL_ref(state, LUA_REGISTRYINDEX);
+        return RefIterator(state, iterable_ref, key_ref);
     }
 
     RefIterator Ref::end() const noexcept
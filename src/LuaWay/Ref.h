@@ -20,14 +20,37 @@ namespace LuaWay
     {};
 
     class RefIterator;
+    class RefView;
 
+    namespace detail
+    {
+        //registry slot shared by copies of a Ref, released with the last of them
+        struct ref_slot
+        {
+            int ref;
+            std::size_t count;
+            ref_slot* next_free;
+        };
+
+        //nullptr if the slot can't be allocated
+        ref_slot* acquire_ref_slot(int ref) noexcept;
+        void release_ref_slot(ref_slot* slot) noexcept;
+    };
+
+    //Copies share one registry slot through an intrusive counter, so only creation and
+    //the last destruction call luaL_ref/luaL_unref. The counter isn't atomic,
+    //like the Lua state itself a Ref must not be used by several threads at once
     class Ref
     {
     private:
+        //takes over _ref, the Ref stays empty and _ref is released if no slot is available
         Ref(lua_State* _state, int _ref) noexcept;
+        Ref(lua_State* _state, detail::ref_slot* _slot) noexcept;
     public:
         friend struct Stack<Ref>;
         friend class RefIterator;
+        friend class RefView;
+        friend class StackRef;
         friend class VMBase;
 
         Ref() noexcept;
@@ -94,7 +117,7 @@ namespace LuaWay
         hrs::expected<std::string, Status> Dump() const;
     private:
         lua_State* state;
-        int ref;
+        detail::ref_slot* slot;
     };
 
     template<>
@@ -130,7 +153,7 @@ namespace LuaWay
                                        FunctionResult,
                                        hrs::expected<FunctionResult, Status>>;
 
-        lua_rawgeti(state, LUA_REGISTRYINDEX, ref);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
         int pre_push_index = lua_gettop(state);
         ((Stack<std::remove_cvref_t<Args>>::Push(std::forward<Args>(args))), ...);
         int post_call_index;
@@ -298,7 +321,7 @@ namespace LuaWay
         hrs::assert_true_debug(IsCreated(), "Lua reference isn't created yet!");
 
         hrs::assert_true_debug(Holds(VmType::Thread), "Only threads can be resumed!");
-        lua_rawgeti(state, LUA_REGISTRYINDEX, ref);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
         lua_State* co = lua_tothread(state, -1);
         lua_pop(state, 1);
 
@@ -90,8 +90,11 @@ namespace LuaWay
         int value_ref = luaL_ref(state, LUA_REGISTRYINDEX);
         //iter
         lua_pop(state, 1);
+        //the key stays owned by the iterator
+        lua_rawgeti(state, LUA_REGISTRYINDEX, key_ref);
+        int out_key_ref = luaL_ref(state, LUA_REGISTRYINDEX);
 
-        return std::pair{Ref(state, key_ref), Ref(state, value_ref)};
+        return std::pair{Ref(state, out_key_ref), Ref(state, value_ref)};
     }
 
     RefIterator RefIterator::operator++(int) noexcept
@@ -147,6 +150,9 @@ namespace LuaWay
         luaL_unref(state, LUA_REGISTRYINDEX, iterable_ref);
         luaL_unref(state, LUA_REGISTRYINDEX, key_ref);
 
+        //must compare equal to end()
         state = nullptr;
+        iterable_ref = LUA_REFNIL;
+        key_ref = LUA_REFNIL;
     }
 };
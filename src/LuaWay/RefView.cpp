@@ -0,0 +1,127 @@
+#include "RefView.h"
+
+namespace LuaWay
+{
+    RefView::RefView() noexcept
+        : state(nullptr),
+          slot(nullptr)
+    {}
+
+    RefView::RefView(const Ref& r) noexcept
+        : state(r.state),
+          slot(r.slot)
+    {}
+
+    bool RefView::IsCreated() const noexcept
+    {
+        return state != nullptr;
+    }
+
+    VmType RefView::GetType() const noexcept
+    {
+        if(!IsCreated())
+            return VmType::None;
+
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
+        VmType vm_type = LuaWay::GetType(state, -1);
+        lua_pop(state, 1);
+        return vm_type;
+    }
+
+    bool RefView::Holds(VmType vm_type) const noexcept
+    {
+        return GetType() == vm_type;
+    }
+
+    lua_State* RefView::GetState() const noexcept
+    {
+        return state;
+    }
+
+    int RefView::GetRawIndex() const noexcept
+    {
+        return (IsCreated() ? slot->ref : LUA_REFNIL);
+    }
+
+    Ref RefView::ToRef() const noexcept
+    {
+        if(!IsCreated())
+            return Ref{};
+
+        return Ref(state, slot);
+    }
+
+    StackRef::StackRef() noexcept
+        : state(nullptr),
+          index(0)
+    {}
+
+    StackRef::StackRef(lua_State* _state, int _index) noexcept
+        : state(_state),
+          index(_index > 0 || _index <= LUA_REGISTRYINDEX ? _index
+                                                          : lua_gettop(_state) + _index + 1)
+    {}
+
+    bool StackRef::IsCreated() const noexcept
+    {
+        return state != nullptr;
+    }
+
+    VmType StackRef::GetType() const noexcept
+    {
+        if(!IsCreated())
+            return VmType::None;
+
+        return LuaWay::GetType(state, index);
+    }
+
+    bool StackRef::Holds(VmType vm_type) const noexcept
+    {
+        return GetType() == vm_type;
+    }
+
+    lua_State* StackRef::GetState() const noexcept
+    {
+        return state;
+    }
+
+    int StackRef::GetIndex() const noexcept
+    {
+        return index;
+    }
+
+    std::size_t StackRef::GetLength() const noexcept
+    {
+        hrs::assert_true_debug(IsCreated(), "Stack reference isn't created yet!");
+
+        return lua_objlen(state, index);
+    }
+
+    Ref StackRef::ToRef() const noexcept
+    {
+        if(!IsCreated())
+            return Ref{};
+
+        return Stack<Ref>::Retrieve(state, index);
+    }
+
+    void Stack<RefView>::Push(lua_State* state, const Type& value) noexcept
+    {
+        lua_rawgeti(state, LUA_REGISTRYINDEX, value.GetRawIndex());
+    }
+
+    void Stack<StackRef>::Push(lua_State* state, const Type& value) noexcept
+    {
+        lua_pushvalue(state, value.GetIndex());
+    }
+
+    Stack<StackRef>::Type Stack<StackRef>::Retrieve(lua_State* state, int index) noexcept
+    {
+        return StackRef(state, index);
+    }
+
+    bool Stack<StackRef>::ConvertibleFromVm(VmType vm_type) noexcept
+    {
+        return true;
+    }
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "Ref.h"
+
+namespace LuaWay
+{
+    namespace detail
+    {
+        //the value is on top of the stack and is popped
+        template<Retrievable T>
+        auto pop_as(lua_State* state) noexcept(NoexceptRetrievable<T>)
+        {
+            using out_t = retrieve_value_type_for_non_ref_wrapper<T>::out_t;
+
+            if(!Stack<T>::ConvertibleFromVm(LuaWay::GetType(state, -1)))
+            {
+                lua_pop(state, 1);
+                return std::optional<out_t>{};
+            }
+
+            auto out_val = retrieve_value_for_non_ref_wrapper<T>(state, -1);
+            lua_pop(state, 1);
+            return std::optional<out_t>{out_val};
+        }
+
+        //the table is on top of the stack and is popped
+        template<Retrievable T, Pushable K>
+        auto pop_get(lua_State* state,
+                     K&& key) noexcept(NoexceptPushable<K> && NoexceptRetrievable<T>)
+        {
+            Stack<std::remove_cvref_t<K>>::Push(state, std::forward<K>(key));
+            lua_gettable(state, -2);
+            //table, value
+            lua_remove(state, -2);
+            return pop_as<T>(state);
+        }
+
+        //the table is on top of the stack and is popped
+        template<Pushable K, Pushable V>
+        void pop_set(lua_State* state,
+                     K&& key,
+                     V&& value) noexcept(NoexceptPushable<K> && NoexceptPushable<V>)
+        {
+            Stack<std::remove_cvref_t<K>>::Push(state, std::forward<K>(key));
+            Stack<std::remove_cvref_t<V>>::Push(state, std::forward<V>(value));
+            //table, key, value
+            lua_settable(state, -3);
+            lua_pop(state, 1);
+        }
+    };
+
+    //Borrowed Ref, copies never touch the counter or the registry.
+    //The viewed Ref must outlive the view
+    class RefView
+    {
+    public:
+        RefView() noexcept;
+        RefView(const Ref& r) noexcept;
+        ~RefView() = default;
+        RefView(const RefView&) = default;
+        RefView& operator=(const RefView&) = default;
+
+        bool IsCreated() const noexcept;
+
+        VmType GetType() const noexcept;
+        bool Holds(VmType vm_type) const noexcept;
+
+        lua_State* GetState() const noexcept;
+        int GetRawIndex() const noexcept;
+
+        //shares the slot of the viewed Ref
+        Ref ToRef() const noexcept;
+
+        template<Retrievable T>
+        auto As() const noexcept(NoexceptRetrievable<T>);
+
+        template<Retrievable T, Pushable K>
+        auto Get(K&& key) const noexcept(NoexceptPushable<K> && NoexceptRetrievable<T>);
+
+        template<Pushable K, Pushable V>
+        void Set(K&& key, V&& value) const noexcept(NoexceptPushable<K> && NoexceptPushable<V>);
+    private:
+        lua_State* state;
+        detail::ref_slot* slot;
+    };
+
+    //Borrowed stack slot, e.g. an argument of a wrapped function, the index is absolute.
+    //Never touches the registry, valid while the slot stays on the stack
+    class StackRef
+    {
+    public:
+        StackRef() noexcept;
+        StackRef(lua_State* _state, int _index) noexcept;
+        ~StackRef() = default;
+        StackRef(const StackRef&) = default;
+        StackRef& operator=(const StackRef&) = default;
+
+        bool IsCreated() const noexcept;
+
+        VmType GetType() const noexcept;
+        bool Holds(VmType vm_type) const noexcept;
+
+        lua_State* GetState() const noexcept;
+        int GetIndex() const noexcept;
+
+        std::size_t GetLength() const noexcept;
+
+        //takes a new registry slot for values that must outlive the stack slot
+        Ref ToRef() const noexcept;
+
+        template<Retrievable T>
+        auto As() const noexcept(NoexceptRetrievable<T>);
+
+        template<Retrievable T, Pushable K>
+        auto Get(K&& key) const noexcept(NoexceptPushable<K> && NoexceptRetrievable<T>);
+
+        template<Pushable K, Pushable V>
+        void Set(K&& key, V&& value) const noexcept(NoexceptPushable<K> && NoexceptPushable<V>);
+    private:
+        lua_State* state;
+        int index;
+    };
+
+    template<>
+    struct Stack<RefView>
+    {
+        using Type = RefView;
+
+        static void Push(lua_State* state, const Type& value) noexcept;
+    };
+
+    template<>
+    struct Stack<StackRef>
+    {
+        using Type = StackRef;
+
+        static void Push(lua_State* state, const Type& value) noexcept;
+
+        static Type Retrieve(lua_State* state, int index) noexcept;
+
+        static bool ConvertibleFromVm(VmType vm_type) noexcept;
+    };
+
+    template<Retrievable T>
+    auto RefView::As() const noexcept(NoexceptRetrievable<T>)
+    {
+        hrs::assert_true_debug(IsCreated(), "Lua reference isn't created yet!");
+
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
+        return detail::pop_as<T>(state);
+    }
+
+    template<Retrievable T, Pushable K>
+    auto RefView::Get(K&& key) const noexcept(NoexceptPushable<K> && NoexceptRetrievable<T>)
+    {
+        hrs::assert_true_debug(IsCreated(), "Lua reference isn't created yet!");
+
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
+        return detail::pop_get<T>(state, std::forward<K>(key));
+    }
+
+    template<Pushable K, Pushable V>
+    void RefView::Set(K&& key, V&& value) const noexcept(NoexceptPushable<K> && NoexceptPushable<V>)
+    {
+        hrs::assert_true_debug(IsCreated(), "Lua reference isn't created yet!");
+
+        lua_rawgeti(state, LUA_REGISTRYINDEX, slot->ref);
+        detail::pop_set(state, std::forward<K>(key), std::forward<V>(value));
+    }
+
+    template<Retrievable T>
+    auto StackRef::As() const noexcept(NoexceptRetrievable<T>)
+    {
+        hrs::assert_true_debug(IsCreated(), "Stack reference isn't created yet!");
+
+        lua_pushvalue(state, index);
+        return detail::pop_as<T>(state);
+    }
+
+    template<Retrievable T, Pushable K>
+    auto StackRef::Get(K&& key) const noexcept(NoexceptPushable<K> && NoexceptRetrievable<T>)
+    {
+        hrs::assert_true_debug(IsCreated(), "Stack reference isn't created yet!");
+
+        lua_pushvalue(state, index);
+        return detail::pop_get<T>(state, std::forward<K>(key));
+    }
+
+    template<Pushable K, Pushable V>
+    void StackRef::Set(K&& key,
+                       V&& value) const noexcept(NoexceptPushable<K> && NoexceptPushable<V>)
+    {
+        hrs::assert_true_debug(IsCreated(), "Stack reference isn't created yet!");
+
+        lua_pushvalue(state, index);
+        detail::pop_set(state, std::forward<K>(key), std::forward<V>(value));
+    }
+};
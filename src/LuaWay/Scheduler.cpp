@@ -0,0 +1,444 @@
+#include "Scheduler.h"
+#include <algorithm>
+
+namespace LuaWay
+{
+    void Scheduler::task_list::PushBack(task* t) noexcept
+    {
+        t->prev = tail;
+        t->next = nullptr;
+        t->list = this;
+        if(tail)
+            tail->next = t;
+        else
+            head = t;
+
+        tail = t;
+        size++;
+    }
+
+    void Scheduler::task_list::Remove(task* t) noexcept
+    {
+        if(t->prev)
+            t->prev->next = t->next;
+        else
+            head = t->next;
+
+        if(t->next)
+            t->next->prev = t->prev;
+        else
+            tail = t->prev;
+
+        t->prev = nullptr;
+        t->next = nullptr;
+        t->list = nullptr;
+        size--;
+    }
+
+    Scheduler::task* Scheduler::task_list::PopFront() noexcept
+    {
+        task* t = head;
+        if(t)
+            Remove(t);
+
+        return t;
+    }
+
+    Scheduler::Scheduler(const VMBase& vm, const SchedulerSettings& _settings)
+        : state(vm.GetState()),
+          settings(_settings),
+          current(nullptr),
+          task_count(0),
+          tick(0),
+          time(0)
+    {}
+
+    Scheduler::~Scheduler()
+    {
+        for(auto& t: tasks)
+        {
+            luaL_unref(state, LUA_REGISTRYINDEX, t.thread_ref);
+            luaL_unref(state, LUA_REGISTRYINDEX, t.function_ref);
+        }
+
+        for(int ref: pooled_threads)
+            luaL_unref(state, LUA_REGISTRYINDEX, ref);
+    }
+
+    void Scheduler::RegisterLibrary(const char* library_name) noexcept
+    {
+        const luaL_Reg functions[] = {{"wait_frames", wait_frames_wrapper},
+                                      {"wait_time", wait_time_wrapper},
+                                      {"wait_event", wait_event_wrapper},
+                                      {"signal", signal_wrapper},
+                                      {"spawn", spawn_wrapper}};
+
+        lua_createtable(state, 0, static_cast<int>(std::size(functions)));
+        for(const auto& func: functions)
+        {
+            lua_pushlightuserdata(state, this);
+            lua_pushcclosure(state, func.func, 1);
+            lua_setfield(state, -2, func.name);
+        }
+
+        lua_setglobal(state, library_name);
+    }
+
+    TaskId Scheduler::Spawn(const Ref& func)
+    {
+        if(!(func.Holds(VmType::Function) || func.Holds(VmType::CFunction)))
+            return 0;
+
+        Stack<Ref>::Push(state, func);
+        TaskId id = spawn_from_stack(state, -1);
+        lua_pop(state, 1);
+        return id;
+    }
+
+    bool Scheduler::Cancel(TaskId id) noexcept
+    {
+        task* t = get_task(id);
+        if(!t)
+            return false;
+
+        //a running task is removed when it yields
+        if(t == current)
+            t->cancelled = true;
+        else
+            release_task(t, false);
+
+        return true;
+    }
+
+    bool Scheduler::IsAlive(TaskId id) const noexcept
+    {
+        return get_task(id) != nullptr;
+    }
+
+    void Scheduler::Signal(std::string_view event)
+    {
+        auto it = events.find(event);
+        if(it == events.end())
+            return;
+
+        while(task* t = it->second.PopFront())
+            make_ready(t);
+    }
+
+    std::size_t Scheduler::Update(double delta_time)
+    {
+        tick++;
+        time += delta_time;
+        wake_due_tasks();
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t pass_count = ready.size;
+        std::size_t resumed = 0;
+        for(; resumed < pass_count; resumed++)
+        {
+            //at least one task per frame, so a long task can't stall the queue
+            if(settings.frame_budget.count() != 0 && resumed != 0 &&
+               std::chrono::steady_clock::now() - start >= settings.frame_budget)
+                break;
+
+            //a resumed task may have killed the rest of the pass
+            task* t = ready.PopFront();
+            if(!t)
+                break;
+
+            resume(t);
+        }
+
+        return resumed;
+    }
+
+    void Scheduler::SetErrorCallback(std::function<void(TaskId, const Status&)> callback)
+    {
+        error_callback = std::move(callback);
+    }
+
+    std::size_t Scheduler::GetTaskCount() const noexcept
+    {
+        return task_count;
+    }
+
+    std::size_t Scheduler::GetReadyCount() const noexcept
+    {
+        return ready.size;
+    }
+
+    std::size_t Scheduler::GetPooledThreadCount() const noexcept
+    {
+        return pooled_threads.size();
+    }
+
+    std::uint64_t Scheduler::GetTick() const noexcept
+    {
+        return tick;
+    }
+
+    double Scheduler::GetTime() const noexcept
+    {
+        return time;
+    }
+
+    int Scheduler::wait_frames_wrapper(lua_State* state)
+    {
+        auto* scheduler = static_cast<Scheduler*>(lua_touserdata(state, lua_upvalueindex(1)));
+        task* t = scheduler->check_current_task(state);
+        lua_Integer frames = std::max<lua_Integer>(luaL_optinteger(state, 1, 1), 1);
+
+        t->wait = wait_kind::Frames;
+        t->wake_tick = scheduler->tick + static_cast<std::uint64_t>(frames);
+        scheduler->wheel[t->wake_tick % WHEEL_SIZE].PushBack(t);
+        return lua_yield(state, 0);
+    }
+
+    int Scheduler::wait_time_wrapper(lua_State* state)
+    {
+        auto* scheduler = static_cast<Scheduler*>(lua_touserdata(state, lua_upvalueindex(1)));
+        task* t = scheduler->check_current_task(state);
+        lua_Number seconds = luaL_checknumber(state, 1);
+
+        t->wait = wait_kind::Time;
+        t->wake_time = scheduler->time + seconds;
+        scheduler->timers.push_back(timer{t->wake_time, t->index, t->generation});
+        std::push_heap(scheduler->timers.begin(), scheduler->timers.end(), std::greater<>{});
+        return lua_yield(state, 0);
+    }
+
+    int Scheduler::wait_event_wrapper(lua_State* state)
+    {
+        auto* scheduler = static_cast<Scheduler*>(lua_touserdata(state, lua_upvalueindex(1)));
+        task* t = scheduler->check_current_task(state);
+        std::size_t len;
+        const char* str = luaL_checklstring(state, 1, &len);
+        std::string_view event(str, len);
+
+        auto it = scheduler->events.find(event);
+        if(it == scheduler->events.end())
+            it = scheduler->events.emplace(std::string(event), task_list{}).first;
+
+        t->wait = wait_kind::Event;
+        it->second.PushBack(t);
+        return lua_yield(state, 0);
+    }
+
+    int Scheduler::signal_wrapper(lua_State* state)
+    {
+        auto* scheduler = static_cast<Scheduler*>(lua_touserdata(state, lua_upvalueindex(1)));
+        std::size_t len;
+        const char* str = luaL_checklstring(state, 1, &len);
+        scheduler->Signal(std::string_view(str, len));
+        return 0;
+    }
+
+    int Scheduler::spawn_wrapper(lua_State* state)
+    {
+        auto* scheduler = static_cast<Scheduler*>(lua_touserdata(state, lua_upvalueindex(1)));
+        luaL_checktype(state, 1, LUA_TFUNCTION);
+        scheduler->spawn_from_stack(state, 1);
+        return 0;
+    }
+
+    TaskId Scheduler::make_id(std::uint32_t index, std::uint32_t generation) noexcept
+    {
+        return (static_cast<TaskId>(generation) << 32) | index;
+    }
+
+    Scheduler::task* Scheduler::get_task(TaskId id) const noexcept
+    {
+        auto index = static_cast<std::uint32_t>(id);
+        auto generation = static_cast<std::uint32_t>(id >> 32);
+        if(index >= tasks.size())
+            return nullptr;
+
+        const task& t = tasks[index];
+        if(!t.alive || t.generation != generation)
+            return nullptr;
+
+        return const_cast<task*>(&t);
+    }
+
+    TaskId Scheduler::get_id(const task* t) const noexcept
+    {
+        return make_id(t->index, t->generation);
+    }
+
+    Scheduler::task* Scheduler::check_current_task(lua_State* thread) const
+    {
+        if(!current || current->thread != thread)
+            luaL_error(thread, "scheduler waits must be called from a scheduled task");
+
+        return current;
+    }
+
+    TaskId Scheduler::spawn_from_stack(lua_State* thread, int index)
+    {
+        task* t;
+        if(free_tasks.empty())
+        {
+            hrs::assert_true_debug(tasks.size() < UINT32_MAX, "Task count overflow!");
+            t = &tasks.emplace_back();
+            t->index = static_cast<std::uint32_t>(tasks.size() - 1);
+            //ids are never 0
+            t->generation = 1;
+        }
+        else
+        {
+            t = &tasks[free_tasks.back()];
+            free_tasks.pop_back();
+        }
+
+        t->prev = nullptr;
+        t->next = nullptr;
+        t->list = nullptr;
+        t->thread = nullptr;
+        t->thread_ref = LUA_NOREF;
+        lua_pushvalue(thread, index);
+        t->function_ref = luaL_ref(thread, LUA_REGISTRYINDEX);
+        t->alive = true;
+        t->cancelled = false;
+        task_count++;
+
+        make_ready(t);
+        return get_id(t);
+    }
+
+    void Scheduler::acquire_thread(task* t)
+    {
+        if(pooled_threads.empty())
+        {
+            t->thread = lua_newthread(state);
+            t->thread_ref = luaL_ref(state, LUA_REGISTRYINDEX);
+            return;
+        }
+
+        t->thread_ref = pooled_threads.back();
+        pooled_threads.pop_back();
+        lua_rawgeti(state, LUA_REGISTRYINDEX, t->thread_ref);
+        t->thread = lua_tothread(state, -1);
+        lua_pop(state, 1);
+    }
+
+    void Scheduler::release_task(task* t, bool reuse_thread) noexcept
+    {
+        unlink(t);
+        if(t->thread)
+        {
+            //only a finished thread can run a new function, a suspended one is dropped
+            if(reuse_thread && pooled_threads.size() < settings.max_pooled_threads)
+            {
+                lua_settop(t->thread, 0);
+                pooled_threads.push_back(t->thread_ref);
+            }
+            else
+                luaL_unref(state, LUA_REGISTRYINDEX, t->thread_ref);
+        }
+
+        luaL_unref(state, LUA_REGISTRYINDEX, t->function_ref);
+        t->thread = nullptr;
+        t->thread_ref = LUA_NOREF;
+        t->function_ref = LUA_NOREF;
+        t->alive = false;
+        t->wait = wait_kind::None;
+        t->generation++;
+        //ids are never 0
+        if(t->generation == 0)
+            t->generation = 1;
+
+        free_tasks.push_back(t->index);
+        task_count--;
+    }
+
+    void Scheduler::unlink(task* t) noexcept
+    {
+        //timers of dead or woken tasks are skipped when they expire
+        if(t->list)
+            t->list->Remove(t);
+    }
+
+    void Scheduler::make_ready(task* t) noexcept
+    {
+        t->wait = wait_kind::Ready;
+        ready.PushBack(t);
+    }
+
+    void Scheduler::wake_due_tasks() noexcept
+    {
+        task_list& slot = wheel[tick % WHEEL_SIZE];
+        for(task* t = slot.head; t;)
+        {
+            task* next = t->next;
+            //later laps of the wheel stay in the slot
+            if(t->wake_tick <= tick)
+            {
+                slot.Remove(t);
+                make_ready(t);
+            }
+
+            t = next;
+        }
+
+        while(!timers.empty() && timers.front().wake_time <= time)
+        {
+            std::pop_heap(timers.begin(), timers.end(), std::greater<>{});
+            timer expired = timers.back();
+            timers.pop_back();
+
+            task& t = tasks[expired.index];
+            if(t.alive && t.generation == expired.generation && t.wait == wait_kind::Time)
+                make_ready(&t);
+        }
+    }
+
+    void Scheduler::resume(task* t)
+    {
+        if(!t->thread)
+        {
+            acquire_thread(t);
+            lua_rawgeti(t->thread, LUA_REGISTRYINDEX, t->function_ref);
+            luaL_unref(state, LUA_REGISTRYINDEX, t->function_ref);
+            t->function_ref = LUA_NOREF;
+        }
+
+        t->wait = wait_kind::None;
+        current = t;
+        int res = lua_resume(t->thread, 0);
+        current = nullptr;
+
+        if(t->cancelled)
+        {
+            release_task(t, res == 0);
+            return;
+        }
+
+        switch(res)
+        {
+            case LUA_YIELD:
+            {
+                lua_settop(t->thread, 0);
+                if(t->wait == wait_kind::None)
+                {
+                    t->wait = wait_kind::Frames;
+                    t->wake_tick = tick + 1;
+                    wheel[t->wake_tick % WHEEL_SIZE].PushBack(t);
+                }
+            }
+            break;
+            case 0:
+                release_task(t, true);
+                break;
+            default:
+            {
+                const char* message = lua_tostring(t->thread, -1);
+                Status status(static_cast<StatusCode>(res), message ? message : "non-string error");
+                TaskId id = get_id(t);
+                release_task(t, false);
+                if(error_callback)
+                    error_callback(id, status);
+            }
+            break;
+        }
+    }
+};
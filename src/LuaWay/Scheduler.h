@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Ref.h"
+#include "Status.h"
+#include "VMBase.h"
+#include "hrs/non_creatable.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace LuaWay
+{
+    //index in the low half, generation in the high half, 0 - no task
+    using TaskId = std::uint64_t;
+
+    struct SchedulerSettings
+    {
+        std::chrono::nanoseconds frame_budget; //0 - resume every ready task each frame
+        std::size_t max_pooled_threads;
+    };
+
+    //Resumes script coroutines that wait for frames, time or named events.
+    //Scripts wait through the registered library:
+    //  scheduler.wait_frames(n), scheduler.wait_time(seconds), scheduler.wait_event(name),
+    //  scheduler.signal(name), scheduler.spawn(func).
+    //Only tasks whose condition is met are visited: frame waits sit in a timing wheel of
+    //intrusive lists keyed by wake tick, time waits in a min-heap, event waits in per-event lists.
+    //Ready tasks are resumed in FIFO order until the frame budget runs out, the rest keep their
+    //place for the next frame. Threads of finished tasks are reused by new ones.
+    //A plain coroutine.yield waits for one frame. Must be destroyed before the VM
+    class Scheduler : public hrs::non_copyable
+    {
+    public:
+        constexpr static std::size_t WHEEL_SIZE = 256;
+
+        Scheduler(const VMBase& vm, const SchedulerSettings& settings);
+        ~Scheduler();
+
+        void RegisterLibrary(const char* library_name) noexcept;
+
+        //func starts on the next Update, returns 0 if func isn't a function
+        TaskId Spawn(const Ref& func);
+        bool Cancel(TaskId id) noexcept;
+        bool IsAlive(TaskId id) const noexcept;
+
+        //makes every task waiting for event ready
+        void Signal(std::string_view event);
+
+        //advances one frame and resumes the tasks that were ready before the resume pass,
+        //tasks woken during the pass run on the next frame. Returns the number of resumed tasks
+        std::size_t Update(double delta_time);
+
+        //called for tasks that finished with an error, such tasks are removed
+        void SetErrorCallback(std::function<void(TaskId, const Status&)> callback);
+
+        std::size_t GetTaskCount() const noexcept;
+        std::size_t GetReadyCount() const noexcept;
+        std::size_t GetPooledThreadCount() const noexcept;
+        std::uint64_t GetTick() const noexcept;
+        double GetTime() const noexcept;
+    private:
+        enum class wait_kind
+        {
+            None,
+            Ready,
+            Frames,
+            Time,
+            Event
+        };
+
+        struct task_list;
+
+        struct task
+        {
+            task* prev;
+            task* next;
+            task_list* list;
+            lua_State* thread;
+            int thread_ref;
+            int function_ref; //LUA_NOREF once started
+            std::uint32_t index;
+            std::uint32_t generation;
+            bool alive;
+            bool cancelled;
+            wait_kind wait;
+            std::uint64_t wake_tick;
+            double wake_time;
+        };
+
+        struct task_list
+        {
+            task* head = nullptr;
+            task* tail = nullptr;
+            std::size_t size = 0;
+
+            void PushBack(task* t) noexcept;
+            void Remove(task* t) noexcept;
+            task* PopFront() noexcept;
+        };
+
+        struct timer
+        {
+            double wake_time;
+            std::uint32_t index;
+            std::uint32_t generation;
+
+            bool operator>(const timer& t) const noexcept
+            {
+                return wake_time > t.wake_time;
+            }
+        };
+
+        struct string_hash
+        {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view str) const noexcept
+            {
+                return std::hash<std::string_view>{}(str);
+            }
+        };
+
+        static int wait_frames_wrapper(lua_State* state);
+        static int wait_time_wrapper(lua_State* state);
+        static int wait_event_wrapper(lua_State* state);
+        static int signal_wrapper(lua_State* state);
+        static int spawn_wrapper(lua_State* state);
+
+        static TaskId make_id(std::uint32_t index, std::uint32_t generation) noexcept;
+        task* get_task(TaskId id) const noexcept;
+        TaskId get_id(const task* t) const noexcept;
+        task* check_current_task(lua_State* thread) const;
+        TaskId spawn_from_stack(lua_State* thread, int index);
+        void acquire_thread(task* t);
+        void release_task(task* t, bool reuse_thread) noexcept;
+        void unlink(task* t) noexcept;
+        void make_ready(task* t) noexcept;
+        void wake_due_tasks() noexcept;
+        void resume(task* t);
+    private:
+        lua_State* state;
+        SchedulerSettings settings;
+        std::deque<task> tasks;
+        std::vector<std::uint32_t> free_tasks;
+        std::vector<int> pooled_threads;
+        std::array<task_list, WHEEL_SIZE> wheel;
+        std::vector<timer> timers;
+        std::unordered_map<std::string, task_list, string_hash, std::equal_to<>> events;
+        task_list ready;
+        task* current;
+        std::size_t task_count;
+        std::uint64_t tick;
+        double time;
+        std::function<void(TaskId, const Status&)> error_callback;
+    };
+};
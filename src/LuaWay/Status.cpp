@@ -4,7 +4,7 @@ namespace LuaWay
 {
     Status::Status()
         : code(StatusCode::Success),
-          message(nullptr)
+          message()
     {}
 
     Status::Status(StatusCode _code, const char* _message)
@@ -3,8 +3,9 @@
 
 namespace LuaWay
 {
-    VM::VM(lua_State* _state) noexcept
-        : VMBase(_state)
+    VM::VM(lua_State* _state, std::unique_ptr<PoolAllocator> _allocator) noexcept
+        : VMBase(_state),
+          allocator(std::move(_allocator))
     {}
 
     VM::VM()
@@ -17,7 +18,8 @@ namespace LuaWay
     }
 
     VM::VM(VM&& vm) noexcept
-        : VMBase(std::exchange(vm.state, nullptr))
+        : VMBase(std::exchange(vm.state, nullptr)),
+          allocator(std::move(vm.allocator))
     {}
 
     VM& VM::operator=(VM&& vm) noexcept
@@ -25,30 +27,52 @@ namespace LuaWay
         Close();
 
         state = std::exchange(vm.state, nullptr);
+        allocator = std::move(vm.allocator);
 
         return *this;
     }
 
-    std::optional<VM> VM::Open(bool open_std_libs, int stack_size) noexcept
+    static void init_state(lua_State* state, bool open_std_libs, int stack_size) noexcept
     {
-        lua_State* _state = luaL_newstate();
-        if(!_state)
-            return {};
-
         if(open_std_libs)
-            luaL_openlibs(_state);
+            luaL_openlibs(state);
 
-        lua_checkstack(_state, stack_size);
+        lua_checkstack(state, stack_size);
 
-        lua_pushthread(_state);
-        int _ref = luaL_ref(_state, LUA_REGISTRYINDEX);
+        lua_pushthread(state);
+        int _ref = luaL_ref(state, LUA_REGISTRYINDEX);
         hrs::assert_true_debug(_ref == LUA_RIDX_MAINTHREAD,
                                "LUA_RIDX_MAINTHREAD HAS DIFFERENT REFERENCE "
                                "VALUE = {}! MUST BE = {}!",
                                _ref,
                                LUA_RIDX_MAINTHREAD);
+    }
+
+    std::optional<VM> VM::Open(bool open_std_libs, int stack_size) noexcept
+    {
+        lua_State* _state = luaL_newstate();
+        if(!_state)
+            return {};
+
+        init_state(_state, open_std_libs, stack_size);
+        return VM(_state, nullptr);
+    }
+
+    std::optional<VM> VM::Open(bool open_std_libs,
+                               const PoolAllocatorSettings& allocator_settings,
+                               int stack_size) noexcept
+    {
+        auto _allocator =
+            std::unique_ptr<PoolAllocator>(new(std::nothrow) PoolAllocator(allocator_settings));
+        if(!_allocator)
+            return {};
+
+        lua_State* _state = lua_newstate(PoolAllocator::Allocate, _allocator.get());
+        if(!_state)
+            return {};
 
-        return VM(_state);
+        init_state(_state, open_std_libs, stack_size);
+        return VM(_state, std::move(_allocator));
     }
 
     void VM::Close() noexcept
@@ -58,5 +82,6 @@ namespace LuaWay
 
         lua_close(state);
         state = nullptr;
+        allocator.reset();
     }
 };
@@ -1,14 +1,16 @@
 #pragma once
 
+#include "PoolAllocator.h"
 #include "VMBase.h"
 #include "hrs/non_creatable.hpp"
+#include <memory>
 
 namespace LuaWay
 {
     class VM : public hrs::non_copyable, public VMBase
     {
     private:
-        VM(lua_State* _state) noexcept;
+        VM(lua_State* _state, std::unique_ptr<PoolAllocator> _allocator) noexcept;
     public:
         VM();
         ~VM();
@@ -17,6 +19,15 @@ namespace LuaWay
 
         static std::optional<VM> Open(bool open_std_libs, int stack_size = LUA_MINSTACK) noexcept;
 
+        //the state allocates through a PoolAllocator owned by the VM.
+        //LuaJIT on x64 accepts a custom allocator in lua_newstate only when built with GC64,
+        //other builds fail to create the state and nullopt is returned
+        static std::optional<VM> Open(bool open_std_libs,
+                                      const PoolAllocatorSettings& allocator_settings,
+                                      int stack_size = LUA_MINSTACK) noexcept;
+
         void Close() noexcept;
+    private:
+        std::unique_ptr<PoolAllocator> allocator;
     };
 };
@@ -1,11 +1,16 @@
 #include "VMBase.h"
+#include "BytecodeCache.h"
 #include "Common.h"
 #include "Stack.h"
 #include "VmType.h"
 #include <lua.hpp>
+#include <new>
 
 namespace LuaWay
 {
+    //address is the registry key of the bytecode cache
+    static char BYTECODE_CACHE_KEY;
+
     VMBase::VMBase(lua_State* _state) noexcept
         : state(_state)
     {}
@@ -182,6 +187,51 @@ namespace LuaWay
         return kbytes * 1024;
     }
 
+    PoolAllocator* VMBase::GetPoolAllocator() const noexcept
+    {
+        hrs::assert_true_debug(IsOpen(), "Lua VM isn't opened yet!");
+
+        void* ud;
+        lua_Alloc allocator = lua_getallocf(state, &ud);
+        if(allocator != PoolAllocator::Allocate)
+            return nullptr;
+
+        return static_cast<PoolAllocator*>(ud);
+    }
+
+    std::optional<PoolAllocatorStatistics> VMBase::GetAllocatorStatistics() const noexcept
+    {
+        PoolAllocator* allocator = GetPoolAllocator();
+        if(!allocator)
+            return {};
+
+        return allocator->GetStatistics();
+    }
+
+    void VMBase::SetBytecodeCache(BytecodeCache* cache) const noexcept
+    {
+        hrs::assert_true_debug(IsOpen(), "Lua VM isn't opened yet!");
+
+        lua_pushlightuserdata(state, &BYTECODE_CACHE_KEY);
+        if(cache)
+            lua_pushlightuserdata(state, cache);
+        else
+            lua_pushnil(state);
+
+        lua_rawset(state, LUA_REGISTRYINDEX);
+    }
+
+    BytecodeCache* VMBase::GetBytecodeCache() const noexcept
+    {
+        hrs::assert_true_debug(IsOpen(), "Lua VM isn't opened yet!");
+
+        lua_pushlightuserdata(state, &BYTECODE_CACHE_KEY);
+        lua_rawget(state, LUA_REGISTRYINDEX);
+        auto* cache = static_cast<BytecodeCache*>(lua_touserdata(state, -1));
+        lua_pop(state, 1);
+        return cache;
+    }
+
     void VMBase::SetGCPause(int pause) const noexcept
     {
         hrs::assert_true_debug(IsOpen(), "Lua VM isn't opened yet!");
@@ -266,7 +316,29 @@ namespace LuaWay
     {
         hrs::assert_true_debug(IsOpen(), "Lua VM isn't opened yet!");
 
-        return luaL_loadfile(state, fpath.string().c_str());
+        //exceptions become the error message, like a failed luaL_loadfile.
+        //Lua errors aren't std::exception and unwind as usual
+        int top = lua_gettop(state);
+        try
+        {
+            BytecodeCache* cache = GetBytecodeCache();
+            if(cache)
+                return cache->Load(state, fpath);
+
+            return luaL_loadfile(state, fpath.string().c_str());
+        }
+        catch(const std::bad_alloc&)
+        {
+            lua_settop(state, top);
+            lua_pushliteral(state, "not enough memory");
+            return LUA_ERRMEM;
+        }
+        catch(const std::exception& ex)
+        {
+            lua_settop(state, top);
+            lua_pushstring(state, ex.what());
+            return LUA_ERRFILE;
+        }
     }
 
     hrs::expected<FunctionResult, Status> VMBase::do_chunk(Ref env) const noexcept
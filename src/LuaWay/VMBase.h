@@ -2,6 +2,7 @@
 
 #include "FunctionResult.h"
 #include "NativeType.h"
+#include "PoolAllocator.h"
 #include "Ref.h"
 #include "Stack.h"
 #include "Status.h"
@@ -14,6 +15,8 @@
 
 namespace LuaWay
 {
+    class BytecodeCache;
+
     class VMBase
     {
     protected:
@@ -53,6 +56,13 @@ namespace LuaWay
         void RestartGC() const noexcept;
         void CollectGC() const noexcept;
         std::size_t GetUsedMemory() const noexcept;
+        //nullptr if the state wasn't opened with a PoolAllocator
+        PoolAllocator* GetPoolAllocator() const noexcept;
+        std::optional<PoolAllocatorStatistics> GetAllocatorStatistics() const noexcept;
+        //LoadFile and DoFile go through the cache, it's stored in the state and shared by all
+        //handles of it, nullptr turns it off. The cache must outlive its use by the state
+        void SetBytecodeCache(BytecodeCache* cache) const noexcept;
+        BytecodeCache* GetBytecodeCache() const noexcept;
         void SetGCPause(int pause) const noexcept;
         void MakeGCStep(int step_size) const noexcept;
         void SetGCStepMul(int step_mul) const noexcept;
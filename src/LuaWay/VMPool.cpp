@@ -0,0 +1,270 @@
+#include "VMPool.h"
+#include "hrs/parallel_for.hpp"
+#include <cstring>
+#include <limits>
+
+namespace LuaWay
+{
+    constexpr static std::size_t MESSAGE_HEADER_SIZE = sizeof(std::uint32_t) * 2;
+
+    VMPool::VMPool() noexcept
+        : job(nullptr),
+          job_generation(0),
+          pending_jobs(0),
+          stopping(false)
+    {}
+
+    VMPool::~VMPool()
+    {
+        Close();
+    }
+
+    Status VMPool::Open(const VMPoolSettings& settings, const VMPoolInitializer& initializer)
+    {
+        Close();
+
+        std::size_t vm_count =
+            (settings.vm_count == 0 ? hrs::hardware_thread_count() : settings.vm_count);
+        const char* library_name = (settings.library_name ? settings.library_name : "vmpool");
+        workers.reserve(vm_count);
+        for(std::size_t i = 0; i < vm_count; i++)
+        {
+            auto vm = (settings.allocator_settings
+                           ? VM::Open(settings.open_std_libs, *settings.allocator_settings)
+                           : VM::Open(settings.open_std_libs));
+            if(!vm)
+            {
+                Close();
+                return Status(StatusCode::MemoryError, "Failed to open a VM!");
+            }
+
+            auto w = std::make_unique<worker>();
+            w->pool = this;
+            w->index = i;
+            w->vm = std::move(*vm);
+            register_library(*w, library_name, vm_count);
+            workers.push_back(std::move(w));
+
+            if(initializer && !initializer(workers.back()->vm, i))
+            {
+                Close();
+                return Status(StatusCode::InnerError, "VM initializer failed!");
+            }
+        }
+
+        stopping = false;
+        job = nullptr;
+        pending_jobs = 0;
+        //the first VM is served by the calling thread
+        for(std::size_t i = 1; i < workers.size(); i++)
+            workers[i]->thread =
+                std::thread(&VMPool::worker_loop, this, std::ref(*workers[i]), job_generation);
+
+        return Status();
+    }
+
+    void VMPool::Close() noexcept
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+
+        job_ready.notify_all();
+        for(auto& w: workers)
+            if(w->thread.joinable())
+                w->thread.join();
+
+        workers.clear();
+    }
+
+    bool VMPool::IsOpen() const noexcept
+    {
+        return !workers.empty();
+    }
+
+    void VMPool::Run(const VMPoolJob& _job)
+    {
+        hrs::assert_true_debug(IsOpen(), "VM pool isn't opened yet!");
+
+        {
+            std::lock_guard lock(mutex);
+            job = &_job;
+            pending_jobs = workers.size() - 1;
+            job_generation++;
+        }
+
+        job_ready.notify_all();
+        _job(workers[0]->vm, 0);
+
+        std::unique_lock lock(mutex);
+        job_done.wait(lock,
+                      [this]()
+                      {
+                          return pending_jobs == 0;
+                      });
+        job = nullptr;
+    }
+
+    std::vector<Status> VMPool::CallGlobal(const char* function_name, double delta_time)
+    {
+        std::vector<Status> statuses(workers.size());
+        Run(
+            [&](const VMBase& vm, std::size_t index)
+            {
+                lua_State* state = vm.GetState();
+                lua_getglobal(state, function_name);
+                lua_pushnumber(state, delta_time);
+                int res = lua_pcall(state, 1, 0, 0);
+                if(res != 0)
+                {
+                    //error
+                    const char* message = lua_tostring(state, -1);
+                    statuses[index] = Status(static_cast<StatusCode>(res),
+                                             message ? message : "non-string error");
+                    lua_pop(state, 1);
+                }
+            });
+
+        return statuses;
+    }
+
+    std::size_t VMPool::GetShard(std::uint64_t key) const noexcept
+    {
+        //high bits of the product are the best mixed ones
+        std::uint64_t hash = (key * 0x9E3779B97F4A7C15) >> 32;
+        return static_cast<std::size_t>((hash * workers.size()) >> 32);
+    }
+
+    std::size_t VMPool::GetVMCount() const noexcept
+    {
+        return workers.size();
+    }
+
+    VMBase VMPool::GetVM(std::size_t index) const noexcept
+    {
+        hrs::assert_true_debug(index < workers.size(), "VM index is out of range!");
+
+        return workers[index]->vm;
+    }
+
+    bool VMPool::Send(std::size_t target, std::size_t sender, std::span<const std::byte> data)
+    {
+        if(target >= workers.size() || data.size() > std::numeric_limits<std::uint32_t>::max())
+            return false;
+
+        std::uint32_t header[2] = {static_cast<std::uint32_t>(sender),
+                                   static_cast<std::uint32_t>(data.size())};
+        auto header_bytes = reinterpret_cast<const std::byte*>(header);
+
+        inbox& messages = workers[target]->messages;
+        std::lock_guard lock(messages.mutex);
+        messages.incoming.insert(messages.incoming.end(),
+                                 header_bytes,
+                                 header_bytes + MESSAGE_HEADER_SIZE);
+        messages.incoming.insert(messages.incoming.end(), data.begin(), data.end());
+        return true;
+    }
+
+    int VMPool::send_wrapper(lua_State* state)
+    {
+        auto* w = static_cast<worker*>(lua_touserdata(state, lua_upvalueindex(1)));
+        lua_Number target = luaL_checknumber(state, 1);
+        luaL_checkany(state, 2);
+        if(target < 0 || target >= static_cast<lua_Number>(w->pool->workers.size()))
+        {
+            lua_pushboolean(state, false);
+            lua_pushstring(state, "target VM index is out of range");
+            return 2;
+        }
+
+        w->encoded.clear();
+        ValueCodecResult result = EncodeValue(state, 2, w->encoded);
+        if(result != ValueCodecResult::Success)
+        {
+            lua_pushboolean(state, false);
+            lua_pushstring(state,
+                           result == ValueCodecResult::UnsupportedType
+                               ? "value contains functions, userdata or threads"
+                               : "value is nested too deep");
+            return 2;
+        }
+
+        w->pool->Send(static_cast<std::size_t>(target), w->index, w->encoded);
+        lua_pushboolean(state, true);
+        return 1;
+    }
+
+    int VMPool::receive_wrapper(lua_State* state)
+    {
+        auto* w = static_cast<worker*>(lua_touserdata(state, lua_upvalueindex(1)));
+        inbox& messages = w->messages;
+        if(messages.read_position == messages.reading.size())
+        {
+            messages.reading.clear();
+            messages.read_position = 0;
+            std::lock_guard lock(messages.mutex);
+            messages.reading.swap(messages.incoming);
+        }
+
+        if(messages.reading.empty())
+            return 0;
+
+        std::uint32_t header[2];
+        std::memcpy(header, messages.reading.data() + messages.read_position, MESSAGE_HEADER_SIZE);
+        auto data = std::span<const std::byte>(messages.reading)
+                        .subspan(messages.read_position + MESSAGE_HEADER_SIZE, header[1]);
+        messages.read_position += MESSAGE_HEADER_SIZE + header[1];
+
+        std::size_t read;
+        if(DecodeValue(state, data, read) != ValueCodecResult::Success)
+            return luaL_error(state, "bad message from VM %d", static_cast<int>(header[0]));
+
+        lua_pushnumber(state, header[0]);
+        return 2;
+    }
+
+    void VMPool::register_library(worker& w, const char* library_name, std::size_t vm_count)
+    {
+        lua_State* state = w.vm.GetState();
+        lua_createtable(state, 0, 4);
+        lua_pushlightuserdata(state, &w);
+        lua_pushcclosure(state, send_wrapper, 1);
+        lua_setfield(state, -2, "send");
+        lua_pushlightuserdata(state, &w);
+        lua_pushcclosure(state, receive_wrapper, 1);
+        lua_setfield(state, -2, "receive");
+        lua_pushnumber(state, static_cast<lua_Number>(w.index));
+        lua_setfield(state, -2, "index");
+        lua_pushnumber(state, static_cast<lua_Number>(vm_count));
+        lua_setfield(state, -2, "count");
+        lua_setglobal(state, library_name);
+    }
+
+    void VMPool::worker_loop(worker& w, std::uint64_t seen_generation)
+    {
+        for(;;)
+        {
+            const VMPoolJob* current_job;
+            {
+                std::unique_lock lock(mutex);
+                job_ready.wait(lock,
+                               [&]()
+                               {
+                                   return stopping || job_generation != seen_generation;
+                               });
+                if(stopping)
+                    return;
+
+                seen_generation = job_generation;
+                current_job = job;
+            }
+
+            (*current_job)(w.vm, w.index);
+
+            std::lock_guard lock(mutex);
+            if(--pending_jobs == 0)
+                job_done.notify_one();
+        }
+    }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "PoolAllocator.h"
+#include "Status.h"
+#include "VM.h"
+#include "ValueCodec.h"
+#include "hrs/non_creatable.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace LuaWay
+{
+    struct VMPoolSettings
+    {
+        std::size_t vm_count; //0 - one VM per hardware thread
+        bool open_std_libs;
+        std::optional<PoolAllocatorSettings> allocator_settings; //VMs use PoolAllocators if set
+        const char* library_name; //global table of the channel functions, nullptr - "vmpool"
+    };
+
+    //called once per VM, registers libraries and preloads modules, false fails Open
+    using VMPoolInitializer = std::function<bool(const VMBase& vm, std::size_t index)>;
+    //called on the worker thread of the VM, must not throw
+    using VMPoolJob = std::function<void(const VMBase& vm, std::size_t index)>;
+
+    //Isolated VMs with one persistent worker thread each, the first VM runs on the calling thread.
+    //Values move between VMs through channels in the ValueCodec format, every VM has an inbox
+    //that is swapped out by its reader, so senders take the lock only to append.
+    //Lua side, VM indices are 0-based:
+    //  vmpool.send(index, value) -> true or false, error
+    //  vmpool.receive() -> value, sender index or nothing if the inbox is empty
+    //  vmpool.index, vmpool.count
+    class VMPool : public hrs::non_copyable, public hrs::non_movable
+    {
+    public:
+        VMPool() noexcept;
+        ~VMPool();
+
+        Status Open(const VMPoolSettings& settings, const VMPoolInitializer& initializer);
+        void Close() noexcept;
+        bool IsOpen() const noexcept;
+
+        //runs job on every VM in parallel and waits for all of them
+        void Run(const VMPoolJob& job);
+        //calls the global function(delta_time) on every VM in parallel, returns a status per VM
+        std::vector<Status> CallGlobal(const char* function_name, double delta_time);
+
+        //VM of an entity key, keys are spread by a multiplicative hash
+        std::size_t GetShard(std::uint64_t key) const noexcept;
+        std::size_t GetVMCount() const noexcept;
+        VMBase GetVM(std::size_t index) const noexcept;
+
+        //data must be a single value in the ValueCodec format, sender is reported to the reader
+        bool Send(std::size_t target, std::size_t sender, std::span<const std::byte> data);
+    private:
+        struct inbox
+        {
+            std::mutex mutex;
+            std::vector<std::byte> incoming; //[u32 sender][u32 size][value]...
+            std::vector<std::byte> reading; //swapped out incoming, owned by the VM thread
+            std::size_t read_position = 0;
+        };
+
+        struct worker
+        {
+            VMPool* pool;
+            std::size_t index;
+            VM vm;
+            inbox messages;
+            std::vector<std::byte> encoded; //send buffer
+            std::thread thread;
+        };
+
+        static int send_wrapper(lua_State* state);
+        static int receive_wrapper(lua_State* state);
+
+        void register_library(worker& w, const char* library_name, std::size_t vm_count);
+        void worker_loop(worker& w, std::uint64_t seen_generation);
+    private:
+        std::vector<std::unique_ptr<worker>> workers;
+        std::mutex mutex;
+        std::condition_variable job_ready;
+        std::condition_variable job_done;
+        const VMPoolJob* job;
+        std::uint64_t job_generation;
+        std::size_t pending_jobs;
+        bool stopping;
+    };
+};
@@ -0,0 +1,309 @@
+#include "ValueCodec.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace LuaWay
+{
+    enum class value_tag : std::uint8_t
+    {
+        Nil,
+        False,
+        True,
+        Integer,
+        Number,
+        String,
+        Table,
+        TableEnd
+    };
+
+    //integers up to 2^53 are exact in double
+    constexpr static double MAX_EXACT_INTEGER = 9007199254740992.0;
+
+    static void write_tag(std::vector<std::byte>& out, value_tag tag)
+    {
+        out.push_back(static_cast<std::byte>(tag));
+    }
+
+    static void write_varint(std::vector<std::byte>& out, std::uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            out.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<std::byte>(value));
+    }
+
+    static ValueCodecResult
+    encode_value(lua_State* state, int index, std::vector<std::byte>& out, int depth)
+    {
+        switch(lua_type(state, index))
+        {
+            case LUA_TNIL:
+                write_tag(out, value_tag::Nil);
+                break;
+            case LUA_TBOOLEAN:
+                write_tag(out, lua_toboolean(state, index) ? value_tag::True : value_tag::False);
+                break;
+            case LUA_TNUMBER:
+            {
+                lua_Number number = lua_tonumber(state, index);
+                if(std::trunc(number) == number && std::abs(number) <= MAX_EXACT_INTEGER &&
+                   !(number == 0 && std::signbit(number)))
+                {
+                    auto value = static_cast<std::int64_t>(number);
+                    write_tag(out, value_tag::Integer);
+                    write_varint(out,
+                                 (static_cast<std::uint64_t>(value) << 1) ^
+                                     static_cast<std::uint64_t>(value >> 63));
+                }
+                else
+                {
+                    write_tag(out, value_tag::Number);
+                    std::byte bytes[sizeof(number)];
+                    std::memcpy(bytes, &number, sizeof(number));
+                    out.insert(out.end(), std::begin(bytes), std::end(bytes));
+                }
+            }
+            break;
+            case LUA_TSTRING:
+            {
+                std::size_t len;
+                const char* str = lua_tolstring(state, index, &len);
+                write_tag(out, value_tag::String);
+                write_varint(out, len);
+                auto bytes = reinterpret_cast<const std::byte*>(str);
+                out.insert(out.end(), bytes, bytes + len);
+            }
+            break;
+            case LUA_TTABLE:
+            {
+                if(depth == VALUE_CODEC_MAX_DEPTH)
+                    return ValueCodecResult::TooDeep;
+
+                if(!lua_checkstack(state, 2))
+                    return ValueCodecResult::TooDeep;
+
+                if(index < 0 && index > LUA_REGISTRYINDEX)
+                    index = lua_gettop(state) + index + 1;
+
+                write_tag(out, value_tag::Table);
+                lua_pushnil(state);
+                while(lua_next(state, index))
+                {
+                    int top = lua_gettop(state);
+                    ValueCodecResult result = encode_value(state, top - 1, out, depth + 1);
+                    if(result == ValueCodecResult::Success)
+                        result = encode_value(state, top, out, depth + 1);
+
+                    lua_pop(state, 1);
+                    if(result != ValueCodecResult::Success)
+                    {
+                        lua_pop(state, 1);
+                        return result;
+                    }
+                }
+
+                write_tag(out, value_tag::TableEnd);
+            }
+            break;
+            default:
+                return ValueCodecResult::UnsupportedType;
+        }
+
+        return ValueCodecResult::Success;
+    }
+
+    class value_reader
+    {
+    public:
+        value_reader(std::span<const std::byte> _data) noexcept
+            : data(_data),
+              position(0)
+        {}
+
+        bool ReadTag(value_tag& tag) noexcept
+        {
+            if(position == data.size())
+                return false;
+
+            tag = static_cast<value_tag>(data[position++]);
+            return true;
+        }
+
+        bool PeekTag(value_tag& tag) const noexcept
+        {
+            if(position == data.size())
+                return false;
+
+            tag = static_cast<value_tag>(data[position]);
+            return true;
+        }
+
+        bool ReadVarint(std::uint64_t& value) noexcept
+        {
+            value = 0;
+            for(unsigned shift = 0; shift < 64; shift += 7)
+            {
+                if(position == data.size())
+                    return false;
+
+                auto byte = static_cast<std::uint8_t>(data[position++]);
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if((byte & 0x80) == 0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        const std::byte* ReadBytes(std::size_t size) noexcept
+        {
+            if(data.size() - position < size)
+                return nullptr;
+
+            const std::byte* bytes = data.data() + position;
+            position += size;
+            return bytes;
+        }
+
+        std::size_t GetPosition() const noexcept
+        {
+            return position;
+        }
+    private:
+        std::span<const std::byte> data;
+        std::size_t position;
+    };
+
+    //pushes one value, on failure the caller restores the stack top
+    static ValueCodecResult decode_value(lua_State* state, value_reader& reader, int depth)
+    {
+        value_tag tag;
+        if(!reader.ReadTag(tag))
+            return ValueCodecResult::BadData;
+
+        switch(tag)
+        {
+            case value_tag::Nil:
+                lua_pushnil(state);
+                break;
+            case value_tag::False:
+            case value_tag::True:
+                lua_pushboolean(state, tag == value_tag::True);
+                break;
+            case value_tag::Integer:
+            {
+                std::uint64_t value;
+                if(!reader.ReadVarint(value))
+                    return ValueCodecResult::BadData;
+
+                auto integer = static_cast<std::int64_t>((value >> 1) ^ (~(value & 1) + 1));
+                lua_pushnumber(state, static_cast<lua_Number>(integer));
+            }
+            break;
+            case value_tag::Number:
+            {
+                const std::byte* bytes = reader.ReadBytes(sizeof(lua_Number));
+                if(!bytes)
+                    return ValueCodecResult::BadData;
+
+                lua_Number number;
+                std::memcpy(&number, bytes, sizeof(number));
+                lua_pushnumber(state, number);
+            }
+            break;
+            case value_tag::String:
+            {
+                std::uint64_t len;
+                if(!reader.ReadVarint(len) || len > std::numeric_limits<std::size_t>::max())
+                    return ValueCodecResult::BadData;
+
+                const std::byte* bytes = reader.ReadBytes(static_cast<std::size_t>(len));
+                if(!bytes)
+                    return ValueCodecResult::BadData;
+
+                lua_pushlstring(state,
+                                reinterpret_cast<const char*>(bytes),
+                                static_cast<std::size_t>(len));
+            }
+            break;
+            case value_tag::Table:
+            {
+                if(depth == VALUE_CODEC_MAX_DEPTH || !lua_checkstack(state, 3))
+                    return ValueCodecResult::TooDeep;
+
+                lua_newtable(state);
+                int table = lua_gettop(state);
+                for(;;)
+                {
+                    value_tag key_tag;
+                    if(!reader.PeekTag(key_tag))
+                        return ValueCodecResult::BadData;
+
+                    if(key_tag == value_tag::TableEnd)
+                    {
+                        reader.ReadTag(key_tag);
+                        break;
+                    }
+
+                    ValueCodecResult result = decode_value(state, reader, depth + 1);
+                    if(result != ValueCodecResult::Success)
+                        return result;
+
+                    //lua_rawset raises an error for such keys
+                    lua_Number key = lua_tonumber(state, -1);
+                    if(lua_isnil(state, -1) || (lua_type(state, -1) == LUA_TNUMBER && key != key))
+                        return ValueCodecResult::BadData;
+
+                    result = decode_value(state, reader, depth + 1);
+                    if(result != ValueCodecResult::Success)
+                        return result;
+
+                    lua_rawset(state, table);
+                }
+            }
+            break;
+            default:
+                return ValueCodecResult::BadData;
+        }
+
+        return ValueCodecResult::Success;
+    }
+
+    ValueCodecResult EncodeValue(lua_State* state, int index, std::vector<std::byte>& out)
+    {
+        std::size_t size = out.size();
+        int top = lua_gettop(state);
+        ValueCodecResult result = encode_value(state, index, out, 0);
+        if(result != ValueCodecResult::Success)
+        {
+            out.resize(size);
+            lua_settop(state, top);
+        }
+
+        return result;
+    }
+
+    ValueCodecResult
+    DecodeValue(lua_State* state, std::span<const std::byte> data, std::size_t& read)
+    {
+        value_reader reader(data);
+        int top = lua_gettop(state);
+        if(!lua_checkstack(state, 1))
+            return ValueCodecResult::TooDeep;
+
+        ValueCodecResult result = decode_value(state, reader, 0);
+        if(result != ValueCodecResult::Success)
+        {
+            lua_settop(state, top);
+            return result;
+        }
+
+        read = reader.GetPosition();
+        return result;
+    }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <lua.hpp>
+#include <span>
+#include <vector>
+
+namespace LuaWay
+{
+    enum class ValueCodecResult
+    {
+        Success,
+        UnsupportedType, //functions, userdata and threads can't leave their VM
+        TooDeep, //nesting above VALUE_CODEC_MAX_DEPTH, also catches cyclic tables
+        BadData
+    };
+
+    constexpr inline int VALUE_CODEC_MAX_DEPTH = 64;
+
+    //Compact binary form of nil, booleans, numbers, strings and tables of them.
+    //Integral numbers take a zigzag varint, other numbers 8 bytes of native double,
+    //lengths are varints. Tables shared by several keys are written once per key.
+    //The format uses the native endianness, it's meant for VMs of one process
+
+    //appends the value at index to out, out is left unchanged on failure
+    ValueCodecResult EncodeValue(lua_State* state, int index, std::vector<std::byte>& out);
+
+    //pushes one value, nothing is pushed on failure. Returns the number of read bytes in read
+    ValueCodecResult
+    DecodeValue(lua_State* state, std::span<const std::byte> data, std::size_t& read);
+};
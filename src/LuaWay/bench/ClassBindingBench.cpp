@@ -0,0 +1,149 @@
+#include "../ClassBinding.hpp"
+#include "../Register.hpp"
+#include "../VM.h"
+#include "hrs/meta/class_meta_def.hpp"
+#include "hrs/test/environment.h"
+#include "hrs/test/tests.h"
+#include <array>
+
+struct BenchVec
+{
+    float x, y, z;
+
+    //Number, so the Register.hpp wrapper can push the result too
+    LuaWay::Number Length() const noexcept
+    {
+        return x + y + z;
+    }
+};
+
+struct BenchEntity
+{
+    BenchVec pos;
+};
+
+HRS_REFL_BEGIN(BenchVec)
+HRS_REFL_MEMBER_FIELDS_BEGIN()
+HRS_REFL_MEMBER_FIELD(x), HRS_REFL_MEMBER_FIELD(y), HRS_REFL_MEMBER_FIELD(z),
+    HRS_REFL_MEMBER_FIELD(Length)
+HRS_REFL_MEMBER_FIELDS_END()
+HRS_REFL_END()
+
+HRS_REFL_BEGIN(BenchEntity)
+HRS_REFL_MEMBER_FIELDS_BEGIN()
+HRS_REFL_MEMBER_FIELD(pos)
+HRS_REFL_MEMBER_FIELDS_END()
+HRS_REFL_END()
+
+//An iteration is one call of a Lua function that does 1000 accesses,
+//so the pcall into the VM is amortized and the time is dominated by the bound wrappers.
+//BenchVec::Length is also wrapped with the Register.hpp function_wrapper, both are called
+//as plain functions on the same object to compare the per-call overhead of the wrappers
+namespace
+{
+    constexpr const char* SCRIPT = R"(
+        local v = BenchVec.new(1, 2, 3)
+        local e = BenchEntity.new(v)
+        local t = {x = 1, Length = function(self) return self.x end}
+        local bound_length = v.Length
+        local wrapped_length = bench.wrapped_length
+
+        function call_method()
+            for i = 1, 1000 do v:Length() end
+        end
+
+        function call_bound_function()
+            for i = 1, 1000 do bound_length(v) end
+        end
+
+        function call_wrapped_function()
+            for i = 1, 1000 do wrapped_length(v) end
+        end
+
+        function call_lua_method()
+            for i = 1, 1000 do t:Length() end
+        end
+
+        function read_field()
+            for i = 1, 1000 do local x = v.x end
+        end
+
+        function write_field()
+            for i = 1, 1000 do v.x = i end
+        end
+
+        function read_reference_field()
+            for i = 1, 1000 do local x = e.pos.x end
+        end
+    )";
+
+    struct ClassBindingFixture
+    {
+        LuaWay::VM vm;
+
+        ClassBindingFixture()
+            : vm(std::move(LuaWay::VM::Open(false).value()))
+        {
+            LuaWay::BindClass<BenchVec, float, float, float>(vm);
+            LuaWay::BindClass<BenchEntity, BenchVec>(vm);
+
+            std::array<luaL_Reg, 2> functions = {
+                luaL_Reg{"wrapped_length", LuaWay::WrapFunction<&BenchVec::Length>()},
+                luaL_Reg{nullptr, nullptr}};
+            vm.RegisterLibrary("bench", functions);
+
+            hrs::assert_true(vm.DoString(SCRIPT, {}).has_value(), "Benchmark script has failed!");
+        }
+
+        static const ClassBindingFixture& Get()
+        {
+            static ClassBindingFixture fixture;
+            return fixture;
+        }
+    };
+
+    void run_script_function(hrs::test::bench_state& state, const char* name)
+    {
+        LuaWay::Ref func = ClassBindingFixture::Get().vm.GetGlobal(name);
+        while(state.keep_running())
+            hrs::test::do_not_optimize(func());
+    }
+};
+
+HRS_BENCH(bound_method_call, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "call_method");
+}
+
+//the same method without the __index lookup of v:Length()
+HRS_BENCH(bound_function_call, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "call_bound_function");
+}
+
+//the Register.hpp wrapper, it reads the object with lua_touserdata and no type check
+HRS_BENCH(wrapped_function_call, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "call_wrapped_function");
+}
+
+HRS_BENCH(lua_method_call, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "call_lua_method");
+}
+
+HRS_BENCH(bound_field_read, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "read_field");
+}
+
+HRS_BENCH(bound_field_write, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "write_field");
+}
+
+//every access creates a reference userdata
+HRS_BENCH(bound_reference_field_read, hrs::test::test_config().set_group("ClassBinding"))
+{
+    run_script_function(state, "read_reference_field");
+}
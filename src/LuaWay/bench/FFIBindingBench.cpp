@@ -0,0 +1,119 @@
+#include "../FFIBinding.h"
+#include "../Register.hpp"
+#include "../VM.h"
+#include "hrs/meta/class_meta_def.hpp"
+#include "hrs/test/environment.h"
+#include "hrs/test/tests.h"
+#include <array>
+#include <vector>
+
+struct BenchEntity
+{
+    hrs::math::vector<float, 4, 16> position;
+    hrs::math::vector<float, 4, 16> velocity;
+};
+
+HRS_REFL_BEGIN(BenchEntity)
+HRS_REFL_MEMBER_FIELDS_BEGIN()
+HRS_REFL_MEMBER_FIELD(position), HRS_REFL_MEMBER_FIELD(velocity)
+HRS_REFL_MEMBER_FIELDS_END()
+HRS_REFL_END()
+
+//A per-entity update loop over an array of entities: every entity is integrated by one native
+//call, through an FFI cdata function that takes the entity pointer and through a Register.hpp
+//lua_CFunction that takes the entity index. An iteration updates all entities once,
+//the loop is warm after the first iterations, so FFI calls run from a compiled trace
+namespace
+{
+    constexpr std::size_t ENTITY_COUNT = 1000;
+
+    std::vector<BenchEntity> entities(ENTITY_COUNT,
+                                      BenchEntity{.position = {0, 0, 0, 1},
+                                                  .velocity = {1, 2, 3, 0}});
+
+    void update_entity(BenchEntity* entity, float dt) noexcept
+    {
+        entity->position += entity->velocity * dt;
+    }
+
+    //index is 0-based, like the cdata pointer offsets of the FFI loop
+    void update_entity_at(LuaWay::Integer index, LuaWay::Number dt) noexcept
+    {
+        update_entity(&entities[static_cast<std::size_t>(index)], static_cast<float>(dt));
+    }
+
+    LuaWay::LightUserData entities_data() noexcept
+    {
+        return {entities.data()};
+    }
+
+    LuaWay::Integer entity_count() noexcept
+    {
+        return static_cast<LuaWay::Integer>(entities.size());
+    }
+
+    constexpr const char* SCRIPT = R"(
+        local ffi = require("ffi")
+        local ffi_update = ffi_module.update_entity
+        local c_update = bench.update_entity_at
+        local entity_count = bench.entity_count()
+        local entities = ffi.cast("bench_entity*", bench.entities_data())
+        local dt = 1 / 60
+
+        function update_ffi()
+            for i = 0, entity_count - 1 do ffi_update(entities + i, dt) end
+        end
+
+        function update_c_function()
+            for i = 0, entity_count - 1 do c_update(i, dt) end
+        end
+    )";
+
+    struct FFIBindingFixture
+    {
+        LuaWay::VM vm;
+
+        FFIBindingFixture()
+            : vm(std::move(LuaWay::VM::Open(true).value()))
+        {
+            auto module = LuaWay::FFIModule()
+                              .Type<BenchEntity>("bench_entity")
+                              .Function<&update_entity>("update_entity")
+                              .Load(vm);
+            hrs::assert_true(module.has_value(), "FFI module hasn't been loaded!");
+            vm.SetGlobal("ffi_module", module.value());
+
+            std::array<luaL_Reg, 4> functions = {
+                luaL_Reg{"update_entity_at", LuaWay::WrapFunction<&update_entity_at>()},
+                luaL_Reg{"entities_data", LuaWay::WrapFunction<&entities_data>()},
+                luaL_Reg{"entity_count", LuaWay::WrapFunction<&entity_count>()},
+                luaL_Reg{nullptr, nullptr}};
+            vm.RegisterLibrary("bench", functions);
+
+            hrs::assert_true(vm.DoString(SCRIPT, {}).has_value(), "Benchmark script has failed!");
+        }
+
+        static const FFIBindingFixture& Get()
+        {
+            static FFIBindingFixture fixture;
+            return fixture;
+        }
+    };
+
+    void run_script_function(hrs::test::bench_state& state, const char* name)
+    {
+        LuaWay::Ref func = FFIBindingFixture::Get().vm.GetGlobal(name);
+        while(state.keep_running())
+            hrs::test::do_not_optimize(func());
+    }
+};
+
+HRS_BENCH(ffi_entity_update, hrs::test::test_config().set_group("FFIBinding"))
+{
+    run_script_function(state, "update_ffi");
+}
+
+HRS_BENCH(c_function_entity_update, hrs::test::test_config().set_group("FFIBinding"))
+{
+    run_script_function(state, "update_c_function");
+}
@@ -0,0 +1,124 @@
+#include "../Register.hpp"
+#include "../RefView.h"
+#include "../VM.h"
+#include "hrs/test/environment.h"
+#include "hrs/test/tests.h"
+#include <array>
+
+//Ref copies touch the shared slot counter, RefView copies are plain pointer copies.
+//A wrapped function that takes a Ref argument takes and releases a registry slot per call,
+//StackRef only records the stack index
+namespace
+{
+    bool takes_ref(LuaWay::Ref value) noexcept
+    {
+        return value.IsCreated();
+    }
+
+    bool takes_stack_ref(LuaWay::StackRef value) noexcept
+    {
+        return value.IsCreated();
+    }
+
+    //an iteration is one call of a Lua function that does 1000 wrapped calls
+    constexpr const char* SCRIPT = R"(
+        local takes_ref = bench.takes_ref
+        local takes_stack_ref = bench.takes_stack_ref
+        local arg = {}
+
+        function call_ref()
+            for i = 1, 1000 do takes_ref(arg) end
+        end
+
+        function call_stack_ref()
+            for i = 1, 1000 do takes_stack_ref(arg) end
+        end
+    )";
+
+    struct RefFixture
+    {
+        LuaWay::VM vm;
+        LuaWay::Ref number;
+
+        RefFixture()
+            : vm(std::move(LuaWay::VM::Open(false).value())),
+              number(vm.CreateRef(LuaWay::Number(42)))
+        {
+            std::array<luaL_Reg, 3> functions = {
+                luaL_Reg{"takes_ref", LuaWay::WrapFunction<&takes_ref>()},
+                luaL_Reg{"takes_stack_ref", LuaWay::WrapFunction<&takes_stack_ref>()},
+                luaL_Reg{nullptr, nullptr}};
+            vm.RegisterLibrary("bench", functions);
+
+            hrs::assert_true(vm.DoString(SCRIPT, {}).has_value(), "Benchmark script has failed!");
+        }
+
+        static const RefFixture& Get()
+        {
+            static RefFixture fixture;
+            return fixture;
+        }
+    };
+
+    void run_script_function(hrs::test::bench_state& state, const char* name)
+    {
+        LuaWay::Ref func = RefFixture::Get().vm.GetGlobal(name);
+        while(state.keep_running())
+            hrs::test::do_not_optimize(func());
+    }
+};
+
+HRS_BENCH(ref_copy, hrs::test::test_config().set_group("Ref"))
+{
+    const LuaWay::Ref& number = RefFixture::Get().number;
+    while(state.keep_running())
+    {
+        LuaWay::Ref copy = number;
+        hrs::test::do_not_optimize(copy);
+    }
+}
+
+HRS_BENCH(ref_view_copy, hrs::test::test_config().set_group("Ref"))
+{
+    LuaWay::RefView number = RefFixture::Get().number;
+    while(state.keep_running())
+    {
+        LuaWay::RefView copy = number;
+        hrs::test::do_not_optimize(copy);
+    }
+}
+
+HRS_BENCH(ref_as, hrs::test::test_config().set_group("Ref"))
+{
+    const LuaWay::Ref& number = RefFixture::Get().number;
+    while(state.keep_running())
+        hrs::test::do_not_optimize(number.As<LuaWay::Number>());
+}
+
+HRS_BENCH(ref_view_as, hrs::test::test_config().set_group("Ref"))
+{
+    LuaWay::RefView number = RefFixture::Get().number;
+    while(state.keep_running())
+        hrs::test::do_not_optimize(number.As<LuaWay::Number>());
+}
+
+//an iteration takes a registry slot and releases it, the ref slot comes from the thread cache
+HRS_BENCH(ref_create_release, hrs::test::test_config().set_group("Ref"))
+{
+    const LuaWay::VM& vm = RefFixture::Get().vm;
+    while(state.keep_running())
+    {
+        LuaWay::Ref ref = vm.CreateRef(LuaWay::Number(1));
+        hrs::test::do_not_optimize(ref);
+    }
+}
+
+HRS_BENCH(wrapped_call_ref, hrs::test::test_config().set_group("Ref"))
+{
+    run_script_function(state, "call_ref");
+}
+
+HRS_BENCH(wrapped_call_stack_ref, hrs::test::test_config().set_group("Ref"))
+{
+    run_script_function(state, "call_stack_ref");
+}
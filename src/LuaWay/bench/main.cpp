@@ -0,0 +1,19 @@
+#include "hrs/test/environment.h"
+
+//LuaWayBench [output.json [baseline.json]]
+int main(int argc, char** argv)
+{
+    hrs::test::bench_options options;
+    if(argc > 1)
+        options.output_path = argv[1];
+
+    if(argc > 2)
+        options.baseline_path = argv[2];
+
+    hrs::test::environment::config cfg;
+    cfg.set_bench_options(std::move(options));
+    hrs::test::environment& env = hrs::test::environment::get_global_environment();
+    env.set_config(std::move(cfg));
+
+    return env.run() ? 0 : 1;
+}
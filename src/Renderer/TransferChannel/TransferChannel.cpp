@@ -359,7 +359,8 @@ namespace FireLand
             if(append_opt)
                 return EmbedResult{.command_buffer = command_buffer,
                                    .buffer = buffer.buffer,
-                                   .offset = *append_opt};
+                                   .offset = *append_opt,
+                                   .map_ptr = buffer.GetBufferMapPtr() + *append_opt};
         }
 
         hrs::error err = InsertBuffer(req.size);
@@ -372,7 +373,8 @@ namespace FireLand
 
         return EmbedResult{.command_buffer = command_buffer,
                            .buffer = buffers.back().buffer,
-                           .offset = *opt};
+                           .offset = *opt,
+                           .map_ptr = buffers.back().GetBufferMapPtr() + *opt};
     }
 
     void TransferChannel::EmbedBarrier(
@@ -26,6 +26,7 @@ namespace FireLand
         VkCommandBuffer command_buffer;
         VkBuffer buffer;
         VkDeviceSize offset;
+        std::byte* map_ptr; //staging memory at offset, filled by the caller
     };
 
     class TransferChannel : public hrs::non_copyable
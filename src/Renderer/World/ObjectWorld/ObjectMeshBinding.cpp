@@ -1,5 +1,6 @@
 #include "ObjectMeshBinding.h"
 #include "../RenderWorld/MaterialGroup.h"
+#include "../RenderWorld/Mesh.h"
 #include "../RenderWorld/RenderGroup.h"
 #include "../RenderWorld/RenderWorld.h"
 #include "ObjectInstance.h"
@@ -69,7 +70,7 @@ namespace FireLand
     bool ObjectMeshBinding::AddRenderBinding(const RenderGroup* render_group,
                                              RenderWorld* render_world)
     {
-        if(render_group->GetMesh() != mesh)
+        if(render_group->GetMesh()->GetSourceMesh() != mesh)
             return false;
 
         auto shader = render_group->GetParentMaterialGroup()->GetParentShader();
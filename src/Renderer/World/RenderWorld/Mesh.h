@@ -2,9 +2,17 @@
 
 #include "../../Vulkan/VulkanInclude.hpp"
 #include <cstdint>
+#include <limits>
 
 namespace FireLand
 {
+    struct MeshLod
+    {
+        std::uint32_t first_index;
+        std::uint32_t index_count;
+        float error; //relative to the mesh extent, like GeometryParser::MeshLodLevel
+    };
+
     struct Mesh
     {
         virtual ~Mesh()
@@ -15,5 +23,55 @@ namespace FireLand
         virtual std::uint32_t GetCount() const noexcept = 0;
         virtual bool IsVertexBufferRebindNeeded(const Mesh* mesh) const noexcept = 0;
         virtual bool IsIndexBufferRebindNeeded(const Mesh* mesh) const noexcept = 0;
+
+        //the mesh this one draws a part of, see MeshLodView
+        virtual const Mesh* GetSourceMesh() const noexcept
+        {
+            return this;
+        }
+
+        //level 0 is the full mesh, meshes without LODs have only it
+        virtual std::uint32_t GetLodCount() const noexcept
+        {
+            return 1;
+        }
+
+        virtual MeshLod GetLod([[maybe_unused]] std::uint32_t lod) const noexcept
+        {
+            return {.first_index = 0, .index_count = GetCount(), .error = 0};
+        }
+
+        //RenderLod(command_buffer, 0) must draw the same as Render
+        virtual void RenderLod(vk::CommandBuffer command_buffer,
+                               [[maybe_unused]] std::uint32_t lod) const noexcept
+        {
+            Render(command_buffer);
+        }
+
+        //Coarsest level whose error stays within max_pixel_error for an instance
+        //whose extent covers screen_size pixels
+        std::uint32_t SelectLod(float screen_size, float max_pixel_error) const noexcept
+        {
+            std::uint32_t lod = 0;
+            for(std::uint32_t i = 1; i < GetLodCount(); i++)
+            {
+                if(GetLod(i).error * screen_size > max_pixel_error)
+                    break;
+
+                lod = i;
+            }
+
+            return lod;
+        }
+
+        //Pixels covered by an extent at view depth distance under a perspective projection,
+        //projection_scale is viewport_height / (2 * tan(fov_y / 2))
+        static float ProjectedSize(float extent, float distance, float projection_scale) noexcept
+        {
+            if(distance <= 0)
+                return std::numeric_limits<float>::max();
+
+            return extent * projection_scale / distance;
+        }
     };
 };
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Mesh.h"
+
+namespace FireLand
+{
+    //One level of a mesh as a mesh of its own, it shares the buffers of the source mesh.
+    //A render group is drawn with one level, so instances get their own levels by binding
+    //to the render groups of the views: after Mesh::SelectLod picks another level for an
+    //instance, its ObjectMeshBinding moves from the group of the old view to the new one.
+    class MeshLodView : public Mesh
+    {
+    public:
+        MeshLodView(const Mesh* _mesh, std::uint32_t _lod) noexcept
+            : mesh(_mesh),
+              lod(_lod)
+        {}
+
+        ~MeshLodView() = default;
+        MeshLodView(const MeshLodView&) = default;
+        MeshLodView& operator=(const MeshLodView&) = default;
+
+        void Render(vk::CommandBuffer command_buffer) const noexcept override
+        {
+            if(lod == 0)
+                mesh->Render(command_buffer);
+            else
+                mesh->RenderLod(command_buffer, lod);
+        }
+
+        std::pair<vk::Buffer, vk::DeviceSize> GetVertexBuffer() const noexcept override
+        {
+            return mesh->GetVertexBuffer();
+        }
+
+        std::pair<vk::Buffer, vk::DeviceSize> GetIndexBuffer() const noexcept override
+        {
+            return mesh->GetIndexBuffer();
+        }
+
+        std::uint32_t GetCount() const noexcept override
+        {
+            return mesh->GetLod(lod).index_count;
+        }
+
+        //views of one mesh follow each other without rebinds
+        bool IsVertexBufferRebindNeeded(const Mesh* prev_mesh) const noexcept override
+        {
+            return prev_mesh->GetVertexBuffer() != GetVertexBuffer();
+        }
+
+        bool IsIndexBufferRebindNeeded(const Mesh* prev_mesh) const noexcept override
+        {
+            return prev_mesh->GetIndexBuffer() != GetIndexBuffer();
+        }
+
+        const Mesh* GetSourceMesh() const noexcept override
+        {
+            return mesh;
+        }
+
+        MeshLod GetLod([[maybe_unused]] std::uint32_t view_lod) const noexcept override
+        {
+            return mesh->GetLod(lod);
+        }
+
+        std::uint32_t GetLevel() const noexcept
+        {
+            return lod;
+        }
+    private:
+        const Mesh* mesh;
+        std::uint32_t lod;
+    };
+};
@@ -42,7 +42,9 @@ namespace FireLand
         return GetState() && pool.HasData();
     }
 
-    bool RenderGroup::Render(const Mesh* prev_mesh, vk::CommandBuffer command_buffer) const noexcept
+    bool RenderGroup::Render(const Mesh* prev_mesh,
+                             vk::CommandBuffer command_buffer,
+                             std::uint32_t lod) const noexcept
     {
         if(!IsRenderable())
             return false;
@@ -66,7 +68,11 @@ namespace FireLand
                 command_buffer.bindVertexBuffers(0, 1, &vertex_buffer, &vertex_offset);
         }
 
-        mesh->Render(command_buffer);
+        if(lod == 0)
+            mesh->Render(command_buffer);
+        else
+            mesh->RenderLod(command_buffer, lod);
+
         return true;
     }
 
@@ -25,7 +25,11 @@ namespace FireLand
         RenderGroup& operator=(RenderGroup&& rg) noexcept;
 
         bool IsRenderable() const noexcept;
-        bool Render(const Mesh* prev_mesh, vk::CommandBuffer command_buffer) const noexcept;
+        //lod is shared by all instances of the group, instances that pick different levels
+        //(Mesh::SelectLod) are grouped under MeshLodView meshes
+        bool Render(const Mesh* prev_mesh,
+                    vk::CommandBuffer command_buffer,
+                    std::uint32_t lod = 0) const noexcept;
         void Sync();
 
         void AcquireIndex(std::uint32_t data_index, std::uint32_t* subscriber_ptr);
@@ -0,0 +1,99 @@
+#include "../multikey_map/flat_multikey_map.hpp"
+#include "../multikey_map/multikey_map.hpp"
+#include "../test/environment.h"
+#include "../test/tests.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+//one unique int key and one shared key with SHARED_RUN values per key
+using unique_key_t = hrs::key<std::uint32_t, hrs::map_unique_key, std::less<>>;
+using shared_key_t = hrs::key<std::uint32_t, hrs::map_shared_key, std::less<>>;
+using node_map_t = hrs::multikey_map<std::uint64_t, unique_key_t, shared_key_t>;
+using flat_map_t = hrs::flat_multikey_map<std::uint64_t, unique_key_t, shared_key_t>;
+
+constexpr std::uint32_t SHARED_RUN = 1024;
+
+//maps are built once per type and size, the benchmark bodies run many times
+template<typename M, std::uint32_t Count>
+struct map_fixture
+{
+    std::vector<std::uint32_t> keys;
+    M map;
+
+    map_fixture()
+        : keys(Count)
+    {
+        for(std::uint32_t i = 0; i < Count; i++)
+            keys[i] = i;
+
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(Count));
+        for(std::uint32_t key: keys)
+            map.insert(std::uint64_t(key), key, key / SHARED_RUN);
+    }
+
+    static map_fixture& get()
+    {
+        static map_fixture fixture;
+        return fixture;
+    }
+};
+
+//an iteration erases a key and inserts it back, the map keeps its size
+template<typename M, std::uint32_t Count>
+static void bench_insert_erase(hrs::test::bench_state& state)
+{
+    auto& [keys, map] = map_fixture<M, Count>::get();
+    std::size_t i = 0;
+    while(state.keep_running())
+    {
+        std::uint32_t key = keys[i];
+        map.erase(map.template find<0>(key));
+        hrs::test::do_not_optimize(map.insert(std::uint64_t(key), key, key / SHARED_RUN));
+        i = (i + 1 == keys.size() ? 0 : i + 1);
+    }
+}
+
+template<typename M, std::uint32_t Count, std::size_t Index>
+static void bench_find(hrs::test::bench_state& state)
+{
+    auto& [keys, map] = map_fixture<M, Count>::get();
+    std::size_t i = 0;
+    while(state.keep_running())
+    {
+        std::uint32_t key = (Index == 0 ? keys[i] : keys[i] / SHARED_RUN);
+        hrs::test::do_not_optimize(map.template find<Index>(key));
+        i = (i + 1 == keys.size() ? 0 : i + 1);
+    }
+}
+
+#define MULTIKEY_MAP_BENCHES(COUNT, SUFFIX) \
+    HRS_BENCH(node_insert_erase_##SUFFIX, hrs::test::test_config().set_group("multikey_map")) \
+    { \
+        bench_insert_erase<node_map_t, COUNT>(state); \
+    } \
+    HRS_BENCH(flat_insert_erase_##SUFFIX, hrs::test::test_config().set_group("multikey_map")) \
+    { \
+        bench_insert_erase<flat_map_t, COUNT>(state); \
+    } \
+    HRS_BENCH(node_find_unique_##SUFFIX, hrs::test::test_config().set_group("multikey_map")) \
+    { \
+        bench_find<node_map_t, COUNT, 0>(state); \
+    } \
+    HRS_BENCH(flat_find_unique_##SUFFIX, hrs::test::test_config().set_group("multikey_map")) \
+    { \
+        bench_find<flat_map_t, COUNT, 0>(state); \
+    } \
+    HRS_BENCH(node_find_shared_##SUFFIX, hrs::test::test_config().set_group("multikey_map")) \
+    { \
+        bench_find<node_map_t, COUNT, 1>(state); \
+    } \
+    HRS_BENCH(flat_find_shared_##SUFFIX, hrs::test::test_config().set_group("multikey_map")) \
+    { \
+        bench_find<flat_map_t, COUNT, 1>(state); \
+    }
+
+MULTIKEY_MAP_BENCHES(1'000, 1k)
+MULTIKEY_MAP_BENCHES(100'000, 100k)
+MULTIKEY_MAP_BENCHES(1'000'000, 1m)
@@ -9,7 +9,7 @@
 #endif
 namespace hrs
 {
-    std::string demangle(const char* mangled_name)
+    inline std::string demangle(const char* mangled_name)
     {
 #if defined(unix) || defined(__unix) || defined(__unix__)
         return ia64_abi::demangle(mangled_name);
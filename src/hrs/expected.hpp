@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <memory>
 #include <utility>
 
 namespace hrs
@@ -37,11 +38,12 @@ namespace hrs
         {}
 
         template<typename U = E>
-        requires std::assignable_from<E&, U>
-        constexpr expected(U&& err, unexpected_t _) noexcept(std::is_nothrow_assignable_v<E&, U>)
+        requires std::constructible_from<E, U>
+        constexpr expected(U&& err, unexpected_t _) noexcept(std::is_nothrow_constructible_v<E, U>)
+            : data(uninitialized_tag{}),
+              is_error(true)
         {
-            is_error = true;
-            data.error = std::forward<U>(err);
+            std::construct_at(&data.error, std::forward<U>(err));
         }
 
         constexpr ~expected()
@@ -52,69 +54,79 @@ namespace hrs
                 data.value.~T();
         }
 
-        constexpr expected(const expected& ex) noexcept(std::is_nothrow_copy_assignable_v<T> &&
-                                                        std::is_nothrow_copy_assignable_v<E>)
+        constexpr expected(const expected& ex) noexcept(std::is_nothrow_copy_constructible_v<T> &&
+                                                        std::is_nothrow_copy_constructible_v<E>)
+            : data(uninitialized_tag{}),
+              is_error(ex.is_error)
         {
-            if(ex.is_error)
-                *this = ex.data.error;
+            if(is_error)
+                std::construct_at(&data.error, ex.data.error);
             else
-                *this = ex.data.value;
+                std::construct_at(&data.value, ex.data.value);
         }
 
-        constexpr expected(expected&& ex) noexcept(std::is_nothrow_move_assignable_v<T> &&
-                                                   std::is_nothrow_move_assignable_v<E>)
+        constexpr expected(expected&& ex) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                                   std::is_nothrow_move_constructible_v<E>)
+            : data(uninitialized_tag{}),
+              is_error(ex.is_error)
         {
-            if(ex.is_error)
-                *this = std::move(ex).data.error;
+            if(is_error)
+                std::construct_at(&data.error, std::move(ex.data.error));
             else
-                *this = std::move(ex).data.value;
+                std::construct_at(&data.value, std::move(ex.data.value));
         }
 
         constexpr expected&
-        operator=(const expected& ex) noexcept(std::is_nothrow_copy_assignable_v<T> &&
-                                               std::is_nothrow_copy_assignable_v<E>)
+        operator=(const expected& ex) noexcept(std::is_nothrow_copy_constructible_v<T> &&
+                                               std::is_nothrow_copy_constructible_v<E>)
         {
-            this->~expected();
+            if(this == &ex)
+                return *this;
 
-            if(ex.is_error)
-                *this = ex.data.error;
+            this->~expected();
+            is_error = ex.is_error;
+            if(is_error)
+                std::construct_at(&data.error, ex.data.error);
             else
-                *this = ex.data.value;
+                std::construct_at(&data.value, ex.data.value);
 
             return *this;
         }
 
         constexpr expected&
-        operator=(expected&& ex) noexcept(std::is_nothrow_move_assignable_v<T> &&
-                                          std::is_nothrow_move_assignable_v<E>)
+        operator=(expected&& ex) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                          std::is_nothrow_move_constructible_v<E>)
         {
-            this->~expected();
+            if(this == &ex)
+                return *this;
 
-            if(ex.is_error)
-                *this = std::move(ex).data.error;
+            this->~expected();
+            is_error = ex.is_error;
+            if(is_error)
+                std::construct_at(&data.error, std::move(ex.data.error));
             else
-                *this = std::move(ex).data.value;
+                std::construct_at(&data.value, std::move(ex.data.value));
 
             return *this;
         }
 
         template<typename U = T>
-        requires std::assignable_from<T&, U>
-        constexpr expected& operator=(U&& value) noexcept(std::is_nothrow_assignable_v<T&, U>)
+        requires std::constructible_from<T, U>
+        constexpr expected& operator=(U&& value) noexcept(std::is_nothrow_constructible_v<T, U>)
         {
             this->~expected();
             is_error = false;
-            data.value = std::forward<U>(value);
+            std::construct_at(&data.value, std::forward<U>(value));
             return *this;
         }
 
         template<typename U = E>
-        requires std::assignable_from<E&, U> && (!std::assignable_from<T&, U>)
-        constexpr expected& operator=(U&& error) noexcept(std::is_nothrow_assignable_v<E&, U>)
+        requires std::constructible_from<E, U> && (!std::constructible_from<T, U>)
+        constexpr expected& operator=(U&& error) noexcept(std::is_nothrow_constructible_v<E, U>)
         {
             this->~expected();
             is_error = true;
-            data.error = std::forward<U>(error);
+            std::construct_at(&data.error, std::forward<U>(error));
             return *this;
         }
 
@@ -288,11 +300,18 @@ namespace hrs
                 return value();
         }
     private:
+        struct uninitialized_tag
+        {};
+
         union expected_data
         {
             T value;
             E error;
 
+            //storage without an active member, must be filled right after construction
+            constexpr expected_data(uninitialized_tag) noexcept
+            {}
+
             constexpr expected_data() noexcept(std::is_nothrow_default_constructible_v<T>)
             requires std::is_default_constructible_v<T>
                 : value{}
@@ -4,15 +4,22 @@
 
 #include "debug.hpp"
 #include "mem_req.hpp"
+#include "node_pool.hpp"
 #include <list>
+#include <optional>
 #include <utility>
 
 namespace hrs
 {
-    template<std::unsigned_integral T>
+    //free blocks are list nodes, so the default allocator takes them from a node pool
+    template<std::unsigned_integral T, typename A = pool_allocator<block<T>>>
     class free_block_chain_base
     {
     public:
+        using blocks_t = std::list<block<T>, A>;
+        using iterator = typename blocks_t::iterator;
+        using const_iterator = typename blocks_t::const_iterator;
+
         free_block_chain_base(T _size = 0, T _outer_offset = 0)
             : size(_size),
               outer_offset(_outer_offset)
@@ -144,22 +151,22 @@ namespace hrs
                     blocks.insert(post_it, blk);
         }
 
-        std::list<block<T>>::iterator begin() noexcept
+        iterator begin() noexcept
         {
             return blocks.begin();
         }
 
-        std::list<block<T>>::iterator end() noexcept
+        iterator end() noexcept
         {
             return blocks.end();
         }
 
-        std::list<block<T>>::const_iterator begin() const noexcept
+        const_iterator begin() const noexcept
         {
             return blocks.cbegin();
         }
 
-        std::list<block<T>>::const_iterator end() const noexcept
+        const_iterator end() const noexcept
         {
             return blocks.cend();
         }
@@ -245,7 +252,7 @@ namespace hrs
             }
         }
 
-        void handle_block_it(std::list<block<T>>::iterator it, T block_size) noexcept
+        void handle_block_it(iterator it, T block_size) noexcept
         {
             if(it->size == block_size)
                 blocks.erase(it);
@@ -256,7 +263,7 @@ namespace hrs
             }
         }
 
-        void handle_block_it(std::list<block<T>>::iterator it,
+        void handle_block_it(iterator it,
                              T block_size,
                              const block<T>& remainder_blk,
                              block<T> acquire_blk) noexcept
@@ -276,7 +283,7 @@ namespace hrs
             return blocks.back().offset + blocks.back().size == size;
         }
     protected:
-        std::list<block<T>> blocks;
+        blocks_t blocks;
         T size;
         T outer_offset;
     };
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace hrs
+{
+    //Fast non-cryptographic 64-bit hash for change detection of file contents.
+    //Four independent lanes consume 32 bytes per step.
+    inline std::uint64_t hash_bytes(std::span<const std::byte> bytes,
+                                    std::uint64_t seed = 0) noexcept
+    {
+        constexpr std::uint64_t MUL_0 = 0x9E3779B97F4A7C15;
+        constexpr std::uint64_t MUL_1 = 0xC2B2AE3D27D4EB4F;
+        constexpr std::uint64_t MUL_2 = 0x165667B19E3779F9;
+
+        auto round = [](std::uint64_t lane, std::uint64_t word) noexcept
+        {
+            return std::rotl(lane ^ (word * MUL_1), 31) * MUL_0;
+        };
+
+        auto fmix = [](std::uint64_t h) noexcept
+        {
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCD;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53;
+            h ^= h >> 33;
+            return h;
+        };
+
+        const std::byte* ptr = bytes.data();
+        std::size_t size = bytes.size();
+
+        std::uint64_t lanes[4] = {seed + MUL_0, seed + MUL_1, seed + MUL_2, seed - MUL_0};
+        for(; size >= 32; ptr += 32, size -= 32)
+        {
+            std::uint64_t words[4];
+            std::memcpy(words, ptr, sizeof(words));
+            for(std::size_t i = 0; i < 4; i++)
+                lanes[i] = round(lanes[i], words[i]);
+        }
+
+        std::uint64_t h = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) +
+                          std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        h ^= bytes.size() * MUL_2;
+
+        for(; size >= 8; ptr += 8, size -= 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, ptr, sizeof(word));
+            h = round(h, word);
+        }
+
+        if(size != 0)
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, ptr, size);
+            h = round(h, word);
+        }
+
+        return fmix(h);
+    }
+};
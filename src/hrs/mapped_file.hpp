@@ -0,0 +1,19 @@
+#pragma once
+
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__) || \
+    defined(__MACH__) || defined(macintosh) || defined(Macintosh)
+#    include "mapped_file_impl/mman/mapped_file.h"
+#elif defined(_WIN32) || defined(_WIN64)
+#    include "mapped_file_impl/winapi/mapped_file.h"
+#else
+#    error Unsupported OS!
+#endif
+namespace hrs
+{
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__) || \
+    defined(__MACH__) || defined(macintosh) || defined(Macintosh)
+    using mapped_file = mman::mapped_file;
+#elif defined(_WIN32) || defined(_WIN64)
+    using mapped_file = winapi::mapped_file;
+#endif
+};
@@ -0,0 +1,120 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hrs
+{
+    namespace mman
+    {
+        mapped_file::mapped_file() noexcept
+            : ptr(nullptr),
+              map_size(0),
+              opened(false)
+        {}
+
+        mapped_file::~mapped_file()
+        {
+            close();
+        }
+
+        mapped_file::mapped_file(mapped_file&& mf) noexcept
+            : ptr(std::exchange(mf.ptr, nullptr)),
+              map_size(std::exchange(mf.map_size, 0)),
+              opened(std::exchange(mf.opened, false))
+        {}
+
+        mapped_file& mapped_file::operator=(mapped_file&& mf) noexcept
+        {
+            close();
+
+            ptr = std::exchange(mf.ptr, nullptr);
+            map_size = std::exchange(mf.map_size, 0);
+            opened = std::exchange(mf.opened, false);
+
+            return *this;
+        }
+
+        bool mapped_file::open(const std::filesystem::path& path) noexcept
+        {
+            if(is_open())
+                close();
+
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd == -1)
+                return false;
+
+            struct stat st;
+            if(fstat(fd, &st) == -1)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            //mmap refuses zero length, but an empty file is still a valid one
+            std::size_t file_size = static_cast<std::size_t>(st.st_size);
+            if(file_size != 0)
+            {
+                void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(mapping == MAP_FAILED)
+                {
+                    ::close(fd);
+                    return false;
+                }
+
+                madvise(mapping, file_size, MADV_SEQUENTIAL);
+                ptr = mapping;
+                map_size = file_size;
+            }
+
+            //the mapping keeps its own reference to the file
+            ::close(fd);
+            opened = true;
+            return true;
+        }
+
+        void mapped_file::close() noexcept
+        {
+            if(!is_open())
+                return;
+
+            if(ptr)
+                munmap(ptr, map_size);
+
+            ptr = nullptr;
+            map_size = 0;
+            opened = false;
+        }
+
+        bool mapped_file::is_open() const noexcept
+        {
+            return opened;
+        }
+
+        mapped_file::operator bool() const noexcept
+        {
+            return is_open();
+        }
+
+        const std::byte* mapped_file::data() const noexcept
+        {
+            return static_cast<const std::byte*>(ptr);
+        }
+
+        std::size_t mapped_file::size() const noexcept
+        {
+            return map_size;
+        }
+
+        std::span<const std::byte> mapped_file::get_bytes() const noexcept
+        {
+            return {data(), map_size};
+        }
+
+        std::string_view mapped_file::get_string_view() const noexcept
+        {
+            return {static_cast<const char*>(ptr), map_size};
+        }
+    };
+};
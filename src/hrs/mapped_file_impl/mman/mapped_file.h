@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../../non_creatable.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace hrs
+{
+    namespace mman
+    {
+        //read-only private mapping of the whole file
+        class mapped_file : hrs::non_copyable
+        {
+        public:
+            mapped_file() noexcept;
+            ~mapped_file();
+            mapped_file(mapped_file&& mf) noexcept;
+            mapped_file& operator=(mapped_file&& mf) noexcept;
+
+            bool open(const std::filesystem::path& path) noexcept;
+            void close() noexcept;
+
+            bool is_open() const noexcept;
+            explicit operator bool() const noexcept;
+
+            const std::byte* data() const noexcept;
+            std::size_t size() const noexcept;
+
+            std::span<const std::byte> get_bytes() const noexcept;
+            std::string_view get_string_view() const noexcept;
+        private:
+            void* ptr;
+            std::size_t map_size;
+            bool opened;
+        };
+    };
+};
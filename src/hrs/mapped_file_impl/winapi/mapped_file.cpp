@@ -0,0 +1,131 @@
+#include "mapped_file.h"
+
+#define NOMINMAX
+#include <Windows.h>
+
+namespace hrs
+{
+    namespace winapi
+    {
+        mapped_file::mapped_file() noexcept
+            : ptr(nullptr),
+              map_size(0),
+              opened(false)
+        {}
+
+        mapped_file::~mapped_file()
+        {
+            close();
+        }
+
+        mapped_file::mapped_file(mapped_file&& mf) noexcept
+            : ptr(std::exchange(mf.ptr, nullptr)),
+              map_size(std::exchange(mf.map_size, 0)),
+              opened(std::exchange(mf.opened, false))
+        {}
+
+        mapped_file& mapped_file::operator=(mapped_file&& mf) noexcept
+        {
+            close();
+
+            ptr = std::exchange(mf.ptr, nullptr);
+            map_size = std::exchange(mf.map_size, 0);
+            opened = std::exchange(mf.opened, false);
+
+            return *this;
+        }
+
+        bool mapped_file::open(const std::filesystem::path& path) noexcept
+        {
+            if(is_open())
+                close();
+
+            HANDLE file = CreateFileW(path.c_str(),
+                                      GENERIC_READ,
+                                      FILE_SHARE_READ,
+                                      nullptr,
+                                      OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                      nullptr);
+            if(file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER file_size;
+            if(!GetFileSizeEx(file, &file_size))
+            {
+                CloseHandle(file);
+                return false;
+            }
+
+            //CreateFileMapping refuses zero length, but an empty file is still a valid one
+            if(file_size.QuadPart != 0)
+            {
+                HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if(!mapping)
+                {
+                    CloseHandle(file);
+                    return false;
+                }
+
+                void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                //the view keeps its own references to the mapping and the file
+                CloseHandle(mapping);
+                if(!view)
+                {
+                    CloseHandle(file);
+                    return false;
+                }
+
+                ptr = view;
+                map_size = static_cast<std::size_t>(file_size.QuadPart);
+            }
+
+            CloseHandle(file);
+            opened = true;
+            return true;
+        }
+
+        void mapped_file::close() noexcept
+        {
+            if(!is_open())
+                return;
+
+            if(ptr)
+                UnmapViewOfFile(ptr);
+
+            ptr = nullptr;
+            map_size = 0;
+            opened = false;
+        }
+
+        bool mapped_file::is_open() const noexcept
+        {
+            return opened;
+        }
+
+        mapped_file::operator bool() const noexcept
+        {
+            return is_open();
+        }
+
+        const std::byte* mapped_file::data() const noexcept
+        {
+            return static_cast<const std::byte*>(ptr);
+        }
+
+        std::size_t mapped_file::size() const noexcept
+        {
+            return map_size;
+        }
+
+        std::span<const std::byte> mapped_file::get_bytes() const noexcept
+        {
+            return {data(), map_size};
+        }
+
+        std::string_view mapped_file::get_string_view() const noexcept
+        {
+            return {static_cast<const char*>(ptr), map_size};
+        }
+    };
+};
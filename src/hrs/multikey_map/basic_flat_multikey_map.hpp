@@ -0,0 +1,565 @@
+#pragma once
+
+#include "../debug.hpp"
+#include "flat_entry.hpp"
+#include <array>
+#include <memory>
+#include <tuple>
+
+namespace hrs
+{
+    namespace detail
+    {
+        template<typename V, typename... Keys>
+        struct flat_slot
+        {
+            std::tuple<std::add_const_t<Keys>...> keys;
+            V data;
+
+            template<typename T, typename... TKeys>
+            requires(sizeof...(TKeys) == sizeof...(Keys)) &&
+                        std::constructible_from<std::tuple<Keys...>, TKeys...> &&
+                        std::constructible_from<V, T>
+            constexpr flat_slot(T&& _data, TKeys&&... _keys) noexcept(
+                std::is_nothrow_constructible_v<std::tuple<Keys...>, TKeys...> &&
+                std::is_nothrow_constructible_v<V, T>)
+                : keys(std::forward<TKeys>(_keys)...),
+                  data(std::forward<T>(_data))
+            {}
+
+            ~flat_slot() = default;
+            flat_slot(const flat_slot&) = default;
+            flat_slot(flat_slot&&) = default;
+        };
+    };
+
+    //basic_multikey_map with contiguous indices.
+    //Values and their keys live in slots allocated in blocks of SLOT_BLOCK_SIZE, so values
+    //never move. Every key has a flat_index of (key copy, slot number) pairs, so keys must be
+    //copyable and are stored twice. Iterators are positions in the indices: insertions and
+    //erasures invalidate them, unlike the iterators of basic_multikey_map.
+    template<typename V, typename A, type_instantiation<key> CKey, type_instantiation<key>... CKeys>
+    class basic_flat_multikey_map
+    {
+    public:
+        template<std::size_t Index, typename M>
+        requires hrs::type_instantiation<std::remove_cv_t<M>, basic_flat_multikey_map>
+        friend class ::hrs::detail::flat_entry;
+
+        template<std::size_t Index, typename M>
+        requires hrs::type_instantiation<std::remove_cv_t<M>, basic_flat_multikey_map>
+        friend class ::hrs::detail::flat_iterator;
+
+        using compound_keys_t = hrs::variadic<CKey, CKeys...>;
+        using value_t = V;
+
+        using slot_t = detail::flat_slot<V, typename CKey::key_t, typename CKeys::key_t...>;
+
+        template<std::size_t Index>
+        using entry_t = detail::flat_entry<Index, basic_flat_multikey_map>;
+
+        template<std::size_t Index>
+        using const_entry_t = detail::flat_entry<Index, const basic_flat_multikey_map>;
+
+        using allocator_t = std::allocator_traits<A>::template rebind_alloc<slot_t>;
+        using comparators_t =
+            std::tuple<typename CKey::comparator_t, typename CKeys::comparator_t...>;
+
+        constexpr static std::size_t KEY_COUNT = sizeof...(CKeys) + 1;
+        constexpr static std::size_t SLOT_BLOCK_SIZE = 256;
+
+        basic_flat_multikey_map() noexcept(
+            std::is_nothrow_default_constructible_v<allocator_t> &&
+            std::is_nothrow_default_constructible_v<comparators_t>)
+        requires std::is_default_constructible_v<allocator_t> &&
+                 std::is_default_constructible_v<comparators_t>
+            : indices(index_t<CKey>(allocator), index_t<CKeys>(allocator)...),
+              slot_blocks(allocator),
+              free_slots(allocator),
+              slot_count(0),
+              size(0)
+        {}
+
+        template<typename... Comps>
+        requires std::is_default_constructible_v<allocator_t> &&
+                     std::constructible_from<comparators_t, Comps...>
+        basic_flat_multikey_map(Comps&&... comps)
+            : comparators(std::forward<Comps>(comps)...),
+              indices(index_t<CKey>(allocator), index_t<CKeys>(allocator)...),
+              slot_blocks(allocator),
+              free_slots(allocator),
+              slot_count(0),
+              size(0)
+        {}
+
+        template<typename Alloc>
+        requires std::constructible_from<allocator_t, Alloc>
+        basic_flat_multikey_map(Alloc&& _allocator)
+            : allocator(std::forward<Alloc>(_allocator)),
+              indices(index_t<CKey>(allocator), index_t<CKeys>(allocator)...),
+              slot_blocks(allocator),
+              free_slots(allocator),
+              slot_count(0),
+              size(0)
+        {}
+
+        template<typename Alloc, typename... Comps>
+        requires std::constructible_from<allocator_t, Alloc> &&
+                     std::constructible_from<comparators_t, Comps...>
+        basic_flat_multikey_map(Alloc&& _allocator, Comps&&... comps)
+            : comparators(std::forward<Comps>(comps)...),
+              allocator(std::forward<Alloc>(_allocator)),
+              indices(index_t<CKey>(allocator), index_t<CKeys>(allocator)...),
+              slot_blocks(allocator),
+              free_slots(allocator),
+              slot_count(0),
+              size(0)
+        {}
+
+        ~basic_flat_multikey_map()
+        {
+            clear();
+        }
+
+        basic_flat_multikey_map(const basic_flat_multikey_map& mkm)
+        requires std::copy_constructible<comparators_t>
+            : comparators(mkm.comparators),
+              allocator(std::allocator_traits<allocator_t>::select_on_container_copy_construction(
+                  mkm.allocator)),
+              indices(index_t<CKey>(allocator), index_t<CKeys>(allocator)...),
+              slot_blocks(allocator),
+              free_slots(allocator),
+              slot_count(0),
+              size(0)
+        {
+            copy_from(mkm);
+        }
+
+        basic_flat_multikey_map(basic_flat_multikey_map&& mkm) noexcept(
+            std::is_nothrow_move_constructible_v<comparators_t>)
+        requires std::move_constructible<comparators_t>
+            : comparators(std::move(mkm.comparators)),
+              allocator(std::move(mkm.allocator)),
+              indices(std::move(mkm.indices)),
+              slot_blocks(std::move(mkm.slot_blocks)),
+              free_slots(std::move(mkm.free_slots)),
+              slot_count(std::exchange(mkm.slot_count, 0)),
+              size(std::exchange(mkm.size, 0))
+        {}
+
+        basic_flat_multikey_map& operator=(const basic_flat_multikey_map& mkm)
+        requires std::is_copy_assignable_v<comparators_t>
+        {
+            if(this == &mkm)
+                return *this;
+
+            clear();
+            if constexpr(std::allocator_traits<
+                             allocator_t>::propagate_on_container_copy_assignment::value)
+                allocator = mkm.allocator;
+
+            comparators = mkm.comparators;
+            copy_from(mkm);
+            return *this;
+        }
+
+        basic_flat_multikey_map& operator=(basic_flat_multikey_map&& mkm)
+        requires std::is_move_assignable_v<comparators_t>
+        {
+            if(this == &mkm)
+                return *this;
+
+            clear();
+            comparators = std::move(mkm.comparators);
+            if constexpr(std::allocator_traits<
+                             allocator_t>::propagate_on_container_move_assignment::value)
+            {
+                allocator = std::move(mkm.allocator);
+                steal(mkm);
+            }
+            else if(allocator == mkm.allocator)
+                steal(mkm);
+            else
+            {
+                //move each value/key
+                auto& index = std::get<0>(mkm.indices);
+                for(auto pos = index.begin(); pos != index.end(); pos = index.next(pos))
+                {
+                    slot_t& slot = mkm.get_slot(index.get(pos).slot);
+                    std::apply(
+                        [&](auto&... _keys)
+                        {
+                            insert(std::move_if_noexcept(slot.data), _keys...);
+                        },
+                        slot.keys);
+                }
+
+                mkm.clear();
+            }
+
+            return *this;
+        }
+
+        std::size_t get_size() const noexcept
+        {
+            return size;
+        }
+
+        bool is_empty() const noexcept
+        {
+            return size == 0;
+        }
+
+        void clear() noexcept
+        {
+            auto& index = std::get<0>(indices);
+            for(auto pos = index.begin(); pos != index.end(); pos = index.next(pos))
+                std::allocator_traits<allocator_t>::destroy(allocator,
+                                                            &get_slot(index.get(pos).slot));
+
+            for(slot_t* block: slot_blocks)
+                std::allocator_traits<allocator_t>::deallocate(allocator, block, SLOT_BLOCK_SIZE);
+
+            std::apply(
+                [](auto&... _indices)
+                {
+                    (_indices.clear(), ...);
+                },
+                indices);
+
+            slot_blocks.clear();
+            free_slots.clear();
+            slot_count = 0;
+            size = 0;
+        }
+
+        template<std::size_t Index>
+        entry_t<Index> get_entry() noexcept
+        {
+            return entry_t<Index>(this);
+        }
+
+        template<std::size_t Index>
+        const_entry_t<Index> get_entry() const noexcept
+        {
+            return const_entry_t<Index>(this);
+        }
+
+        template<std::size_t Index, typename M>
+        requires std::same_as<std::remove_cv_t<M>, basic_flat_multikey_map>
+        void erase(const detail::flat_iterator<Index, M> it) noexcept
+        {
+            hrs::assert_true_debug(hrs::is_iterator_part_of_range_debug(get_entry<Index>(), it),
+                                   "Requested for erasure iterator is not a part of this "
+                                   "map/entry!");
+
+            if(it == get_entry<Index>().end())
+                return;
+
+            hrs::assert_true_debug(size != 0, "Erasure from an empty map!");
+
+            std::uint32_t slot = std::get<Index>(indices).get(it.pos).slot;
+            [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+            {
+                (erase_from_index<Indices, Index>(slot, it.pos), ...);
+            }(std::make_index_sequence<KEY_COUNT>{});
+
+            release_slot(slot);
+            size--;
+        }
+
+        //if inserted:
+        //	iterator to new value, true, any
+        //else
+        //	end iterator, false, index of already existed key(only for unique mapping)
+        template<typename T, typename... TKeys>
+        requires(sizeof...(TKeys) == sizeof...(CKeys) + 1) &&
+                std::constructible_from<slot_t, T, TKeys...>
+        std::tuple<typename entry_t<0>::iterator, bool, std::size_t> insert(T&& value,
+                                                                            TKeys&&... keys)
+        {
+            using out_t = std::tuple<typename entry_t<0>::iterator, bool, std::size_t>;
+
+            //unique keys are checked before anything is changed, their lower bounds are
+            //the insertion points
+            std::array<detail::flat_index_position, KEY_COUNT> positions;
+            std::size_t existed_index = find_unique_positions<0>(positions, keys...);
+            if(existed_index != KEY_COUNT)
+                return out_t{get_entry<0>().end(), false, existed_index};
+
+            std::uint32_t slot = acquire_slot();
+            std::allocator_traits<allocator_t>::construct(allocator,
+                                                          &get_slot(slot),
+                                                          std::forward<T>(value),
+                                                          std::forward<TKeys>(keys)...);
+            commit_slot(slot);
+
+            std::size_t inserted = 0;
+            try
+            {
+                [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+                {
+                    ((positions[Indices] = insert_into_index<Indices>(slot, positions[Indices]),
+                      inserted++),
+                     ...);
+                }(std::make_index_sequence<KEY_COUNT>{});
+            }
+            catch(...)
+            {
+                [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+                {
+                    ((Indices < inserted ? erase_from_index<Indices, KEY_COUNT>(slot, {}) : void()),
+                     ...);
+                }(std::make_index_sequence<KEY_COUNT>{});
+
+                release_slot(slot);
+                throw;
+            }
+
+            size++;
+            return out_t{typename entry_t<0>::iterator{this, positions[0]}, true, 0};
+        }
+
+        template<std::size_t Index, typename K>
+        requires(Index < sizeof...(CKeys) + 1) &&
+                requires(K&& key,
+                         compound_keys_t::template nth_t<Index>::comparator_t& comp,
+                         compound_keys_t::template nth_t<Index>::key_t& key_comp) {
+                    { comp(std::forward<K>(key), key_comp) } -> std::same_as<bool>;
+                    { comp(key_comp, std::forward<K>(key)) } -> std::same_as<bool>;
+                }
+        entry_t<Index>::iterator find(K&& key)
+        {
+            return {this, find_position<Index>(key)};
+        }
+
+        template<std::size_t Index, typename K>
+        requires(Index < sizeof...(CKeys) + 1) &&
+                requires(K&& key,
+                         compound_keys_t::template nth_t<Index>::comparator_t& comp,
+                         compound_keys_t::template nth_t<Index>::key_t& key_comp) {
+                    { comp(std::forward<K>(key), key_comp) } -> std::same_as<bool>;
+                    { comp(key_comp, std::forward<K>(key)) } -> std::same_as<bool>;
+                }
+        const_entry_t<Index>::iterator find(K&& key) const
+        {
+            return {this, find_position<Index>(key)};
+        }
+
+        template<std::size_t Index, typename K>
+        requires(Index < sizeof...(CKeys) + 1) &&
+                requires(K&& key,
+                         compound_keys_t::template nth_t<Index>::comparator_t& comp,
+                         compound_keys_t::template nth_t<Index>::key_t& key_comp) {
+                    { comp(std::forward<K>(key), key_comp) } noexcept -> std::same_as<bool>;
+                    { comp(key_comp, std::forward<K>(key)) } noexcept -> std::same_as<bool>;
+                }
+        bool contains(K&& key) const noexcept
+        {
+            return find_position<Index>(key) != std::get<Index>(indices).end();
+        }
+
+        allocator_t& get_allocator() noexcept
+        {
+            return allocator;
+        }
+
+        const allocator_t& get_allocator() const noexcept
+        {
+            return allocator;
+        }
+    private:
+        template<typename CK>
+        using index_t =
+            detail::flat_index<typename CK::key_t, typename CK::comparator_t, allocator_t>;
+
+        using indices_t = std::tuple<index_t<CKey>, index_t<CKeys>...>;
+
+        slot_t& get_slot(std::uint32_t slot) noexcept
+        {
+            return slot_blocks[slot / SLOT_BLOCK_SIZE][slot % SLOT_BLOCK_SIZE];
+        }
+
+        const slot_t& get_slot(std::uint32_t slot) const noexcept
+        {
+            return slot_blocks[slot / SLOT_BLOCK_SIZE][slot % SLOT_BLOCK_SIZE];
+        }
+
+        //the slot is taken by commit_slot after its value is constructed
+        std::uint32_t acquire_slot()
+        {
+            if(!free_slots.empty())
+                return free_slots.back();
+
+            if(slot_count == slot_blocks.size() * SLOT_BLOCK_SIZE)
+            {
+                //released slots never reallocate the free list
+                free_slots.reserve(slot_count + SLOT_BLOCK_SIZE);
+                slot_blocks.reserve(slot_blocks.size() + 1);
+                slot_blocks.push_back(
+                    std::allocator_traits<allocator_t>::allocate(allocator, SLOT_BLOCK_SIZE));
+            }
+
+            return static_cast<std::uint32_t>(slot_count);
+        }
+
+        void commit_slot(std::uint32_t slot) noexcept
+        {
+            hrs::assert_true_debug(
+                slot == (free_slots.empty() ? slot_count : free_slots.back()),
+                "Committed slot isn't the one returned by acquire_slot!");
+
+            if(!free_slots.empty())
+                free_slots.pop_back();
+            else
+                slot_count++;
+        }
+
+        void release_slot(std::uint32_t slot) noexcept
+        {
+            std::allocator_traits<allocator_t>::destroy(allocator, &get_slot(slot));
+            free_slots.push_back(slot);
+        }
+
+        template<std::size_t Index, typename... TKeys>
+        std::size_t
+        find_unique_positions(std::array<detail::flat_index_position, KEY_COUNT>& positions,
+                              const TKeys&... keys) const
+        {
+            using ckey_t = compound_keys_t::template nth_t<Index>;
+            if constexpr(std::same_as<typename ckey_t::key_map_t, map_unique_key>)
+            {
+                auto& index = std::get<Index>(indices);
+                auto& comp = std::get<Index>(comparators);
+                const auto& key = nth_argument<Index>(keys...);
+                auto pos = index.lower_bound(key, comp);
+                if(pos != index.end() && !comp(key, index.get(pos).key))
+                    return Index;
+
+                positions[Index] = pos;
+            }
+
+            if constexpr(Index + 1 < KEY_COUNT)
+                return find_unique_positions<Index + 1>(positions, keys...);
+            else
+                return KEY_COUNT;
+        }
+
+        template<std::size_t Index>
+        detail::flat_index_position insert_into_index(std::uint32_t slot,
+                                                      detail::flat_index_position pos)
+        {
+            using ckey_t = compound_keys_t::template nth_t<Index>;
+            auto& index = std::get<Index>(indices);
+            const auto& key = std::get<Index>(get_slot(slot).keys);
+            //shared keys go after their equals
+            if constexpr(std::same_as<typename ckey_t::key_map_t, map_shared_key>)
+                pos = index.upper_bound(key, std::get<Index>(comparators));
+
+            return index.insert(pos, key, slot);
+        }
+
+        //KnownIndex has the entry at known_pos
+        template<std::size_t Index, std::size_t KnownIndex>
+        void erase_from_index(std::uint32_t slot, detail::flat_index_position known_pos) noexcept
+        {
+            auto& index = std::get<Index>(indices);
+            if constexpr(Index == KnownIndex)
+                index.erase(known_pos);
+            else
+                index.erase(index.locate(std::get<Index>(get_slot(slot).keys),
+                                         slot,
+                                         std::get<Index>(comparators)));
+        }
+
+        template<std::size_t Index, typename K>
+        detail::flat_index_position find_position(const K& key) const
+        {
+            auto& index = std::get<Index>(indices);
+            auto& comp = std::get<Index>(comparators);
+            auto pos = index.lower_bound(key, comp);
+            if(pos == index.end() || comp(key, index.get(pos).key))
+                return index.end();
+
+            return pos;
+        }
+
+        template<std::size_t Index>
+        detail::flat_index_position locate(std::uint32_t slot) const
+        {
+            return std::get<Index>(indices).locate(std::get<Index>(get_slot(slot).keys),
+                                                   slot,
+                                                   std::get<Index>(comparators));
+        }
+
+        //indices and slot numbers are copied as they are
+        void copy_from(const basic_flat_multikey_map& mkm)
+        {
+            indices = mkm.indices;
+            free_slots = mkm.free_slots;
+            free_slots.reserve(mkm.slot_blocks.size() * SLOT_BLOCK_SIZE);
+            auto& index = std::get<0>(mkm.indices);
+            auto pos = index.begin();
+            try
+            {
+                slot_blocks.reserve(mkm.slot_blocks.size());
+                for(std::size_t i = 0; i < mkm.slot_blocks.size(); i++)
+                    slot_blocks.push_back(
+                        std::allocator_traits<allocator_t>::allocate(allocator, SLOT_BLOCK_SIZE));
+
+                for(; pos != index.end(); pos = index.next(pos))
+                {
+                    std::uint32_t slot = index.get(pos).slot;
+                    std::allocator_traits<allocator_t>::construct(allocator,
+                                                                  &get_slot(slot),
+                                                                  mkm.get_slot(slot));
+                }
+            }
+            catch(...)
+            {
+                for(auto done = index.begin(); done != pos; done = index.next(done))
+                    std::allocator_traits<allocator_t>::destroy(allocator,
+                                                                &get_slot(index.get(done).slot));
+
+                for(slot_t* block: slot_blocks)
+                    std::allocator_traits<allocator_t>::deallocate(allocator,
+                                                                   block,
+                                                                   SLOT_BLOCK_SIZE);
+
+                std::apply(
+                    [](auto&... _indices)
+                    {
+                        (_indices.clear(), ...);
+                    },
+                    indices);
+
+                slot_blocks.clear();
+                free_slots.clear();
+                throw;
+            }
+
+            slot_count = mkm.slot_count;
+            size = mkm.size;
+        }
+
+        void steal(basic_flat_multikey_map& mkm) noexcept
+        {
+            indices = std::move(mkm.indices);
+            slot_blocks = std::move(mkm.slot_blocks);
+            free_slots = std::move(mkm.free_slots);
+            slot_count = std::exchange(mkm.slot_count, 0);
+            size = std::exchange(mkm.size, 0);
+        }
+    private:
+        comparators_t comparators;
+        [[no_unique_address]] allocator_t allocator;
+        indices_t indices;
+        std::vector<slot_t*, typename std::allocator_traits<A>::template rebind_alloc<slot_t*>>
+            slot_blocks;
+        std::vector<std::uint32_t,
+                    typename std::allocator_traits<A>::template rebind_alloc<std::uint32_t>>
+            free_slots;
+        std::size_t slot_count;
+        std::size_t size;
+    };
+};
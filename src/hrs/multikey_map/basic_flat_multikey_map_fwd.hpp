@@ -0,0 +1,9 @@
+#pragma once
+
+#include "basic_multikey_map_fwd.hpp"
+
+namespace hrs
+{
+    template<typename V, typename A, type_instantiation<key> CKey, type_instantiation<key>... CKeys>
+    class basic_flat_multikey_map;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "flat_iterator.hpp"
+
+namespace hrs
+{
+    namespace detail
+    {
+        template<std::size_t Index, typename M>
+        requires hrs::type_instantiation<std::remove_cv_t<M>, basic_flat_multikey_map>
+        class flat_entry
+        {
+        public:
+            using map_t = M;
+
+            using key_t = typename M::compound_keys_t::template nth_t<Index>::key_t;
+            using value_t = typename M::value_t;
+
+            using iterator = detail::flat_iterator<Index, M>;
+            using const_iterator = detail::flat_iterator<Index, M>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            constexpr flat_entry(map_t* _map_ptr = nullptr) noexcept
+                : map_ptr(_map_ptr)
+            {}
+
+            ~flat_entry() = default;
+            flat_entry(const flat_entry&) = default;
+
+            auto begin() const noexcept
+            {
+                return iterator{map_ptr, std::get<Index>(map_ptr->indices).begin()};
+            }
+
+            auto end() const noexcept
+            {
+                return iterator{map_ptr, std::get<Index>(map_ptr->indices).end()};
+            }
+
+            auto rbegin() const noexcept
+            {
+                return reverse_iterator{end()};
+            }
+
+            auto rend() const noexcept
+            {
+                return reverse_iterator{begin()};
+            }
+
+            constexpr bool is_valid() const noexcept
+            {
+                return map_ptr;
+            }
+
+            constexpr operator bool() const noexcept
+            {
+                return is_valid();
+            }
+
+            constexpr map_t* get_map() noexcept
+            {
+                return map_ptr;
+            }
+
+            constexpr const map_t* get_map() const noexcept
+            {
+                return map_ptr;
+            }
+
+            template<std::size_t RIndex>
+            requires(RIndex <= M::compound_keys_t::COUNT)
+            constexpr auto rebind() noexcept
+            {
+                return flat_entry<RIndex, M>(map_ptr);
+            }
+        private:
+            map_t* map_ptr;
+        };
+    };
+};
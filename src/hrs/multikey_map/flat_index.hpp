@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hrs
+{
+    namespace detail
+    {
+        template<typename K>
+        struct flat_index_entry
+        {
+            K key;
+            std::uint32_t slot;
+        };
+
+        struct flat_index_position
+        {
+            std::size_t block;
+            std::size_t offset;
+
+            constexpr bool operator==(const flat_index_position&) const noexcept = default;
+        };
+
+        //Sorted (key, slot) pairs split into blocks of at most BLOCK_CAPACITY entries.
+        //The largest key of every block is kept in one contiguous array, so a search is
+        //a binary search over that array and one over a single block.
+        //Equal keys are kept in insertion order.
+        template<typename K, typename C, typename A>
+        class flat_index
+        {
+        public:
+            using entry_t = flat_index_entry<K>;
+            using position_t = flat_index_position;
+            using block_t =
+                std::vector<entry_t,
+                            typename std::allocator_traits<A>::template rebind_alloc<entry_t>>;
+
+            //blocks of about 4 KiB
+            constexpr static std::size_t BLOCK_CAPACITY =
+                std::max<std::size_t>(16, 4096 / sizeof(entry_t));
+
+            flat_index(const A& allocator)
+                : blocks(allocator),
+                  max_keys(allocator)
+            {}
+
+            ~flat_index() = default;
+            flat_index(const flat_index&) = default;
+            flat_index(flat_index&&) = default;
+            flat_index& operator=(const flat_index&) = default;
+            flat_index& operator=(flat_index&&) = default;
+
+            position_t begin() const noexcept
+            {
+                return {0, 0};
+            }
+
+            position_t end() const noexcept
+            {
+                return {blocks.size(), 0};
+            }
+
+            entry_t& get(position_t pos) noexcept
+            {
+                return blocks[pos.block][pos.offset];
+            }
+
+            const entry_t& get(position_t pos) const noexcept
+            {
+                return blocks[pos.block][pos.offset];
+            }
+
+            position_t next(position_t pos) const noexcept
+            {
+                if(++pos.offset == blocks[pos.block].size())
+                    return {pos.block + 1, 0};
+
+                return pos;
+            }
+
+            position_t prev(position_t pos) const noexcept
+            {
+                if(pos.offset == 0)
+                    return {pos.block - 1, blocks[pos.block - 1].size() - 1};
+
+                return {pos.block, pos.offset - 1};
+            }
+
+            //first entry that isn't less than key
+            template<typename Key>
+            position_t lower_bound(const Key& key, const C& comp) const
+            {
+                auto it = std::lower_bound(max_keys.begin(), max_keys.end(), key, comp);
+                if(it == max_keys.end())
+                    return end();
+
+                std::size_t block = static_cast<std::size_t>(it - max_keys.begin());
+                auto entry_it =
+                    std::lower_bound(blocks[block].begin(),
+                                     blocks[block].end(),
+                                     key,
+                                     [&comp](const entry_t& entry, const Key& k)
+                                     {
+                                         return comp(entry.key, k);
+                                     });
+
+                return {block, static_cast<std::size_t>(entry_it - blocks[block].begin())};
+            }
+
+            //first entry that is greater than key, the end of the last block if there is none
+            position_t upper_bound(const K& key, const C& comp) const
+            {
+                if(blocks.empty())
+                    return end();
+
+                auto it = std::upper_bound(max_keys.begin(), max_keys.end(), key, comp);
+                std::size_t block = (it == max_keys.end()
+                                         ? blocks.size() - 1
+                                         : static_cast<std::size_t>(it - max_keys.begin()));
+                auto entry_it = std::upper_bound(blocks[block].begin(),
+                                                 blocks[block].end(),
+                                                 key,
+                                                 [&comp](const K& k, const entry_t& entry)
+                                                 {
+                                                     return comp(k, entry.key);
+                                                 });
+
+                return {block, static_cast<std::size_t>(entry_it - blocks[block].begin())};
+            }
+
+            //the entry of slot among the entries equal to key
+            position_t locate(const K& key, std::uint32_t slot, const C& comp) const
+            {
+                position_t pos = lower_bound(key, comp);
+                while(pos != end() && get(pos).slot != slot)
+                    pos = next(pos);
+
+                return pos;
+            }
+
+            //pos is a lower or an upper bound of key, returns the position of the new entry
+            position_t insert(position_t pos, const K& key, std::uint32_t slot)
+            {
+                if(blocks.empty())
+                {
+                    blocks.emplace_back(blocks.get_allocator());
+                    blocks.back().reserve(BLOCK_CAPACITY + 1);
+                    max_keys.push_back(key);
+                    pos = {0, 0};
+                }
+                else if(pos.block == blocks.size())
+                    pos = {blocks.size() - 1, blocks.back().size()};
+
+                block_t& block = blocks[pos.block];
+                block.insert(block.begin() + static_cast<std::ptrdiff_t>(pos.offset),
+                             entry_t{key, slot});
+                if(pos.offset == block.size() - 1)
+                    max_keys[pos.block] = key;
+
+                if(block.size() > BLOCK_CAPACITY)
+                    return split(pos);
+
+                return pos;
+            }
+
+            void erase(position_t pos) noexcept
+            {
+                block_t& block = blocks[pos.block];
+                block.erase(block.begin() + static_cast<std::ptrdiff_t>(pos.offset));
+                if(block.empty())
+                {
+                    blocks.erase(blocks.begin() + static_cast<std::ptrdiff_t>(pos.block));
+                    max_keys.erase(max_keys.begin() + static_cast<std::ptrdiff_t>(pos.block));
+                    return;
+                }
+
+                if(pos.offset == block.size())
+                    max_keys[pos.block] = block.back().key;
+
+                //sparse blocks are merged, so lookups don't degrade after mass erasure
+                std::size_t next_block = pos.block + 1;
+                if(block.size() < BLOCK_CAPACITY / 4 && next_block < blocks.size() &&
+                   block.size() + blocks[next_block].size() <= BLOCK_CAPACITY)
+                {
+                    block.insert(block.end(),
+                                 std::make_move_iterator(blocks[next_block].begin()),
+                                 std::make_move_iterator(blocks[next_block].end()));
+                    max_keys[pos.block] = std::move(max_keys[next_block]);
+                    blocks.erase(blocks.begin() + static_cast<std::ptrdiff_t>(next_block));
+                    max_keys.erase(max_keys.begin() + static_cast<std::ptrdiff_t>(next_block));
+                }
+            }
+
+            void clear() noexcept
+            {
+                blocks.clear();
+                max_keys.clear();
+            }
+        private:
+            position_t split(position_t pos)
+            {
+                block_t& block = blocks[pos.block];
+                std::size_t half = block.size() / 2;
+                block_t upper(block.get_allocator());
+                upper.reserve(BLOCK_CAPACITY + 1);
+                upper.assign(std::make_move_iterator(block.begin() +
+                                                     static_cast<std::ptrdiff_t>(half)),
+                             std::make_move_iterator(block.end()));
+
+                auto next_block = static_cast<std::ptrdiff_t>(pos.block + 1);
+                blocks.insert(blocks.begin() + next_block, std::move(upper));
+                max_keys.insert(max_keys.begin() + next_block, blocks[pos.block + 1].back().key);
+
+                block_t& lower = blocks[pos.block];
+                lower.erase(lower.begin() + static_cast<std::ptrdiff_t>(half), lower.end());
+                max_keys[pos.block] = lower.back().key;
+
+                if(pos.offset >= half)
+                    return {pos.block + 1, pos.offset - half};
+
+                return pos;
+            }
+        private:
+            std::vector<block_t, typename std::allocator_traits<A>::template rebind_alloc<block_t>>
+                blocks;
+            std::vector<K, typename std::allocator_traits<A>::template rebind_alloc<K>> max_keys;
+        };
+    };
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../copy_traits.hpp"
+#include "../instantiation.hpp"
+#include "../variadic.hpp"
+#include "basic_flat_multikey_map_fwd.hpp"
+#include "flat_index.hpp"
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace hrs
+{
+    namespace detail
+    {
+        //position in the index of Index, invalidated by insertions and erasures
+        template<std::size_t Index, typename M>
+        requires hrs::type_instantiation<std::remove_cv_t<M>, basic_flat_multikey_map>
+        class flat_iterator
+        {
+        public:
+            template<typename V,
+                     typename A,
+                     type_instantiation<key> CKey,
+                     type_instantiation<key>... CKeys>
+            friend class ::hrs::basic_flat_multikey_map;
+
+            using key_t = const typename M::compound_keys_t::template nth_t<Index>::key_t;
+            using value_t = copy_cv_t<M, typename M::value_t>;
+            using position_t = flat_index_position;
+
+            //iterator traits
+            using difference_type = std::ptrdiff_t;
+            using value_type = std::pair<key_t&, value_t&>;
+            using pointer = value_type*;
+            using reference = value_type&;
+            using iterator_category = std::bidirectional_iterator_tag;
+            using iterator_concept = std::bidirectional_iterator_tag;
+
+            constexpr flat_iterator(M* _map = nullptr, position_t _pos = {}) noexcept
+                : map(_map),
+                  pos(_pos)
+            {}
+
+            ~flat_iterator() = default;
+            flat_iterator(const flat_iterator&) = default;
+            flat_iterator(flat_iterator&&) = default;
+            flat_iterator& operator=(const flat_iterator&) = default;
+            flat_iterator& operator=(flat_iterator&&) = default;
+
+            constexpr auto operator++(int) noexcept
+            {
+                auto it = *this;
+                ++(*this);
+                return it;
+            }
+
+            constexpr decltype(auto) operator++() noexcept
+            {
+                pos = get_index().next(pos);
+                return *this;
+            }
+
+            constexpr auto operator--(int) noexcept
+            {
+                auto it = *this;
+                --(*this);
+                return it;
+            }
+
+            constexpr decltype(auto) operator--() noexcept
+            {
+                pos = get_index().prev(pos);
+                return *this;
+            }
+
+            constexpr std::pair<key_t&, value_t&> operator*() const noexcept
+            {
+                return {get_index().get(pos).key, get_slot().data};
+            }
+
+            constexpr key_t& key() const noexcept
+            {
+                return get_index().get(pos).key;
+            }
+
+            constexpr decltype(auto) keys() const noexcept
+            {
+                return (get_slot().keys);
+            }
+
+            constexpr value_t& value() const noexcept
+            {
+                return get_slot().data;
+            }
+
+            constexpr bool operator==(const flat_iterator& it) const noexcept
+            {
+                return pos == it.pos;
+            }
+
+            //searches the index of RIndex for the same value
+            template<std::size_t RIndex>
+            requires(RIndex < M::compound_keys_t::COUNT)
+            constexpr flat_iterator<RIndex, M> rebind() const
+            {
+                return {map, map->template locate<RIndex>(get_index().get(pos).slot)};
+            }
+        private:
+            constexpr auto& get_index() const noexcept
+            {
+                return std::get<Index>(map->indices);
+            }
+
+            constexpr auto& get_slot() const noexcept
+            {
+                return map->get_slot(get_index().get(pos).slot);
+            }
+        private:
+            M* map;
+            position_t pos;
+        };
+    };
+};
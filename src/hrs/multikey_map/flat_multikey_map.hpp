@@ -0,0 +1,10 @@
+#pragma once
+
+#include "basic_flat_multikey_map.hpp"
+
+namespace hrs
+{
+    template<typename V, type_instantiation<key> CKey, type_instantiation<key>... CKeys>
+    using flat_multikey_map =
+        basic_flat_multikey_map<V, std::allocator<std::tuple<V, CKey, CKeys...>>, CKey, CKeys...>;
+};
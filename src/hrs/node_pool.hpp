@@ -0,0 +1,314 @@
+#pragma once
+
+#include "debug.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace hrs
+{
+    //Fixed-size nodes carved from slabs and recycled through an intrusive free list.
+    //Slabs are released only by release() or the destructor. Not thread-safe.
+    template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+    requires(Size != 0 && (Alignment & (Alignment - 1)) == 0)
+    class node_pool
+    {
+    private:
+        struct free_node
+        {
+            free_node* next;
+        };
+
+        struct slab_header
+        {
+            slab_header* next;
+        };
+    public:
+        constexpr static std::size_t NODE_ALIGNMENT = std::max(Alignment, alignof(free_node));
+        constexpr static std::size_t NODE_SIZE =
+            (std::max(Size, sizeof(free_node)) + NODE_ALIGNMENT - 1) / NODE_ALIGNMENT *
+            NODE_ALIGNMENT;
+        //the header is padded so the first node stays aligned
+        constexpr static std::size_t SLAB_HEADER_SIZE =
+            (sizeof(slab_header) + NODE_ALIGNMENT - 1) / NODE_ALIGNMENT * NODE_ALIGNMENT;
+        //slabs of about 64 KiB
+        constexpr static std::size_t SLAB_NODE_COUNT =
+            std::max<std::size_t>(16, (64 * 1024 - SLAB_HEADER_SIZE) / NODE_SIZE);
+        constexpr static std::size_t SLAB_SIZE = SLAB_HEADER_SIZE + SLAB_NODE_COUNT * NODE_SIZE;
+        constexpr static std::size_t SLAB_ALIGNMENT =
+            std::max(NODE_ALIGNMENT, alignof(slab_header));
+
+        node_pool() noexcept
+            : free_list(nullptr),
+              bump(nullptr),
+              bump_end(nullptr),
+              slabs(nullptr),
+              slab_count(0)
+        {}
+
+        ~node_pool()
+        {
+            release();
+        }
+
+        node_pool(const node_pool&) = delete;
+
+        node_pool(node_pool&& pool) noexcept
+            : free_list(std::exchange(pool.free_list, nullptr)),
+              bump(std::exchange(pool.bump, nullptr)),
+              bump_end(std::exchange(pool.bump_end, nullptr)),
+              slabs(std::exchange(pool.slabs, nullptr)),
+              slab_count(std::exchange(pool.slab_count, 0))
+        {}
+
+        node_pool& operator=(const node_pool&) = delete;
+
+        node_pool& operator=(node_pool&& pool) noexcept
+        {
+            release();
+            free_list = std::exchange(pool.free_list, nullptr);
+            bump = std::exchange(pool.bump, nullptr);
+            bump_end = std::exchange(pool.bump_end, nullptr);
+            slabs = std::exchange(pool.slabs, nullptr);
+            slab_count = std::exchange(pool.slab_count, 0);
+
+            return *this;
+        }
+
+        void* allocate()
+        {
+            if(free_list)
+                return std::exchange(free_list, free_list->next);
+
+            if(bump == bump_end)
+                add_slab();
+
+            return std::exchange(bump, bump + NODE_SIZE);
+        }
+
+        void deallocate(void* ptr) noexcept
+        {
+            hrs::assert_true_debug(ptr != nullptr, "Deallocated node is null!");
+
+            free_list = ::new(ptr) free_node{free_list};
+        }
+
+        //every node must be deallocated or abandoned before the call
+        void release() noexcept
+        {
+            while(slabs)
+            {
+                slab_header* next = slabs->next;
+                ::operator delete(slabs, SLAB_SIZE, std::align_val_t(SLAB_ALIGNMENT));
+                slabs = next;
+            }
+
+            free_list = nullptr;
+            bump = nullptr;
+            bump_end = nullptr;
+            slab_count = 0;
+        }
+
+        std::size_t get_slab_count() const noexcept
+        {
+            return slab_count;
+        }
+    private:
+        void add_slab()
+        {
+            void* memory = ::operator new(SLAB_SIZE, std::align_val_t(SLAB_ALIGNMENT));
+            slabs = ::new(memory) slab_header{slabs};
+            bump = static_cast<std::byte*>(memory) + SLAB_HEADER_SIZE;
+            bump_end = bump + SLAB_NODE_COUNT * NODE_SIZE;
+            slab_count++;
+        }
+    private:
+        free_node* free_list;
+        std::byte* bump;
+        std::byte* bump_end;
+        slab_header* slabs;
+        std::size_t slab_count;
+    };
+
+    namespace detail
+    {
+        //one process-wide pool per node layout
+        template<std::size_t Size, std::size_t Alignment>
+        class shared_node_pool
+        {
+        public:
+            //nodes move between the shared pool and a thread cache in batches of BATCH_SIZE
+            constexpr static std::size_t BATCH_SIZE = 64;
+
+            //never destroyed: nodes may still be released by destructors of static objects
+            static shared_node_pool& get() noexcept
+            {
+                static shared_node_pool* pool = ::new shared_node_pool;
+                return *pool;
+            }
+
+            void* allocate()
+            {
+                std::lock_guard lock(mutex);
+                return pool.allocate();
+            }
+
+            void deallocate(void* ptr) noexcept
+            {
+                std::lock_guard lock(mutex);
+                pool.deallocate(ptr);
+            }
+
+            //appends up to count nodes to the chain, returns the appended count
+            std::size_t acquire_batch(void*& head, std::size_t count)
+            {
+                std::lock_guard lock(mutex);
+                std::size_t acquired = 0;
+                try
+                {
+                    for(; acquired < count; acquired++)
+                        head = ::new(pool.allocate()) void*{head};
+                }
+                catch(...)
+                {
+                    if(acquired == 0)
+                        throw;
+                }
+
+                return acquired;
+            }
+
+            //returns count nodes of the chain, head becomes the rest of it
+            void release_batch(void*& head, std::size_t count) noexcept
+            {
+                std::lock_guard lock(mutex);
+                for(std::size_t i = 0; i < count; i++)
+                    pool.deallocate(std::exchange(head, *static_cast<void**>(head)));
+            }
+        private:
+            shared_node_pool() = default;
+        private:
+            std::mutex mutex;
+            node_pool<Size, Alignment> pool;
+        };
+
+        template<std::size_t Size, std::size_t Alignment>
+        class node_thread_cache
+        {
+        public:
+            using shared_pool_t = shared_node_pool<Size, Alignment>;
+
+            //null once the cache of the thread is destroyed, the main thread's cache is
+            //destroyed before static objects that may still release nodes
+            static node_thread_cache* get() noexcept
+            {
+                if(destroyed)
+                    return nullptr;
+
+                thread_local node_thread_cache cache;
+                return &cache;
+            }
+
+            ~node_thread_cache()
+            {
+                shared_pool_t::get().release_batch(head, count);
+                count = 0;
+                destroyed = true;
+            }
+
+            void* allocate()
+            {
+                if(count == 0)
+                    count = shared_pool_t::get().acquire_batch(head, shared_pool_t::BATCH_SIZE);
+
+                count--;
+                return std::exchange(head, *static_cast<void**>(head));
+            }
+
+            void deallocate(void* ptr) noexcept
+            {
+                head = ::new(ptr) void*{head};
+                if(++count == shared_pool_t::BATCH_SIZE * 2)
+                {
+                    shared_pool_t::get().release_batch(head, shared_pool_t::BATCH_SIZE);
+                    count -= shared_pool_t::BATCH_SIZE;
+                }
+            }
+        private:
+            //trivially destructible, so it stays readable after the cache is destroyed
+            inline static thread_local bool destroyed = false;
+            void* head = nullptr;
+            std::size_t count = 0;
+        };
+    };
+
+    //Stateless allocator over a process-wide node pool for sizeof(T) and alignof(T).
+    //Single-object allocations come from the pool, others fall back to std::allocator.
+    //With ThreadCache every thread keeps up to two batches of free nodes and touches the
+    //shared pool's mutex once per batch; without it every call locks the mutex.
+    //Memory may be deallocated from any thread. Once a thread's cache is destroyed the calls of
+    //that thread go straight to the shared pool.
+    template<typename T, bool ThreadCache = true>
+    class pool_allocator
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using propagate_on_container_move_assignment = std::true_type;
+        using is_always_equal = std::true_type;
+
+        template<typename U>
+        struct rebind
+        {
+            using other = pool_allocator<U, ThreadCache>;
+        };
+
+        constexpr pool_allocator() noexcept = default;
+
+        template<typename U>
+        constexpr pool_allocator(const pool_allocator<U, ThreadCache>&) noexcept
+        {}
+
+        [[nodiscard]] T* allocate(std::size_t n)
+        {
+            if(n != 1)
+                return std::allocator<T>{}.allocate(n);
+
+            if constexpr(ThreadCache)
+                if(auto* cache = detail::node_thread_cache<sizeof(T), alignof(T)>::get(); cache)
+                    return static_cast<T*>(cache->allocate());
+
+            return static_cast<T*>(
+                detail::shared_node_pool<sizeof(T), alignof(T)>::get().allocate());
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept
+        {
+            if(n != 1)
+            {
+                std::allocator<T>{}.deallocate(ptr, n);
+                return;
+            }
+
+            if constexpr(ThreadCache)
+                if(auto* cache = detail::node_thread_cache<sizeof(T), alignof(T)>::get(); cache)
+                {
+                    cache->deallocate(ptr);
+                    return;
+                }
+
+            detail::shared_node_pool<sizeof(T), alignof(T)>::get().deallocate(ptr);
+        }
+
+        template<typename U>
+        constexpr bool operator==(const pool_allocator<U, ThreadCache>&) const noexcept
+        {
+            return true;
+        }
+    };
+};
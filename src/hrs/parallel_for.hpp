@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace hrs
+{
+    inline std::size_t hardware_thread_count() noexcept
+    {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    //Splits [0, count) into at most thread_count contiguous ranges and calls
+    //func(begin, end, range_index) for each of them on its own thread.
+    //The last range is processed on the calling thread. thread_count == 0 means all hardware threads.
+    //func must not throw!
+    template<typename F>
+    requires std::invocable<F&, std::size_t, std::size_t, std::size_t>
+    void parallel_for(std::size_t count, std::size_t thread_count, F&& func)
+    {
+        if(count == 0)
+            return;
+
+        if(thread_count == 0)
+            thread_count = hardware_thread_count();
+
+        thread_count = std::min(thread_count, count);
+        if(thread_count == 1)
+        {
+            func(std::size_t(0), count, std::size_t(0));
+            return;
+        }
+
+        std::size_t step = count / thread_count;
+        std::size_t remainder = count % thread_count;
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        std::size_t begin = 0;
+        for(std::size_t i = 0; i < thread_count - 1; i++)
+        {
+            std::size_t end = begin + step + (i < remainder ? 1 : 0);
+            threads.emplace_back(
+                [&func, begin, end, i]()
+                {
+                    func(begin, end, i);
+                });
+            begin = end;
+        }
+
+        func(begin, count, thread_count - 1);
+
+        for(auto& thread: threads)
+            thread.join();
+    }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "hash.hpp"
+#include "stacktrace.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+#if defined(unix) || defined(__unix) || defined(__unix__)
+#    include "stacktrace_impl/unwind/raw_stacktrace.h"
+#elif defined(_WIN32) || defined(_WIN64)
+#    include "stacktrace_impl/winapi/raw_stacktrace.h"
+#endif
+
+//capture() must be inlined into its caller, otherwise it would be the first captured frame
+#if defined(_MSC_VER) && !defined(__clang__)
+#    define HRS_RAW_STACKTRACE_CAPTURE_INLINE __forceinline
+#else
+#    define HRS_RAW_STACKTRACE_CAPTURE_INLINE [[gnu::always_inline]] inline
+#endif
+
+namespace hrs
+{
+#if defined(unix) || defined(__unix) || defined(__unix__)
+    using unwind::capture_frames;
+#elif defined(_WIN32) || defined(_WIN64)
+    using winapi::capture_frames;
+#endif
+
+    //Return addresses only, symbolized later through symbol_cache.
+    //Capturing doesn't allocate and is async-signal-safe with stack_capture_method::frame_pointers,
+    //which only sees the whole stack in builds with frame pointers (see stack_capture_method).
+    template<std::size_t Capacity = 32>
+    requires(Capacity != 0)
+    class raw_stacktrace
+    {
+    public:
+        constexpr raw_stacktrace() noexcept
+            : frames{},
+              count(0)
+        {}
+
+        ~raw_stacktrace() = default;
+        raw_stacktrace(const raw_stacktrace&) = default;
+        raw_stacktrace& operator=(const raw_stacktrace&) = default;
+
+        //the first frame is in the caller
+        HRS_RAW_STACKTRACE_CAPTURE_INLINE void
+        capture(std::size_t skip_frame_count = 0,
+                stack_capture_method method = stack_capture_method::unwind_tables) noexcept
+        {
+            count = capture_frames(frames, Capacity, skip_frame_count, method);
+        }
+
+        void* const* begin() const noexcept
+        {
+            return frames;
+        }
+
+        void* const* end() const noexcept
+        {
+            return frames + count;
+        }
+
+        void* operator[](std::size_t index) const noexcept
+        {
+            return frames[index];
+        }
+
+        std::size_t size() const noexcept
+        {
+            return count;
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        constexpr static std::size_t capacity() noexcept
+        {
+            return Capacity;
+        }
+
+        //identical stacks have equal hashes, e.g. for grouping allocations
+        std::uint64_t hash() const noexcept
+        {
+            return hrs::hash_bytes(std::as_bytes(std::span(frames, count)));
+        }
+
+        bool operator==(const raw_stacktrace& trace) const noexcept
+        {
+            return std::equal(begin(), end(), trace.begin(), trace.end());
+        }
+    private:
+        void* frames[Capacity];
+        std::size_t count;
+    };
+
+    struct resolved_frame
+    {
+        std::string function_name;
+        std::string object_path;
+    };
+
+    //Symbolizes and demangles every return address once. Thread-safe.
+    class symbol_cache
+    {
+    public:
+        symbol_cache() = default;
+        ~symbol_cache() = default;
+        symbol_cache(const symbol_cache&) = delete;
+        symbol_cache& operator=(const symbol_cache&) = delete;
+
+        //the reference stays valid until clear()
+        const resolved_frame& resolve(void* address)
+        {
+            std::lock_guard lock(mutex);
+            auto it = frames.find(address);
+            if(it == frames.end())
+            {
+                const frame fr(address);
+                it = frames.emplace(address, resolved_frame{fr.function_name(), fr.object_path()})
+                         .first;
+            }
+
+            return it->second;
+        }
+
+        //one "#index: object: function" line per frame
+        template<std::size_t Capacity>
+        std::string to_string(const raw_stacktrace<Capacity>& trace)
+        {
+            std::string str;
+            for(std::size_t i = 0; i < trace.size(); i++)
+            {
+                const resolved_frame& fr = resolve(trace[i]);
+                str.append(std::format("#{}: {}: {}\n", i, fr.object_path, fr.function_name));
+            }
+
+            return str;
+        }
+
+        std::size_t size() const
+        {
+            std::lock_guard lock(mutex);
+            return frames.size();
+        }
+
+        void clear()
+        {
+            std::lock_guard lock(mutex);
+            frames.clear();
+        }
+    private:
+        mutable std::mutex mutex;
+        std::unordered_map<void*, resolved_frame> frames;
+    };
+};
+
+#undef HRS_RAW_STACKTRACE_CAPTURE_INLINE
@@ -4,12 +4,15 @@
 
 namespace hrs
 {
-    template<std::unsigned_integral T>
-    class sized_free_block_chain : public free_block_chain_base<T>
+    template<std::unsigned_integral T, typename A = pool_allocator<block<T>>>
+    class sized_free_block_chain : public free_block_chain_base<T, A>
     {
     public:
+        using typename free_block_chain_base<T, A>::iterator;
+        using typename free_block_chain_base<T, A>::const_iterator;
+
         sized_free_block_chain(T _size = 0, T _outer_offset = 0)
-            : free_block_chain_base<T>(_size, _outer_offset)
+            : free_block_chain_base<T, A>(_size, _outer_offset)
         {}
 
         sized_free_block_chain(const sized_free_block_chain&) = default;
@@ -22,12 +25,12 @@ namespace hrs
             return this->acquire_from_existed(mem_req<T>(block_size, block_alignment));
         }
 
-        bool is_hint_valid(std::list<block<T>>::const_iterator hint_it) const noexcept
+        bool is_hint_valid(const_iterator hint_it) const noexcept
         {
             return hrs::is_iterator_part_of_range(this->blocks, hint_it);
         }
 
-        bool is_block_can_be_placed(std::list<block<T>>::const_iterator hint_it,
+        bool is_block_can_be_placed(const_iterator hint_it,
                                     T block_size,
                                     T block_alignment) const noexcept
         {
@@ -54,7 +57,7 @@ namespace hrs
             }
         }
 
-        hrs::block<T> acquire_by_hint(std::list<block<T>>::iterator hint_it,
+        hrs::block<T> acquire_by_hint(iterator hint_it,
                                       const mem_req<T>& req) noexcept
         {
             hrs::assert_true_debug(hrs::is_iterator_part_of_range_debug(this->blocks, hint_it),
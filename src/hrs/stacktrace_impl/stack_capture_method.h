@@ -0,0 +1,16 @@
+#pragma once
+
+namespace hrs
+{
+    enum class stack_capture_method
+    {
+        //walks the unwind tables, works without frame pointers
+        unwind_tables,
+        //follows saved frame pointers, strictly async-signal-safe and the cheapest.
+        //Needs the whole program built with -fno-omit-frame-pointer (MDENG_FRAME_POINTERS),
+        //such frames can't be detected: a function without one is missing from the trace,
+        //or the walk ends early when it keeps data in the frame pointer register.
+        //Without the flag an optimized build usually gets a single frame
+        frame_pointers
+    };
+};
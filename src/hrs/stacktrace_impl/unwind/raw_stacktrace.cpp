@@ -0,0 +1,91 @@
+#include "raw_stacktrace.h"
+#include <cstdint>
+#include <unwind.h>
+
+namespace hrs
+{
+    namespace unwind
+    {
+        struct raw_unwind_data
+        {
+            void** buffer;
+            std::size_t capacity;
+            std::size_t count;
+            std::size_t skip_frame_count;
+        };
+
+        static _Unwind_Reason_Code raw_unwind_callback(_Unwind_Context* context,
+                                                       void* data) noexcept
+        {
+            raw_unwind_data* _data = static_cast<raw_unwind_data*>(data);
+            if(_data->count == _data->capacity)
+                return _Unwind_Reason_Code::_URC_END_OF_STACK;
+
+            auto ip = _Unwind_GetIP(context);
+            if(!ip)
+                return _Unwind_Reason_Code::_URC_END_OF_STACK;
+
+            if(_data->skip_frame_count != 0)
+                _data->skip_frame_count--;
+            else
+                _data->buffer[_data->count++] = reinterpret_cast<void*>(ip);
+
+            return _Unwind_Reason_Code::_URC_NO_REASON;
+        }
+
+        //the first backtrace may load libgcc_s and allocate, so it happens at load time
+        [[maybe_unused]] static const bool unwinder_primed = []() noexcept
+        {
+            void* frames[1];
+            raw_unwind_data data{frames, 1, 0, 0};
+            _Unwind_Backtrace(raw_unwind_callback, &data);
+            return true;
+        }();
+
+        [[gnu::noinline]] std::size_t capture_frames(void** buffer,
+                                                     std::size_t capacity,
+                                                     std::size_t skip_frame_count,
+                                                     stack_capture_method method) noexcept
+        {
+#if defined(__x86_64__) || defined(__aarch64__)
+            if(method == stack_capture_method::frame_pointers)
+            {
+                //a frame record is {caller's frame pointer, return address}, the caller's frame
+                //is above this one and not too far away. Frames without a record can't be told
+                //apart, the checks only keep the walk inside the stack
+                constexpr std::uintptr_t MAX_FRAME_SIZE = 100000;
+
+                void** fp = static_cast<void**>(__builtin_frame_address(0));
+                std::size_t count = 0;
+                while(fp && count < capacity)
+                {
+                    void* return_address = fp[1];
+                    if(!return_address)
+                        break;
+
+                    if(skip_frame_count != 0)
+                        skip_frame_count--;
+                    else
+                        buffer[count++] = return_address;
+
+                    void** next_fp = static_cast<void**>(fp[0]);
+                    auto current = reinterpret_cast<std::uintptr_t>(fp);
+                    auto next = reinterpret_cast<std::uintptr_t>(next_fp);
+                    if(next <= current || next - current > MAX_FRAME_SIZE ||
+                       next % alignof(void*) != 0)
+                        break;
+
+                    fp = next_fp;
+                }
+
+                return count;
+            }
+#endif
+
+            //skips this function
+            raw_unwind_data data{buffer, capacity, 0, skip_frame_count + 1};
+            _Unwind_Backtrace(raw_unwind_callback, &data);
+            return data.count;
+        }
+    };
+};
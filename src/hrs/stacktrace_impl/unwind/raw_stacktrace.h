@@ -0,0 +1,18 @@
+#pragma once
+
+#include "../stack_capture_method.h"
+#include <cstddef>
+
+namespace hrs
+{
+    namespace unwind
+    {
+        //Writes up to capacity return addresses of the caller's stack into buffer, the first one is
+        //in the caller. Doesn't allocate. The unwinder is primed when the library is loaded, so
+        //unwind_tables is async-signal-safe unless the signal interrupts the dynamic loader.
+        std::size_t capture_frames(void** buffer,
+                                   std::size_t capacity,
+                                   std::size_t skip_frame_count,
+                                   stack_capture_method method) noexcept;
+    };
+};
@@ -0,0 +1,24 @@
+#include "raw_stacktrace.h"
+#include <algorithm>
+#define NOMINMAX
+#include <Windows.h>
+
+namespace hrs
+{
+    namespace winapi
+    {
+        __declspec(noinline) std::size_t
+            capture_frames(void** buffer,
+                           std::size_t capacity,
+                           std::size_t skip_frame_count,
+                           [[maybe_unused]] stack_capture_method method) noexcept
+        {
+            //skips this function
+            return RtlCaptureStackBackTrace(
+                static_cast<DWORD>(skip_frame_count + 1),
+                static_cast<DWORD>(std::min<std::size_t>(capacity, MAXDWORD)),
+                buffer,
+                nullptr);
+        }
+    };
+};
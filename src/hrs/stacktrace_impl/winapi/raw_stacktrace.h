@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../stack_capture_method.h"
+#include <cstddef>
+
+namespace hrs
+{
+    namespace winapi
+    {
+        //Writes up to capacity return addresses of the caller's stack into buffer, the first one is
+        //in the caller. Doesn't allocate. Both methods use RtlCaptureStackBackTrace.
+        std::size_t capture_frames(void** buffer,
+                                   std::size_t capacity,
+                                   std::size_t skip_frame_count,
+                                   stack_capture_method method) noexcept;
+    };
+};
@@ -0,0 +1,306 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace hrs
+{
+    namespace test
+    {
+        bench_state::bench_state(std::size_t _iterations) noexcept
+            : iterations(_iterations),
+              remaining(_iterations),
+              bytes_per_iteration(0)
+        {}
+
+        void bench_state::set_bytes_per_iteration(std::size_t bytes) noexcept
+        {
+            bytes_per_iteration = bytes;
+        }
+
+        std::size_t bench_state::get_iterations() const noexcept
+        {
+            return iterations;
+        }
+
+        std::size_t bench_state::get_bytes_per_iteration() const noexcept
+        {
+            return bytes_per_iteration;
+        }
+
+        bool bench_state::is_finished() const noexcept
+        {
+            return remaining == 0 && stop != clock_t::time_point{};
+        }
+
+        std::chrono::nanoseconds bench_state::get_elapsed() const noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+        }
+
+        bench_data::bench_data(std::function<void(bench_state&)>&& _func,
+                               std::string_view _name,
+                               std::string_view _tag,
+                               hrs::flags<test_property> _properties)
+            : func(std::move(_func)),
+              name(_name),
+              tag(_tag),
+              properties(_properties)
+        {}
+
+        void bench_data::operator()(bench_state& state) const
+        {
+            func(state);
+        }
+
+        const std::string& bench_data::get_name() const noexcept
+        {
+            return name;
+        }
+
+        const std::string& bench_data::get_tag() const noexcept
+        {
+            return tag;
+        }
+
+        hrs::flags<test_property> bench_data::get_properties() const noexcept
+        {
+            return properties;
+        }
+
+        static std::chrono::nanoseconds run_bench(const bench_data& bench,
+                                                  std::size_t iterations,
+                                                  std::size_t* bytes_per_iteration = nullptr)
+        {
+            bench_state state(iterations);
+            bench(state);
+            if(!state.is_finished())
+                throw std::logic_error("Benchmark body didn't finish its keep_running() loop!");
+
+            if(bytes_per_iteration)
+                *bytes_per_iteration = state.get_bytes_per_iteration();
+
+            return state.get_elapsed();
+        }
+
+        bench_result measure_bench(const bench_data& bench,
+                                   std::string_view group,
+                                   const bench_options& options)
+        {
+            using clock_t = bench_state::clock_t;
+
+            auto warmup_end = clock_t::now() + options.warmup_time;
+            std::size_t iterations = 1;
+            for(;;)
+            {
+                auto elapsed = run_bench(bench, iterations);
+                if(elapsed >= options.min_sample_time)
+                    break;
+
+                //aim slightly above the target, but grow at most 100 times per step
+                double scale = (elapsed.count() == 0
+                                    ? 100.0
+                                    : 1.2 * static_cast<double>(options.min_sample_time.count()) /
+                                          static_cast<double>(elapsed.count()));
+                scale = std::clamp(scale, 2.0, 100.0);
+                iterations = static_cast<std::size_t>(static_cast<double>(iterations) * scale);
+            }
+
+            while(clock_t::now() < warmup_end)
+                run_bench(bench, iterations);
+
+            std::size_t sample_count = std::max<std::size_t>(options.sample_count, 1);
+            std::vector<double> samples(sample_count);
+            std::size_t bytes_per_iteration = 0;
+            for(double& sample: samples)
+                sample = static_cast<double>(
+                             run_bench(bench, iterations, &bytes_per_iteration).count()) /
+                         static_cast<double>(iterations);
+
+            std::sort(samples.begin(), samples.end());
+
+            bench_result result;
+            result.name = bench.get_name();
+            result.group = group;
+            result.iterations = iterations;
+            result.sample_count = sample_count;
+            result.min = samples.front();
+            result.max = samples.back();
+            result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+                          static_cast<double>(sample_count);
+            result.median = (sample_count % 2 == 1
+                                 ? samples[sample_count / 2]
+                                 : (samples[sample_count / 2 - 1] + samples[sample_count / 2]) / 2);
+            //Linear interpolation between the closest ranks: the nearest rank of a small sample set
+            //is its max, so it would say nothing about the tail apart from the worst outlier
+            double p99_rank = 0.99 * static_cast<double>(sample_count - 1);
+            auto p99_low = static_cast<std::size_t>(p99_rank);
+            auto p99_high = std::min(p99_low + 1, sample_count - 1);
+            result.p99 = samples[p99_low] + (samples[p99_high] - samples[p99_low]) *
+                                                (p99_rank - static_cast<double>(p99_low));
+            if(bytes_per_iteration != 0 && result.median > 0.0)
+                result.bytes_per_second =
+                    static_cast<double>(bytes_per_iteration) * 1e9 / result.median;
+
+            return result;
+        }
+
+        static std::string escape_json(std::string_view str)
+        {
+            std::string out;
+            out.reserve(str.size());
+            for(char ch: str)
+            {
+                if(ch == '"' || ch == '\\')
+                {
+                    out.push_back('\\');
+                    out.push_back(ch);
+                }
+                else if(static_cast<unsigned char>(ch) < 0x20)
+                    out.append(std::format("\\u{:04x}", static_cast<unsigned int>(ch)));
+                else
+                    out.push_back(ch);
+            }
+
+            return out;
+        }
+
+        bool write_bench_json(const std::string& path, const std::vector<bench_result>& results)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if(!file)
+                return false;
+
+            //one benchmark per line, read_bench_json relies on it
+            file << "{\n    \"benchmarks\": [\n";
+            for(std::size_t i = 0; i < results.size(); i++)
+            {
+                const bench_result& res = results[i];
+                file << std::format("        {{\"name\": \"{}\", \"group\": \"{}\", "
+                                    "\"iterations\": {}, \"samples\": {}, \"min_ns\": {:.3f}, "
+                                    "\"median_ns\": {:.3f}, \"mean_ns\": {:.3f}, "
+                                    "\"p99_ns\": {:.3f}, \"max_ns\": {:.3f}, "
+                                    "\"bytes_per_second\": {:.1f}}}{}\n",
+                                    escape_json(res.name),
+                                    escape_json(res.group),
+                                    res.iterations,
+                                    res.sample_count,
+                                    res.min,
+                                    res.median,
+                                    res.mean,
+                                    res.p99,
+                                    res.max,
+                                    res.bytes_per_second,
+                                    (i + 1 == results.size() ? "" : ","));
+            }
+            file << "    ]\n}\n";
+
+            return static_cast<bool>(file.flush());
+        }
+
+        static std::optional<std::string> read_json_string(std::string_view line,
+                                                           std::string_view key)
+        {
+            std::string pattern = std::format("\"{}\": \"", key);
+            std::size_t pos = line.find(pattern);
+            if(pos == std::string_view::npos)
+                return {};
+
+            std::string out;
+            for(pos += pattern.size(); pos < line.size(); pos++)
+            {
+                if(line[pos] == '"')
+                    return out;
+
+                if(line[pos] == '\\' && pos + 1 < line.size())
+                {
+                    pos++;
+                    if(line[pos] == 'u' && pos + 4 < line.size())
+                    {
+                        try
+                        {
+                            std::size_t parsed = 0;
+                            int code = std::stoi(std::string(line.substr(pos + 1, 4)), &parsed, 16);
+                            if(parsed != 4)
+                                return {};
+
+                            out.push_back(static_cast<char>(code));
+                        }
+                        catch(...)
+                        {
+                            return {};
+                        }
+
+                        pos += 4;
+                        continue;
+                    }
+                }
+
+                out.push_back(line[pos]);
+            }
+
+            return {};
+        }
+
+        static std::optional<double> read_json_number(std::string_view line, std::string_view key)
+        {
+            std::string pattern = std::format("\"{}\": ", key);
+            std::size_t pos = line.find(pattern);
+            if(pos == std::string_view::npos)
+                return {};
+
+            try
+            {
+                return std::stod(std::string(line.substr(pos + pattern.size())));
+            }
+            catch(...)
+            {
+                return {};
+            }
+        }
+
+        std::optional<std::vector<bench_result>> read_bench_json(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if(!file)
+                return {};
+
+            std::vector<bench_result> results;
+            std::string line;
+            while(std::getline(file, line))
+            {
+                auto name = read_json_string(line, "name");
+                if(!name)
+                    continue;
+
+                auto group = read_json_string(line, "group");
+                auto iterations = read_json_number(line, "iterations");
+                auto samples = read_json_number(line, "samples");
+                auto min = read_json_number(line, "min_ns");
+                auto median = read_json_number(line, "median_ns");
+                auto mean = read_json_number(line, "mean_ns");
+                auto p99 = read_json_number(line, "p99_ns");
+                auto max = read_json_number(line, "max_ns");
+                //files written before throughput was reported don't have it
+                auto bytes_per_second = read_json_number(line, "bytes_per_second");
+                if(!group || !iterations || !samples || !min || !median || !mean || !p99 || !max)
+                    return {};
+
+                results.push_back(bench_result{.name = std::move(*name),
+                                               .group = std::move(*group),
+                                               .iterations = static_cast<std::size_t>(*iterations),
+                                               .sample_count = static_cast<std::size_t>(*samples),
+                                               .min = *min,
+                                               .median = *median,
+                                               .mean = *mean,
+                                               .p99 = *p99,
+                                               .max = *max,
+                                               .bytes_per_second = bytes_per_second.value_or(0.0)});
+            }
+
+            return results;
+        }
+    };
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../flags.hpp"
+#include "test_property.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hrs
+{
+    namespace test
+    {
+        //keeps value and everything it points to from being optimized away
+        template<typename T>
+        inline void do_not_optimize(T&& value) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "r,m"(value) : "memory");
+#else
+            static const volatile void* volatile sink;
+            sink = static_cast<const volatile void*>(&value);
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+
+        //forces pending writes to memory
+        inline void clobber_memory() noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : : "memory");
+#else
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+
+        //A benchmark body runs its measured code in while(state.keep_running()).
+        //Only the loop is timed, setup before it isn't.
+        class bench_state
+        {
+        public:
+            using clock_t = std::chrono::steady_clock;
+
+            bench_state(std::size_t _iterations) noexcept;
+            ~bench_state() = default;
+            bench_state(const bench_state&) = delete;
+            bench_state& operator=(const bench_state&) = delete;
+
+            bool keep_running() noexcept
+            {
+                if(remaining != 0) [[likely]]
+                {
+                    if(remaining-- == iterations) [[unlikely]]
+                        start = clock_t::now();
+
+                    return true;
+                }
+
+                stop = clock_t::now();
+                return false;
+            }
+
+            //bytes the loop processes per iteration, results of such benches report throughput
+            void set_bytes_per_iteration(std::size_t bytes) noexcept;
+
+            std::size_t get_iterations() const noexcept;
+            std::size_t get_bytes_per_iteration() const noexcept;
+            bool is_finished() const noexcept;
+            std::chrono::nanoseconds get_elapsed() const noexcept;
+        private:
+            std::size_t iterations;
+            std::size_t remaining;
+            std::size_t bytes_per_iteration;
+            clock_t::time_point start;
+            clock_t::time_point stop;
+        };
+
+        class bench_data
+        {
+        public:
+            bench_data(std::function<void(bench_state&)>&& _func,
+                       std::string_view _name,
+                       std::string_view _tag,
+                       hrs::flags<test_property> _properties);
+
+            bench_data(const bench_data&) = default;
+            bench_data(bench_data&&) = default;
+            bench_data& operator=(const bench_data&) = default;
+            bench_data& operator=(bench_data&&) = default;
+
+            void operator()(bench_state& state) const;
+
+            const std::string& get_name() const noexcept;
+            const std::string& get_tag() const noexcept;
+            hrs::flags<test_property> get_properties() const noexcept;
+        private:
+            std::function<void(bench_state&)> func;
+            std::string name;
+            std::string tag;
+            hrs::flags<test_property> properties;
+        };
+
+        struct bench_options
+        {
+            //calibration runs count toward the warmup
+            std::chrono::nanoseconds warmup_time = std::chrono::milliseconds(100);
+            //iteration count of a sample is grown until one sample takes this long
+            std::chrono::nanoseconds min_sample_time = std::chrono::milliseconds(10);
+            //p99 needs about 100 samples to be more than the max
+            std::size_t sample_count = 100;
+            //JSON results are written here if it isn't empty
+            std::string output_path;
+            //results of an earlier output_path to compare with if it isn't empty
+            std::string baseline_path;
+            //median slower than the baseline by more than this fraction is a regression
+            double tolerance = 0.1;
+        };
+
+        //times are nanoseconds per iteration
+        struct bench_result
+        {
+            std::string name;
+            std::string group;
+            std::size_t iterations = 0;
+            std::size_t sample_count = 0;
+            double min = 0.0;
+            double median = 0.0;
+            double mean = 0.0;
+            double p99 = 0.0;
+            double max = 0.0;
+            //at the median time, 0 if the bench doesn't call set_bytes_per_iteration
+            double bytes_per_second = 0.0;
+        };
+
+        //calibrates, warms up and samples bench
+        bench_result measure_bench(const bench_data& bench,
+                                   std::string_view group,
+                                   const bench_options& options);
+
+        bool write_bench_json(const std::string& path, const std::vector<bench_result>& results);
+
+        //reads files written by write_bench_json
+        std::optional<std::vector<bench_result>> read_bench_json(const std::string& path);
+    };
+};
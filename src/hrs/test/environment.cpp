@@ -1,4 +1,8 @@
 #include "environment.h"
+#include "../parallel_for.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace hrs
 {
@@ -86,6 +90,23 @@ namespace hrs
                 ignore_group_names.insert(std::string(name));
         }
 
+        void environment::config::set_thread_count(std::size_t _thread_count) noexcept
+        {
+            thread_count = _thread_count;
+        }
+
+        void environment::config::set_bench_output_function(
+            std::function<bench_output_f>&& _bench_output_function)
+        {
+            if(_bench_output_function)
+                bench_output_function = std::move(_bench_output_function);
+        }
+
+        void environment::config::set_bench_options(bench_options&& _bench_options)
+        {
+            bench_opts = std::move(_bench_options);
+        }
+
         environment::environment()
             : cfg{DEFAULT_OUTPUT, DEFAULT_END_OUTPUT}
         {}
@@ -109,76 +130,252 @@ namespace hrs
             add_test(std::move(test), t_cfg.get_group());
         }
 
-        void environment::run()
+        void environment::add_bench(std::function<void(bench_state&)>&& func,
+                                    const test_config& t_cfg)
+        {
+            bench_data bench(std::move(func),
+                             t_cfg.get_name(),
+                             t_cfg.get_tag(),
+                             t_cfg.get_properties());
+            add_bench(std::move(bench), t_cfg.get_group());
+        }
+
+        void environment::add_bench(void (*func)(bench_state&), const test_config& t_cfg)
+        {
+            bench_data bench(func, t_cfg.get_name(), t_cfg.get_tag(), t_cfg.get_properties());
+            add_bench(std::move(bench), t_cfg.get_group());
+        }
+
+        bool environment::run()
+        {
+            bool tests_passed = run_tests();
+            bool benches_passed = run_benches();
+            return tests_passed && benches_passed;
+        }
+
+        static std::pair<test_result, std::exception_ptr> execute_test(const test_data& test,
+                                                                       bool ignore_group)
+        {
+            if(ignore_group || test.get_properties() & test_property::ignore)
+                return {test_result::ignored, nullptr};
+
+            try
+            {
+                test();
+            }
+            catch(...)
+            {
+                if(test.get_properties() & test_property::may_fail)
+                    return {test_result::success_due_failure, std::current_exception()};
+
+                return {test_result::failed, std::current_exception()};
+            }
+
+            return {test_result::success, nullptr};
+        }
+
+        bool environment::run_tests()
         {
+            //a whole group with a serial test or a single test of another group
+            struct test_task
+            {
+                const std::string* group;
+                bool ignore_group;
+                std::list<test_data>::const_iterator first;
+                std::size_t count;
+                std::size_t global_num;
+                std::size_t num_within_group;
+            };
+
+            std::vector<test_task> tasks;
+            std::size_t test_count = 0;
+            for(const auto& [group_name, group_tests]: tests)
+            {
+                bool ignore_group =
+                    cfg.ignore_group_names.find(group_name) != cfg.ignore_group_names.end();
+                bool serial_group = std::any_of(group_tests.begin(),
+                                                group_tests.end(),
+                                                [](const test_data& test)
+                                                {
+                                                    return static_cast<bool>(
+                                                        test.get_properties() &
+                                                        test_property::serial);
+                                                });
+
+                if(serial_group)
+                    tasks.push_back(test_task{&group_name,
+                                              ignore_group,
+                                              group_tests.begin(),
+                                              group_tests.size(),
+                                              test_count,
+                                              0});
+                else
+                {
+                    std::size_t within_group_i = 0;
+                    for(auto it = group_tests.begin(); it != group_tests.end(); it++)
+                    {
+                        tasks.push_back(test_task{&group_name,
+                                                  ignore_group,
+                                                  it,
+                                                  1,
+                                                  test_count + within_group_i,
+                                                  within_group_i});
+                        within_group_i++;
+                    }
+                }
+
+                test_count += group_tests.size();
+            }
+
             std::size_t success_count = 0;
             std::size_t failed_count = 0;
             std::size_t ignored_count = 0;
             std::size_t success_due_failure_count = 0;
 
-            std::size_t global_i = 0;
-            for(const auto& [group_name, group_tests]: tests)
+            //results are reported in completion order, output functions must not throw if
+            //more than one thread is used
+            std::mutex output_mutex;
+            std::atomic<std::size_t> next_task = 0;
+            auto worker = [&](std::size_t, std::size_t, std::size_t)
+            {
+                for(std::size_t task_i = next_task++; task_i < tasks.size(); task_i = next_task++)
+                {
+                    const test_task& task = tasks[task_i];
+                    auto it = task.first;
+                    for(std::size_t i = 0; i < task.count; i++, it++)
+                    {
+                        auto [test_res, err] = execute_test(*it, task.ignore_group);
+
+                        std::lock_guard lock(output_mutex);
+                        cfg.output_function(task.global_num + i,
+                                            task.num_within_group + i,
+                                            *task.group,
+                                            *it,
+                                            test_res,
+                                            err);
+
+                        switch(test_res)
+                        {
+                            case test_result::success:
+                                success_count++;
+                                break;
+                            case test_result::failed:
+                                failed_count++;
+                                break;
+                            case test_result::ignored:
+                                ignored_count++;
+                                break;
+                            case test_result::success_due_failure:
+                                success_due_failure_count++;
+                                break;
+                        }
+                    }
+                }
+            };
+
+            std::size_t worker_count =
+                std::min(cfg.thread_count == 0 ? hrs::hardware_thread_count() : cfg.thread_count,
+                         std::max<std::size_t>(tasks.size(), 1));
+            hrs::parallel_for(worker_count, worker_count, worker);
+
+            cfg.end_output_function(test_count,
+                                    success_count,
+                                    failed_count,
+                                    ignored_count,
+                                    success_due_failure_count,
+                                    tests);
+
+            return failed_count == 0;
+        }
+
+        bool environment::run_benches()
+        {
+            if(benches.empty())
+                return true;
+
+            const bench_options& opts = cfg.bench_opts;
+            bool passed = true;
+            std::vector<bench_result> baseline;
+            if(!opts.baseline_path.empty())
+            {
+                auto baseline_opt = read_bench_json(opts.baseline_path);
+                if(baseline_opt)
+                    baseline = std::move(*baseline_opt);
+                else
+                    std::cerr << std::format("Failed to read benchmark baseline: {}\n",
+                                             opts.baseline_path);
+            }
+
+            std::vector<bench_result> results;
+            std::size_t num = 0;
+            for(const auto& [group_name, group_benches]: benches)
             {
                 bool ignore_group =
                     cfg.ignore_group_names.find(group_name) != cfg.ignore_group_names.end();
 
-                std::size_t within_group_i = 0;
-                for(const test_data& test: group_tests)
+                for(const bench_data& bench: group_benches)
                 {
                     std::exception_ptr err = std::exception_ptr(nullptr);
-                    test_result test_res = test_result::success;
-                    if(ignore_group)
-                    {
-                        test_res = test_result::ignored;
-                    }
+                    test_result bench_res = test_result::success;
+                    bench_result result{.name = bench.get_name(), .group = group_name};
+                    if(ignore_group || bench.get_properties() & test_property::ignore)
+                        bench_res = test_result::ignored;
                     else
                     {
                         try
                         {
-                            if(test.get_properties() & test_property::ignore)
-                                test_res = test_result::ignored;
-                            else
-                                test();
+                            result = measure_bench(bench, group_name, opts);
                         }
                         catch(...)
                         {
-                            if(test.get_properties() & test_property::may_fail)
-                                test_res = test_result::success_due_failure;
+                            if(bench.get_properties() & test_property::may_fail)
+                                bench_res = test_result::success_due_failure;
                             else
-                                test_res = test_result::failed;
+                                bench_res = test_result::failed;
 
                             err = std::current_exception();
                         }
                     }
 
-                    cfg.output_function(global_i, within_group_i, group_name, test, test_res, err);
-                    global_i++;
-                    within_group_i++;
-
-                    switch(test_res)
-                    {
-                        case test_result::success:
-                            success_count++;
-                            break;
-                        case test_result::failed:
-                            failed_count++;
-                            break;
-                        case test_result::ignored:
-                            ignored_count++;
-                            break;
-                        case test_result::success_due_failure:
-                            success_due_failure_count++;
-                            break;
-                    }
+                    auto baseline_it = std::find_if(baseline.begin(),
+                                                    baseline.end(),
+                                                    [&](const bench_result& res)
+                                                    {
+                                                        return res.name == result.name &&
+                                                               res.group == result.group;
+                                                    });
+                    const bench_result* baseline_res =
+                        (baseline_it == baseline.end() ? nullptr : &*baseline_it);
+
+                    bool regressed = bench_res == test_result::success && baseline_res &&
+                                     result.median > baseline_res->median * (1.0 + opts.tolerance);
+
+                    if(bench_res == test_result::success)
+                        results.push_back(result);
+
+                    if(bench_res == test_result::failed || regressed)
+                        passed = false;
+
+                    cfg.bench_output_function(num,
+                                              group_name,
+                                              bench,
+                                              bench_res,
+                                              err,
+                                              result,
+                                              baseline_res,
+                                              regressed);
+                    num++;
                 }
             }
 
-            cfg.end_output_function(global_i,
-                                    success_count,
-                                    failed_count,
-                                    ignored_count,
-                                    success_due_failure_count,
-                                    tests);
+            if(!opts.output_path.empty() && !write_bench_json(opts.output_path, results))
+            {
+                std::cerr << std::format("Failed to write benchmark results: {}\n",
+                                         opts.output_path);
+                passed = false;
+            }
+
+            return passed;
         }
 
         void environment::set_config(config&& _cfg) noexcept
@@ -299,6 +496,87 @@ namespace hrs
                 success_due_failure_count);
         }
 
+        void environment::DEFAULT_BENCH_OUTPUT(std::size_t num,
+                                               const std::string& group,
+                                               const bench_data& bench,
+                                               test_result bench_res,
+                                               std::exception_ptr err,
+                                               const bench_result& result,
+                                               const bench_result* baseline,
+                                               bool regressed)
+        {
+            constexpr auto msg_fmt = "#(b:{}) group: {} [{}] Bench: {} -> {} ({})\n";
+
+            if(bench_res == test_result::ignored)
+            {
+                std::clog << std::format("#(b:{}) group: {} [{}] Bench: {} -> Ignored\n",
+                                         num,
+                                         group,
+                                         bench.get_tag(),
+                                         bench.get_name());
+                return;
+            }
+
+            if(bench_res != test_result::success)
+            {
+                std::string message;
+                try
+                {
+                    std::rethrow_exception(err);
+                }
+                catch(const assert_exception& tae)
+                {
+                    message =
+                        std::format("{}: {}", tae.get_assert_message(), tae.get_description());
+                }
+                catch(const std::exception& ex)
+                {
+                    message = ex.what();
+                }
+                catch(...)
+                {
+                    message = "Unknown exception!";
+                }
+
+                std::ostream& os = (bench_res == test_result::failed ? std::cerr : std::clog);
+                os << std::format(msg_fmt,
+                                  num,
+                                  group,
+                                  bench.get_tag(),
+                                  bench.get_name(),
+                                  (bench_res == test_result::failed ? "Failed"
+                                                                    : "Succes due failure"),
+                                  message);
+                return;
+            }
+
+            std::string baseline_str;
+            if(baseline)
+                baseline_str = std::format(", baseline median: {:.2f} ns ({:+.1f}%){}",
+                                           baseline->median,
+                                           (result.median / baseline->median - 1.0) * 100.0,
+                                           (regressed ? " REGRESSION" : ""));
+
+            std::string throughput_str;
+            if(result.bytes_per_second != 0.0)
+                throughput_str = std::format(", {:.1f} MB/s", result.bytes_per_second / 1e6);
+
+            std::ostream& os = (regressed ? std::cerr : std::clog);
+            os << std::format("#(b:{}) group: {} [{}] Bench: {} -> median: {:.2f} ns{}, "
+                              "p99: {:.2f} ns, min: {:.2f} ns ({} samples x {} iterations){}\n",
+                              num,
+                              group,
+                              bench.get_tag(),
+                              bench.get_name(),
+                              result.median,
+                              throughput_str,
+                              result.p99,
+                              result.min,
+                              result.sample_count,
+                              result.iterations,
+                              baseline_str);
+        }
+
         void environment::add_test(test_data&& test, std::string_view group)
         {
             auto group_it = tests.find(group);
@@ -307,5 +585,14 @@ namespace hrs
 
             group_it->second.push_back(std::move(test));
         }
+
+        void environment::add_bench(bench_data&& bench, std::string_view group)
+        {
+            auto group_it = benches.find(group);
+            if(group_it == benches.end())
+                group_it = benches.emplace(group, std::list<bench_data>{}).first;
+
+            group_it->second.push_back(std::move(bench));
+        }
     };
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "benchmark.h"
 #include "test_config.h"
 #include "test_data.h"
 #include <list>
@@ -79,6 +80,7 @@ namespace hrs
             };
 
             using tests_t = std::map<std::string, std::list<test_data>, test_group_comparator>;
+            using benches_t = std::map<std::string, std::list<bench_data>, test_group_comparator>;
 
             using output_f = void(std::size_t global_num,
                                   std::size_t num_within_group,
@@ -94,6 +96,16 @@ namespace hrs
                                       std::size_t success_due_failure_count,
                                       const tests_t& tests);
 
+            //baseline is null if there is no baseline result for the benchmark
+            using bench_output_f = void(std::size_t num,
+                                        const std::string& group,
+                                        const bench_data& bench,
+                                        test_result bench_res,
+                                        std::exception_ptr err,
+                                        const bench_result& result,
+                                        const bench_result* baseline,
+                                        bool regressed);
+
             class config
             {
             public:
@@ -133,10 +145,19 @@ namespace hrs
                 void set_ignore_group_names(ignore_group_names_container&& _ignore_group_names);
                 void erase_ignore_group_name(std::string_view name);
                 void insert_ignore_group_name(std::string_view name);
+                //tests of different groups and of groups without serial tests run on up to
+                //_thread_count threads, 0 means all hardware threads
+                void set_thread_count(std::size_t _thread_count) noexcept;
+                void set_bench_output_function(
+                    std::function<bench_output_f>&& _bench_output_function);
+                void set_bench_options(bench_options&& _bench_options);
             private:
                 std::function<output_f> output_function = DEFAULT_OUTPUT;
                 std::function<end_output_f> end_output_function = DEFAULT_END_OUTPUT;
+                std::function<bench_output_f> bench_output_function = DEFAULT_BENCH_OUTPUT;
                 ignore_group_names_container ignore_group_names;
+                std::size_t thread_count = 1;
+                bench_options bench_opts;
             };
 
             environment();
@@ -147,7 +168,13 @@ namespace hrs
 
             void add_test(void (*func)(), const test_config& t_cfg = {});
 
-            void run();
+            void add_bench(std::function<void(bench_state&)>&& func, const test_config& t_cfg = {});
+
+            void add_bench(void (*func)(bench_state&), const test_config& t_cfg = {});
+
+            //runs the tests and then the benchmarks one by one
+            //returns false if a test or a benchmark failed or a benchmark regressed
+            bool run();
 
             void set_config(config&& _cfg) noexcept;
 
@@ -166,11 +193,24 @@ namespace hrs
                                            std::size_t ignored_count,
                                            std::size_t success_due_failure_count,
                                            const tests_t& tests);
+
+            static void DEFAULT_BENCH_OUTPUT(std::size_t num,
+                                             const std::string& group,
+                                             const bench_data& bench,
+                                             test_result bench_res,
+                                             std::exception_ptr err,
+                                             const bench_result& result,
+                                             const bench_result* baseline,
+                                             bool regressed);
         private:
             void add_test(test_data&& test, std::string_view group);
+            void add_bench(bench_data&& bench, std::string_view group);
+            bool run_tests();
+            bool run_benches();
         private:
             config cfg;
             tests_t tests;
+            benches_t benches;
         };
     };
 };
@@ -8,7 +8,9 @@ namespace hrs
         {
             none = 0,
             ignore = 1 << 0,
-            may_fail = 1 << 1
+            may_fail = 1 << 1,
+            //the whole group of the test runs in order on one thread
+            serial = 1 << 2
         };
     };
 };
@@ -26,6 +26,33 @@
     HRS_TEST_ON_ENV(::hrs::test::environment::get_global_environment(), \
                     NAME __VA_OPT__(, ) __VA_ARGS__)
 
+//the body of a benchmark gets ::hrs::test::bench_state& state
+#define HRS_ADD_BENCH_ON_ENV(ENV, NAME, ...) \
+    [[maybe_unused]] int _HRS_TEST_LIB_FICTIVE_BENCH_VARIABLE_##NAME = []() -> int \
+    { \
+        using ::hrs::operator|; \
+        ::hrs::test::test_config cfg __VA_OPT__(= __VA_ARGS__); \
+        cfg.set_name(#NAME); \
+        ENV.add_bench(NAME, cfg); \
+        return 1; \
+    }();
+
+#define HRS_ADD_BENCH(NAME, ...) \
+    HRS_ADD_BENCH_ON_ENV(::hrs::test::environment::get_global_environment(), \
+                         NAME __VA_OPT__(, ) __VA_ARGS__)
+
+#define HRS_BENCH_ON_ENV(ENV, NAME, ...) \
+    static void NAME(::hrs::test::bench_state& state); \
+    namespace \
+    { \
+        HRS_ADD_BENCH_ON_ENV(ENV, NAME __VA_OPT__(, ) __VA_ARGS__) \
+    }; \
+    static void NAME([[maybe_unused]] ::hrs::test::bench_state& state)
+
+#define HRS_BENCH(NAME, ...) \
+    HRS_BENCH_ON_ENV(::hrs::test::environment::get_global_environment(), \
+                     NAME __VA_OPT__(, ) __VA_ARGS__)
+
 #define HRS_CLASS_TEST_ON_ENV_DECL(ENV, NAME, ...) \
 public: \
     static void NAME(); \
@@ -77,6 +104,5 @@ public: \
     int main(int argc, char** argv) \
     { \
         __VA_OPT__(::hrs::test::environment::get_global_environment().set_config(__VA_ARGS__)); \
-        ::hrs::test::environment::get_global_environment().run(); \
-        return 0; \
+        return ::hrs::test::environment::get_global_environment().run() ? 0 : 1; \
     }
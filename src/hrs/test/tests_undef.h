@@ -6,6 +6,14 @@
 
 #undef HRS_TEST
 
+#undef HRS_ADD_BENCH_ON_ENV
+
+#undef HRS_ADD_BENCH
+
+#undef HRS_BENCH_ON_ENV
+
+#undef HRS_BENCH
+
 #undef HRS_CLASS_TEST_ON_ENV_DECL
 
 #undef HRS_CLASS_TEST_DECL
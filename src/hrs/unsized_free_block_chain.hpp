@@ -4,12 +4,12 @@
 
 namespace hrs
 {
-    template<std::unsigned_integral T>
-    class unsized_free_block_chain : public free_block_chain_base<T>
+    template<std::unsigned_integral T, typename A = pool_allocator<block<T>>>
+    class unsized_free_block_chain : public free_block_chain_base<T, A>
     {
     public:
         unsized_free_block_chain(T _size = 0, T _outer_offset = 0)
-            : free_block_chain_base<T>(_size, _outer_offset)
+            : free_block_chain_base<T, A>(_size, _outer_offset)
         {}
 
         unsized_free_block_chain(const unsized_free_block_chain&) = default;